@@ -6,6 +6,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <libyass/compress.h>
+
 #include "draw.h"
 
 #include "draw_background.h"
@@ -16,8 +18,8 @@
 cairo_surface_t *final_surface;;
 cairo_t *final;
 
-cairo_surface_t *surface[10];
-cairo_t *cr[10];
+cairo_surface_t **surface;
+cairo_t **cr;
 
 static void handle_event(int d[6], int n_tasks, int ticks, int cpu, int h)
 {
@@ -55,6 +57,120 @@ static void handle_event(int d[6], int n_tasks, int ticks, int cpu, int h)
 	}
 }
 
+/* Records of the last block read from a compressed trace */
+static struct yass_trace_record *block_records;
+static unsigned char *block_data;
+static int block_index, block_n_records;
+
+/*
+ * Read the header of the input file, a binary trace, a compressed one
+ * or a text one, and return its format.
+ */
+static int read_header(FILE *fp, int *n_tasks, int *n_cpus, int *n_ticks,
+		       int *n_sched)
+{
+	struct yass_trace_header header;
+
+	if (fread(&header, sizeof(header), 1, fp) == 1) {
+		if (header.magic == __builtin_bswap32(YASS_TRACE_MAGIC)) {
+			fprintf(stderr, "yass-draw: input file written with "
+				"another byte order\n");
+			exit(1);
+		}
+
+		if (header.magic == YASS_TRACE_MAGIC ||
+		    header.magic == YASS_TRACE_MAGIC_COMPRESSED) {
+			if (header.version != YASS_TRACE_VERSION) {
+				fprintf(stderr, "yass-draw: unsupported "
+					"trace version %u\n", header.version);
+				exit(1);
+			}
+
+			*n_tasks = header.n_tasks;
+			*n_cpus = header.n_cpus;
+			*n_ticks = header.n_ticks;
+			*n_sched = header.n_schedulers;
+
+			if (header.magic == YASS_TRACE_MAGIC)
+				return YASS_TRACE_BINARY;
+
+			return YASS_TRACE_COMPRESSED;
+		}
+	}
+
+	rewind(fp);
+
+	if (fscanf(fp, "%d %d %d %d", n_tasks, n_cpus, n_ticks, n_sched) != 4) {
+		fprintf(stderr, "yass-draw: cannot parse input file\n");
+		exit(1);
+	}
+
+	return YASS_TRACE_TEXT;
+}
+
+/*
+ * Read and decode the next block of a compressed trace, return 0 at
+ * the end of the file.
+ */
+static int read_block(FILE *fp)
+{
+	struct yass_trace_block block;
+
+	if (fread(&block, sizeof(block), 1, fp) != 1)
+		return 0;
+
+	if (block_data == NULL) {
+		block_data = (unsigned char *)malloc(YASS_TRACE_BLOCK_SIZE);
+		block_records = (struct yass_trace_record *)
+		    malloc(YASS_TRACE_BLOCK_SIZE *
+			   sizeof(struct yass_trace_record));
+
+		if (block_data == NULL || block_records == NULL) {
+			fprintf(stderr, "yass-draw: out of memory\n");
+			exit(1);
+		}
+	}
+
+	if (block.size > YASS_TRACE_BLOCK_SIZE ||
+	    fread(block_data, 1, block.size, fp) != block.size ||
+	    yass_trace_decode_block(&block, block_data, block_records)) {
+		fprintf(stderr, "yass-draw: corrupted input file\n");
+		exit(1);
+	}
+
+	block_index = 0;
+	block_n_records = block.n_records;
+
+	return 1;
+}
+
+static int read_event(FILE *fp, int format, int d[6])
+{
+	int i;
+
+	struct yass_trace_record record;
+
+	if (format == YASS_TRACE_TEXT)
+		return fscanf(fp, "%d %d %d %d %d %d",
+			      &d[0], &d[1], &d[2], &d[3], &d[4], &d[5]) == 6;
+
+	if (format == YASS_TRACE_COMPRESSED) {
+		while (block_index == block_n_records) {
+			if (!read_block(fp))
+				return 0;
+		}
+
+		record = block_records[block_index++];
+	} else if (fread(&record, sizeof(record), 1, fp) != 1) {
+		return 0;
+	}
+
+	for (i = 0; i < 6; i++)
+		d[i] = record.d[i];
+
+	return 1;
+}
+
 static void image_init(int n_tasks, int n_cpus, int n_ticks, int n_sched,
 		       int choice, char output[128], int cpu, int one_page,
 		       int legend, int h)
@@ -68,6 +184,15 @@ static void image_init(int n_tasks, int n_cpus, int n_ticks, int n_sched,
 	width = WIDTH - 5 + n_ticks / 10;
 	height = 20 + (n_tasks + n_cpus) * h + TASK_CPU_MARGIN;
 
+	surface = (cairo_surface_t **)calloc(n_sched,
+					     sizeof(cairo_surface_t *));
+	cr = (cairo_t **)calloc(n_sched, sizeof(cairo_t *));
+
+	if (surface == NULL || cr == NULL) {
+		fprintf(stderr, "yass-draw: cannot allocate surfaces\n");
+		exit(1);
+	}
+
 	for (i = 0; i < n_sched; i++) {
 		switch (choice) {
 		case OPTS_PDF:
@@ -140,6 +265,9 @@ static void destroy_surfaces(int n_sched)
 		cairo_surface_destroy(surface[i]);
 	}
 
+	free(cr);
+	free(surface);
+
 	cairo_destroy(final);
 	cairo_surface_destroy(final_surface);
 }
@@ -147,7 +275,7 @@ static void destroy_surfaces(int n_sched)
 void draw(int opts, char input[128], int choice, int ticks, int scale,
 	  char output[128], int h)
 {
-	int i, height = 0;
+	int format, i, height = 0;
 	int n_cpus, n_ticks, n_tasks, n_sched;
 	int d[6];
 	FILE *fp;
@@ -167,11 +295,7 @@ void draw(int opts, char input[128], int choice, int ticks, int scale,
 		exit(1);
 	}
 
-	if (fscanf(fp, "%d %d %d %d",
-		   &n_tasks, &n_cpus, &n_ticks, &n_sched) != 4) {
-		fprintf(stderr, "yass-draw: cannot parse input file\n");
-		exit(1);
-	}
+	format = read_header(fp, &n_tasks, &n_cpus, &n_ticks, &n_sched);
 
 	image_init(n_tasks, n_cpus, n_ticks, n_sched, choice, output, cpu,
 		   one_page, legend, h);
@@ -179,10 +303,8 @@ void draw(int opts, char input[128], int choice, int ticks, int scale,
 	colors_init(disable_dpm, n_tasks);
 	draw_init(n_tasks, n_sched, n_cpus, n_ticks);
 
-	while (fscanf(fp, "%d %d %d %d %d %d",
-		      &d[0], &d[1], &d[2], &d[3], &d[4], &d[5]) == 6) {
+	while (read_event(fp, format, d))
 		handle_event(d, n_tasks, ticks, cpu, h);
-	}
 
 	draw_lines(cr, n_tasks, n_cpus, n_ticks, n_sched, scale,
 		   disable_frequency, cpu, legend, h);
@@ -226,4 +348,7 @@ void draw(int opts, char input[128], int choice, int ticks, int scale,
 	destroy_surfaces(n_sched);
 
 	draw_free(n_tasks, n_sched, n_cpus);
+
+	free(block_data);
+	free(block_records);
 }
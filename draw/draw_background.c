@@ -6,7 +6,7 @@
 #include "draw_background.h"
 #include "draw_event.h"
 
-static void draw_scale(cairo_t * cr[10], int sched, int y, int n_ticks,
+static void draw_scale(cairo_t ** cr, int sched, int y, int n_ticks,
 		       int scale)
 {
 	int i, t;
@@ -58,7 +58,7 @@ static void draw_scale(cairo_t * cr[10], int sched, int y, int n_ticks,
 	cairo_stroke(cr[sched]);
 }
 
-static void draw_cpu_speed(cairo_t * cr[10], int sched, int y, int h)
+static void draw_cpu_speed(cairo_t ** cr, int sched, int y, int h)
 {
 	int i;
 	char tmp[128];
@@ -83,7 +83,7 @@ static void draw_cpu_speed(cairo_t * cr[10], int sched, int y, int h)
 	cairo_stroke(cr[sched]);
 }
 
-static void draw_line_sched(cairo_t * cr[10], int sched, int n, int cpu,
+static void draw_line_sched(cairo_t ** cr, int sched, int n, int cpu,
 			    int n_cpus, int width, int n_tasks, int legend,
 			    int h)
 {
@@ -132,7 +132,7 @@ static void draw_line_sched(cairo_t * cr[10], int sched, int n, int cpu,
 	cairo_stroke(cr[sched]);
 }
 
-void draw_lines(cairo_t * cr[10], int n_tasks, int n_cpus, int n_ticks,
+void draw_lines(cairo_t ** cr, int n_tasks, int n_cpus, int n_ticks,
 		int n_sched, int scale, int disable_frequency, int cpu,
 		int legend, int h)
 {
@@ -158,7 +158,7 @@ void draw_lines(cairo_t * cr[10], int n_tasks, int n_cpus, int n_ticks,
 	}
 }
 
-void draw_line_above_cpu(cairo_t * cr[10], int n_sched, int n_tasks,
+void draw_line_above_cpu(cairo_t ** cr, int n_sched, int n_tasks,
 			 int n_ticks, int h)
 {
 	int i;
@@ -179,7 +179,7 @@ void draw_line_above_cpu(cairo_t * cr[10], int n_sched, int n_tasks,
 	}
 }
 
-void draw_line_between_schedulers(cairo_t * cr[10], int n_sched, int n_ticks)
+void draw_line_between_schedulers(cairo_t ** cr, int n_sched, int n_ticks)
 {
 	int i;
 
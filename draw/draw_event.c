@@ -13,6 +13,7 @@ struct event {
 	int task;
 };
 
+int n_ids;
 int *id;
 int ***boundaries;
 int **speed;
@@ -26,9 +27,11 @@ static int task_add_index(int n)
 {
 	int i = 0;
 
-	while (id[i] != -1)
+	while (i < n_ids && id[i] != -1)
 		i++;
 
+	assert(i < n_ids);
+
 	id[i] = n;
 
 	return i;
@@ -38,7 +41,7 @@ static int task_get_index(int n)
 {
 	int i;
 
-	for (i = 0; i < YASS_MAX_N_TASKS; i++) {
+	for (i = 0; i < n_ids; i++) {
 		if (id[i] == n)
 			return i;
 	}
@@ -61,9 +64,10 @@ void draw_init(int n_tasks, int n_sched, int n_cpus, int n_ticks)
 	run = (struct event **)calloc(n_sched * n_cpus, sizeof(struct event));
 	cons = (double ***)calloc(n_sched * n_cpus * 2, sizeof(double));
 
-	id = (int *)calloc(YASS_MAX_N_TASKS, sizeof(int));
+	n_ids = n_tasks;
+	id = (int *)calloc(n_ids, sizeof(int));
 
-	for (i = 0; i < YASS_MAX_N_TASKS; i++)
+	for (i = 0; i < n_ids; i++)
 		id[i] = -1;
 
 	for (i = 0; i < n_tasks; i++) {
@@ -146,7 +150,7 @@ void add_boundary(int type, int task, int tick)
 	boundaries[index][type][i] = tick;
 }
 
-static void draw_arrows(cairo_t * cr[10], int sched, int task, int type, int h)
+static void draw_arrows(cairo_t ** cr, int sched, int task, int type, int h)
 {
 	int i = 0, width;
 
@@ -174,7 +178,7 @@ static void draw_arrows(cairo_t * cr[10], int sched, int task, int type, int h)
 	}
 }
 
-void draw_boundaries(cairo_t * cr[10], int n_tasks, int n_schedulers, int h)
+void draw_boundaries(cairo_t ** cr, int n_tasks, int n_schedulers, int h)
 {
 	int i, k;
 
@@ -196,7 +200,7 @@ void save_run(int sched, int task, int tick, int cpu)
 }
 
 void draw_execution(int sched, int task, int tick, int cpu, int n_tasks,
-		    int ticks, cairo_t * cr[10], int only_cpu, int h)
+		    int ticks, cairo_t ** cr, int only_cpu, int h)
 {
 	int run_tick = run[sched][cpu].tick;
 	int run_task = run[sched][cpu].task;
@@ -13,12 +13,12 @@ void set_cpu_speed(int scheduler, int cpu, int new_speed);
 
 void add_boundary(int type, int task, int tick);
 
-void draw_boundaries(cairo_t * cr[10], int n_tasks, int n_schedulers, int h);
+void draw_boundaries(cairo_t ** cr, int n_tasks, int n_schedulers, int h);
 
 void save_run(int scheduler, int task, int tick, int cpu);
 
 void draw_execution(int sched, int task, int tick, int cpu, int n_tasks,
-		    int ticks, cairo_t * cr[10], int only_cpu, int h);
+		    int ticks, cairo_t ** cr, int only_cpu, int h);
 
 void draw_consumption(int scheduler, int cpu, int consumption, int tick,
 		      int n_ticks);
@@ -0,0 +1,150 @@
+#include <stdlib.h>
+
+#include "arena.h"
+
+#include "common.h"
+#include "private.h"
+
+#define ARENA_MIN_SIZE 4096
+#define ARENA_ALIGN 16
+
+struct block {
+	struct block *next;
+	char *mem;
+};
+
+/*
+ * Bump allocator: memory is taken from a single buffer and released
+ * all at once by yass_arena_reset(). When the buffer is full, blocks
+ * are allocated on the side, and the next reset replaces the buffer
+ * by one large enough for everything used since the previous reset,
+ * so that an arena used the same way again and again stops calling
+ * malloc().
+ */
+struct yass_arena {
+	char *mem;
+	size_t size;
+	size_t used;
+
+	struct block *blocks;
+	size_t blocks_size;	/* Memory taken from the blocks */
+};
+
+static size_t align(size_t size)
+{
+	return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+YASS_EXPORT struct yass_arena *yass_arena_new(void)
+{
+	struct yass_arena *a =
+	    (struct yass_arena *)malloc(sizeof(struct yass_arena));
+
+	if (a == NULL)
+		return NULL;
+
+	a->mem = NULL;
+	a->size = 0;
+	a->used = 0;
+	a->blocks = NULL;
+	a->blocks_size = 0;
+
+	return a;
+}
+
+static void free_blocks(struct yass_arena *a)
+{
+	struct block *b;
+
+	while (a->blocks != NULL) {
+		b = a->blocks;
+		a->blocks = b->next;
+
+		free(b->mem);
+		free(b);
+	}
+
+	a->blocks_size = 0;
+}
+
+YASS_EXPORT void yass_arena_free(struct yass_arena *a)
+{
+	if (a == NULL)
+		return;
+
+	free_blocks(a);
+
+	free(a->mem);
+	free(a);
+}
+
+/*
+ * Memory valid until the next reset of the arena, or NULL.
+ */
+YASS_EXPORT void *yass_arena_alloc(struct yass_arena *a, size_t size)
+{
+	struct block *b;
+
+	void *p;
+
+	size = align(size);
+
+	if (size == 0)
+		size = ARENA_ALIGN;
+
+	if (a->used + size <= a->size) {
+		p = a->mem + a->used;
+		a->used += size;
+
+		return p;
+	}
+
+	b = (struct block *)malloc(sizeof(struct block));
+
+	if (b == NULL)
+		return NULL;
+
+	b->mem = (char *)malloc(size);
+
+	if (b->mem == NULL) {
+		free(b);
+		return NULL;
+	}
+
+	b->next = a->blocks;
+	a->blocks = b;
+	a->blocks_size += size;
+
+	return b->mem;
+}
+
+/*
+ * Release everything allocated from the arena.
+ */
+YASS_EXPORT void yass_arena_reset(struct yass_arena *a)
+{
+	size_t size;
+
+	char *mem;
+
+	if (a->blocks != NULL) {
+		size = a->used + a->blocks_size;
+
+		if (size < ARENA_MIN_SIZE)
+			size = ARENA_MIN_SIZE;
+
+		free_blocks(a);
+
+		/* Keep the old buffer if a larger one cannot be allocated */
+		mem = (char *)malloc(size);
+
+		if (mem != NULL) {
+			free(a->mem);
+
+			a->mem = mem;
+			a->size = size;
+		}
+	}
+
+	a->used = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef _YASS_ARENA_H
+#define _YASS_ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_arena;
+
+struct yass_arena *yass_arena_new(void);
+
+void yass_arena_free(struct yass_arena *a);
+
+void *yass_arena_alloc(struct yass_arena *a, size_t size);
+
+void yass_arena_reset(struct yass_arena *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_ARENA_H */
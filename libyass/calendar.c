@@ -0,0 +1,203 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "calendar.h"
+
+#include "common.h"
+#include "private.h"
+
+struct event {
+	int time;		/* Next occurrence */
+	int offset;
+	int period;
+};
+
+/*
+ * Calendar of periodic events, each occurring at the ticks offset + k
+ * * period, k >= 0. The events are kept in a binary min-heap ordered
+ * by their next occurrence. Queries are expected at nondecreasing
+ * ticks: only the events found in the past are moved, directly to
+ * their first occurrence not before the queried tick, so a query
+ * costs O(1) plus O(log n) per event that occurred since the previous
+ * one. A query for an earlier tick restarts the calendar from it, in
+ * O(n).
+ */
+struct yass_calendar {
+	int n;
+	int size;
+
+	int started;
+	int tick;		/* Tick of the last query */
+
+	struct event *events;
+};
+
+static int event_cmp(const void *a, const void *b)
+{
+	const struct event *x = (const struct event *)a;
+	const struct event *y = (const struct event *)b;
+
+	if (x->offset != y->offset)
+		return x->offset < y->offset ? -1 : 1;
+
+	if (x->period != y->period)
+		return x->period < y->period ? -1 : 1;
+
+	return 0;
+}
+
+/*
+ * Return the first tick greater or equal to tick of the form offset +
+ * k * period, with k >= 0.
+ */
+static int next_occurrence(int tick, int offset, int period)
+{
+	if (tick <= offset)
+		return offset;
+
+	return offset + ((tick - offset + period - 1) / period) * period;
+}
+
+static void sift_down(struct yass_calendar *c, int i)
+{
+	int j;
+
+	struct event e = c->events[i];
+
+	for (;;) {
+		j = 2 * i + 1;
+
+		if (j >= c->n)
+			break;
+
+		if (j + 1 < c->n && c->events[j + 1].time < c->events[j].time)
+			j++;
+
+		if (c->events[j].time >= e.time)
+			break;
+
+		c->events[i] = c->events[j];
+		i = j;
+	}
+
+	c->events[i] = e;
+}
+
+/*
+ * Set each event to its first occurrence not before tick. The events
+ * shared by several tasks are only kept once.
+ */
+static void calendar_start(struct yass_calendar *c, int tick)
+{
+	int i, n = 0;
+
+	if (!c->started && c->n > 0) {
+		qsort(c->events, c->n, sizeof(struct event), event_cmp);
+
+		for (i = 1; i < c->n; i++) {
+			if (event_cmp(&c->events[n], &c->events[i]) != 0)
+				c->events[++n] = c->events[i];
+		}
+
+		c->n = n + 1;
+	}
+
+	for (i = 0; i < c->n; i++)
+		c->events[i].time = next_occurrence(tick, c->events[i].offset,
+						    c->events[i].period);
+
+	for (i = c->n / 2 - 1; i >= 0; i--)
+		sift_down(c, i);
+
+	c->started = 1;
+	c->tick = tick;
+}
+
+YASS_EXPORT struct yass_calendar *yass_calendar_new(void)
+{
+	struct yass_calendar *c =
+	    (struct yass_calendar *)malloc(sizeof(struct yass_calendar));
+
+	if (c == NULL)
+		return NULL;
+
+	c->n = 0;
+	c->size = 0;
+	c->started = 0;
+	c->tick = 0;
+	c->events = NULL;
+
+	return c;
+}
+
+YASS_EXPORT void yass_calendar_free(struct yass_calendar *c)
+{
+	if (c == NULL)
+		return;
+
+	free(c->events);
+	free(c);
+}
+
+/*
+ * Add an event occurring at offset + k * period, k >= 0. Events can
+ * only be added before the first query.
+ */
+YASS_EXPORT int yass_calendar_add(struct yass_calendar *c, int offset,
+				  int period)
+{
+	int size;
+
+	struct event *events;
+
+	yass_warn(!c->started);
+	yass_warn(period > 0);
+
+	if (c->n == c->size) {
+		size = c->size > 0 ? 2 * c->size : 16;
+
+		events = (struct event *)
+		    realloc(c->events, size * sizeof(struct event));
+
+		if (events == NULL)
+			return -YASS_ERROR_MALLOC;
+
+		c->events = events;
+		c->size = size;
+	}
+
+	c->events[c->n].time = offset;
+	c->events[c->n].offset = offset;
+	c->events[c->n].period = period;
+
+	c->n++;
+
+	return 0;
+}
+
+/*
+ * First tick greater or equal to tick at which an event occurs, or
+ * INT_MAX if the calendar is empty.
+ */
+YASS_EXPORT int yass_calendar_next(struct yass_calendar *c, int tick)
+{
+	struct event *e;
+
+	if (!c->started || tick < c->tick)
+		calendar_start(c, tick);
+
+	c->tick = tick;
+
+	if (c->n == 0)
+		return INT_MAX;
+
+	e = &c->events[0];
+
+	while (e->time < tick) {
+		e->time = next_occurrence(tick, e->offset, e->period);
+		sift_down(c, 0);
+	}
+
+	return e->time;
+}
@@ -0,0 +1,22 @@
+#ifndef _YASS_CALENDAR_H
+#define _YASS_CALENDAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_calendar;
+
+struct yass_calendar *yass_calendar_new(void);
+
+void yass_calendar_free(struct yass_calendar *c);
+
+int yass_calendar_add(struct yass_calendar *c, int offset, int period);
+
+int yass_calendar_next(struct yass_calendar *c, int tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_CALENDAR_H */
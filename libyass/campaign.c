@@ -0,0 +1,566 @@
+#include <jansson.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "campaign.h"
+
+#include "common.h"
+#include "cpu.h"
+#include "exec_time.h"
+#include "pool.h"
+#include "private.h"
+#include "rng.h"
+#include "scheduler.h"
+#include "task.h"
+#include "yass.h"
+
+struct result {
+	int done;
+
+	char *s;
+	size_t size;
+};
+
+struct yass_campaign {
+	int n_cpus;
+	int n_hyperperiods;
+	int online;
+	int event_driven;
+
+	/*
+	 * The execution times of a task set are generated from its
+	 * own stream of this seed, whatever the thread running it.
+	 */
+	unsigned long long seed;
+
+	char *cpu;
+
+	/*
+	 * The schedulers are loaded once, each task set is then run
+	 * on copies of them. A plugin of the version 1 of the
+	 * interface keeps its state in global variables, so such a
+	 * scheduler is run by one thread at a time.
+	 */
+	int n_schedulers;
+	char **schedulers;
+	struct sched **sched;
+	pthread_mutex_t *sched_locks;
+
+	int n_tasksets;
+	char **tasksets;
+
+	/*
+	 * Results are written in the order of the task sets, a result
+	 * is kept until all the previous ones have been written.
+	 */
+	pthread_mutex_t lock;
+	FILE *fp;
+	int next_taskset;
+	int next_result;
+	struct result *results;
+	int error;
+};
+
+static int get_int(json_t * object, const char *s, int value)
+{
+	json_t *j = json_object_get(object, s);
+
+	if (!json_is_integer(j))
+		return value;
+
+	return json_integer_value(j);
+}
+
+static char **get_strings(json_t * object, const char *s, int *n, int *error)
+{
+	int i;
+	char **strings;
+
+	json_t *objects = json_object_get(object, s);
+
+	if (!json_is_array(objects) || json_array_size(objects) <= 0) {
+		fprintf(stderr, "error: %s is not a non-empty array\n", s);
+		*error = -YASS_ERROR_CAMPAIGN_FILE_JSON;
+		return NULL;
+	}
+
+	*n = json_array_size(objects);
+
+	strings = (char **)calloc(*n, sizeof(char *));
+
+	if (strings == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	for (i = 0; i < *n; i++) {
+		object = json_array_get(objects, i);
+
+		if (!json_is_string(object)) {
+			fprintf(stderr, "error: %s %d is not a string\n", s,
+				i + 1);
+			*error = -YASS_ERROR_CAMPAIGN_FILE_JSON;
+			return strings;
+		}
+
+		strings[i] = strdup(json_string_value(object));
+
+		if (strings[i] == NULL) {
+			*error = -YASS_ERROR_MALLOC;
+			return strings;
+		}
+	}
+
+	return strings;
+}
+
+static void free_strings(char **strings, int n)
+{
+	int i;
+
+	if (strings == NULL)
+		return;
+
+	for (i = 0; i < n; i++)
+		free(strings[i]);
+
+	free(strings);
+}
+
+static int campaign_parse(struct yass_campaign *c, const char *spec)
+{
+	int error = 0;
+	char filename[256];
+
+	json_t *root, *object;
+	json_error_t json_error;
+
+	if (yass_find_file(filename, spec, TESTS))
+		return -YASS_ERROR_CAMPAIGN_FILE;
+
+	root = json_load_file(filename, 0, &json_error);
+
+	if (!root) {
+		fprintf(stderr, "%s: error on line %d: %s\n", filename,
+			json_error.line, json_error.text);
+		return -YASS_ERROR_CAMPAIGN_FILE_JSON;
+	}
+
+	c->n_cpus = get_int(root, "n_cpus", YASS_DEFAULT_N_CPU);
+	c->n_hyperperiods = get_int(root, "n_hyperperiods",
+				    YASS_DEFAULT_N_HYPERPERIODS);
+	c->online = get_int(root, "online", 0);
+	c->event_driven = get_int(root, "event_driven", 0);
+
+	if (c->n_cpus <= 0) {
+		error = -YASS_ERROR_N_CPUS;
+		goto end;
+	}
+
+	if (c->n_hyperperiods <= 0) {
+		error = -YASS_ERROR_N_TICKS;
+		goto end;
+	}
+
+	object = json_object_get(root, "cpu");
+
+	c->cpu = strdup(json_is_string(object) ?
+			json_string_value(object) : "");
+
+	if (c->cpu == NULL) {
+		error = -YASS_ERROR_MALLOC;
+		goto end;
+	}
+
+	c->schedulers = get_strings(root, "schedulers", &c->n_schedulers,
+				    &error);
+
+	if (error)
+		goto end;
+
+	c->tasksets = get_strings(root, "tasksets", &c->n_tasksets, &error);
+
+ end:
+	json_decref(root);
+
+	return error;
+}
+
+YASS_EXPORT struct yass_campaign *yass_campaign_new(const char *spec,
+						    int *error)
+{
+	int i;
+
+	struct yass_campaign *c;
+
+	*error = 0;
+
+	c = (struct yass_campaign *)calloc(1, sizeof(struct yass_campaign));
+
+	if (c == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	pthread_mutex_init(&c->lock, NULL);
+
+	*error = campaign_parse(c, spec);
+
+	if (*error)
+		goto error;
+
+	c->sched = yass_sched_new(c->n_schedulers);
+	c->sched_locks = (pthread_mutex_t *)calloc(c->n_schedulers,
+						   sizeof(pthread_mutex_t));
+
+	if (c->sched == NULL || c->sched_locks == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		goto error;
+	}
+
+	for (i = 0; i < c->n_schedulers; i++)
+		pthread_mutex_init(&c->sched_locks[i], NULL);
+
+	*error = yass_sched_init(c->sched, c->n_schedulers, c->schedulers,
+				 c->n_cpus, c->cpu, 0, 0, c->online, 0);
+
+	if (*error)
+		goto error;
+
+	/* Nothing reads the events of a campaign */
+	for (i = 0; i < c->n_schedulers; i++) {
+		yass_sched_set_event_driven(c->sched[i], c->event_driven);
+		yass_sched_set_trace(c->sched[i], YASS_TRACE_NONE);
+	}
+
+	return c;
+
+ error:
+	yass_campaign_free(c);
+
+	return NULL;
+}
+
+/*
+ * Write one line per scheduler: the task set, the index of the
+ * scheduler and the error code, followed on success by the
+ * hyperperiod, the number of context switches, the number of idle
+ * periods, the consumption, the deadline misses per hyperperiod, the
+ * stat of the scheduler, the usage of each low-power state and the
+ * length of each idle period.
+ */
+static void campaign_print_sched(struct yass_campaign *c, FILE * fp,
+				 int taskset, int index, int error,
+				 struct sched *sched)
+{
+	int i, j, n, length;
+	int *use;
+
+	double ctx = 0;
+	double idle = 0;
+
+	fprintf(fp, "%s %d %d", c->tasksets[taskset], index, error);
+
+	if (error) {
+		fprintf(fp, "\n");
+		return;
+	}
+
+	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
+		ctx += yass_cpu_get_context_switches(sched, i);
+		idle += yass_cpu_get_idle_periods(sched, i);
+	}
+
+	fprintf(fp, " %llu %lf %lf %lf %lf %d",
+		yass_sched_get_hyperperiod(sched), ctx, idle,
+		yass_cpu_cons_get_total(sched),
+		yass_sched_get_deadline_misses(sched, 1) / c->n_hyperperiods,
+		yass_sched_get_stat(sched));
+
+	use = (int *)calloc(yass_cpu_get_nstates(sched), sizeof(int));
+
+	for (i = 0; i < yass_sched_get_ncpus(sched) && use; i++)
+		for (j = 0; j < yass_cpu_get_nstates(sched); j++)
+			use[j] += yass_cpu_get_state_usage(sched, i, j);
+
+	fprintf(fp, " %d", use ? yass_cpu_get_nstates(sched) : 0);
+
+	for (i = 0; i < yass_cpu_get_nstates(sched) && use; i++)
+		fprintf(fp, " %d", use[i]);
+
+	free(use);
+
+	length = 0;
+
+	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
+		n = 0;
+
+		while (yass_cpu_get_idle_length(sched, i, n) != -1)
+			n++;
+
+		length += n;
+	}
+
+	fprintf(fp, " %d", length);
+
+	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
+		n = 0;
+		length = yass_cpu_get_idle_length(sched, i, n);
+
+		while (length != -1) {
+			fprintf(fp, " %d", length);
+
+			n++;
+			length = yass_cpu_get_idle_length(sched, i, n);
+		}
+	}
+
+	fprintf(fp, "\n");
+}
+
+static void campaign_run_sched(struct yass_campaign *c, FILE * fp,
+			       int taskset, int index,
+			       struct yass_task **tasks,
+			       struct yass_exec_time *exec_time, int n_tasks)
+{
+	int error;
+	unsigned long long h;
+
+	struct sched *sched;
+
+	sched = yass_sched_copy(c->sched[index], &error);
+
+	if (sched == NULL) {
+		campaign_print_sched(c, fp, taskset, index, error, NULL);
+		return;
+	}
+
+	error = yass_sched_init_tasks(sched, tasks, exec_time, n_tasks);
+
+	if (error)
+		goto end;
+
+	h = yass_sched_get_hyperperiod(sched);
+
+	if (h > (unsigned long long)(INT_MAX - 1) / c->n_hyperperiods) {
+		error = -YASS_ERROR_HYPERPERIOD;
+		goto end;
+	}
+
+	if (!yass_sched_is_reentrant(sched))
+		pthread_mutex_lock(&c->sched_locks[index]);
+
+	error = yass_run_sched(sched, c->n_hyperperiods * h + 1);
+
+	if (!yass_sched_is_reentrant(sched))
+		pthread_mutex_unlock(&c->sched_locks[index]);
+
+ end:
+	campaign_print_sched(c, fp, taskset, index, error, sched);
+
+	yass_sched_free(sched);
+}
+
+/*
+ * Store the result of a task set, and write all the results which
+ * are now in order.
+ */
+static void campaign_output(struct yass_campaign *c, int taskset, int error)
+{
+	struct result *r;
+
+	pthread_mutex_lock(&c->lock);
+
+	c->results[taskset].done = 1;
+
+	if (error && !c->error)
+		c->error = error;
+
+	while (c->next_result < c->n_tasksets) {
+		r = &c->results[c->next_result];
+
+		if (!r->done)
+			break;
+
+		if (r->s != NULL) {
+			fwrite(r->s, 1, r->size, c->fp);
+			free(r->s);
+			r->s = NULL;
+		}
+
+		c->next_result++;
+	}
+
+	pthread_mutex_unlock(&c->lock);
+}
+
+static void campaign_run_taskset(struct yass_campaign *c, int taskset)
+{
+	int error, i, n_tasks = 0;
+
+	struct yass_exec_time *exec_time = NULL;
+	struct yass_task **tasks;
+
+	FILE *fp;
+
+	fp = open_memstream(&c->results[taskset].s, &c->results[taskset].size);
+
+	if (fp == NULL) {
+		campaign_output(c, taskset, -YASS_ERROR_MALLOC);
+		return;
+	}
+
+	tasks = yass_tasks_create(c->tasksets[taskset], &n_tasks, &error);
+
+	if (tasks != NULL) {
+		exec_time = yass_exec_time_new(tasks, n_tasks,
+					       yass_rng_derive(c->seed,
+							       taskset));
+
+		if (exec_time == NULL)
+			error = -YASS_ERROR_MALLOC;
+	}
+
+	for (i = 0; i < c->n_schedulers; i++) {
+		if (error)
+			campaign_print_sched(c, fp, taskset, i, error, NULL);
+		else
+			campaign_run_sched(c, fp, taskset, i, tasks,
+					   exec_time, n_tasks);
+	}
+
+	yass_exec_time_free(exec_time);
+
+	if (tasks != NULL)
+		yass_task_free_tasks(tasks, n_tasks);
+
+	fclose(fp);
+
+	campaign_output(c, taskset, 0);
+}
+
+/*
+ * Each worker takes the task sets one after the other, so that the
+ * results can be written while the campaign is running.
+ */
+static void campaign_worker(void *arg)
+{
+	int taskset;
+
+	struct yass_campaign *c = (struct yass_campaign *)arg;
+
+	while (1) {
+		pthread_mutex_lock(&c->lock);
+
+		taskset = c->next_taskset;
+
+		if (taskset < c->n_tasksets)
+			c->next_taskset++;
+
+		pthread_mutex_unlock(&c->lock);
+
+		if (taskset >= c->n_tasksets)
+			break;
+
+		campaign_run_taskset(c, taskset);
+	}
+}
+
+YASS_EXPORT int yass_campaign_run(struct yass_campaign *c, int jobs, FILE * fp)
+{
+	int error, i;
+
+	struct yass_pool *pool;
+
+	if (jobs > c->n_tasksets)
+		jobs = c->n_tasksets;
+
+	c->results = (struct result *)calloc(c->n_tasksets,
+					     sizeof(struct result));
+
+	if (c->results == NULL)
+		return -YASS_ERROR_MALLOC;
+
+	c->fp = fp;
+	c->next_taskset = 0;
+	c->next_result = 0;
+	c->error = 0;
+
+	pool = yass_pool_new(jobs, &error);
+
+	if (pool == NULL)
+		goto end;
+
+	for (i = 0; i < jobs; i++) {
+		error = yass_pool_submit(pool, &campaign_worker, c);
+
+		if (error)
+			break;
+	}
+
+	yass_pool_wait(pool);
+	yass_pool_free(pool);
+
+	if (!error)
+		error = c->error;
+
+	if (!error && ferror(fp))
+		error = -YASS_ERROR_FILE;
+
+ end:
+	for (i = 0; i < c->n_tasksets; i++)
+		free(c->results[i].s);
+
+	free(c->results);
+	c->results = NULL;
+
+	return error;
+}
+
+YASS_EXPORT void yass_campaign_set_seed(struct yass_campaign *c,
+					unsigned long long seed)
+{
+	c->seed = seed;
+}
+
+YASS_EXPORT int yass_campaign_get_nschedulers(struct yass_campaign *c)
+{
+	return c->n_schedulers;
+}
+
+YASS_EXPORT int yass_campaign_get_ntasksets(struct yass_campaign *c)
+{
+	return c->n_tasksets;
+}
+
+YASS_EXPORT void yass_campaign_free(struct yass_campaign *c)
+{
+	int i;
+
+	if (c->sched != NULL) {
+		for (i = 0; i < c->n_schedulers; i++) {
+			if (c->sched[i] != NULL)
+				yass_sched_free(c->sched[i]);
+		}
+
+		free(c->sched);
+	}
+
+	if (c->sched_locks != NULL) {
+		for (i = 0; i < c->n_schedulers; i++)
+			pthread_mutex_destroy(&c->sched_locks[i]);
+
+		free(c->sched_locks);
+	}
+
+	free_strings(c->schedulers, c->n_schedulers);
+	free_strings(c->tasksets, c->n_tasksets);
+
+	free(c->cpu);
+
+	pthread_mutex_destroy(&c->lock);
+
+	free(c);
+}
@@ -0,0 +1,29 @@
+#ifndef _YASS_CAMPAIGN_H
+#define _YASS_CAMPAIGN_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_campaign;
+
+struct yass_campaign *yass_campaign_new(const char *spec, int *error);
+
+int yass_campaign_run(struct yass_campaign *campaign, int jobs, FILE * fp);
+
+void yass_campaign_set_seed(struct yass_campaign *campaign,
+			    unsigned long long seed);
+
+int yass_campaign_get_nschedulers(struct yass_campaign *campaign);
+
+int yass_campaign_get_ntasksets(struct yass_campaign *campaign);
+
+void yass_campaign_free(struct yass_campaign *campaign);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_CAMPAIGN_H */
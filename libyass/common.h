@@ -2,12 +2,7 @@
 #define _YASS_COMMON_H
 
 #include <limits.h>
-
-#define YASS_MAX_N_CPU 64
-#define YASS_MAX_N_TASKS 128
-#define YASS_MAX_N_SCHEDULERS 10
-#define YASS_MAX_N_TASK_EXECUTION 4096
-#define YASS_MAX_N_VMS 64
+#include <stdint.h>
 
 #define YASS_DEFAULT_N_JOBS 1
 #define YASS_DEFAULT_N_CPU 3
@@ -15,19 +10,21 @@
 
 #define YASS_DEFAULT_MIN_TICKS 100
 
-#define YASS_MAX_SEGMENTS 10
-#define YASS_MAX_THREADS 10
-
 #define YASS_MAX_PERIOD INT_MAX
 
+/* Value of yass_lcm() and of the hyperperiod when they overflow */
+#define YASS_HYPERPERIOD_OVERFLOW ULLONG_MAX
+
 #define YASS_MIN_WCET 10
 
 #define YASS_CPU_MODE_NORMAL -1
 #define YASS_CPU_MODE_WAKEUP -2
 
-#define YASS_IDLE_TASK_ID 987
-
-#define YASS_MAX_IDLE_PERIODS 10000
+/*
+ * Ids of the idle tasks added by schedulers, tasks of the task set
+ * must have lower ids.
+ */
+#define YASS_IDLE_TASK_ID 1000000000
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +42,62 @@ enum yass_events {
 	YASS_EVENT_CPU_CONSUMPTION,
 };
 
+/*
+ * Classes of events written to the trace and printed with verbose,
+ * combined in the trace mask of a scheduler.
+ */
+enum yass_trace_events {
+	YASS_TRACE_NONE = 0,
+	YASS_TRACE_TASKS = 1,	/* Releases, deadlines, runs, terminations */
+	YASS_TRACE_CPU = 2,	/* Speeds, modes and consumptions */
+	YASS_TRACE_ALL = YASS_TRACE_TASKS | YASS_TRACE_CPU,
+};
+
+enum yass_trace_format {
+	YASS_TRACE_TEXT,
+	YASS_TRACE_BINARY,
+	YASS_TRACE_COMPRESSED,
+};
+
+/*
+ * The binary trace is made of a header followed by one record per
+ * event, holding the six integers of a line of the text trace. The
+ * integers are in the byte order of the machine which wrote the trace.
+ */
+#define YASS_TRACE_MAGIC 0x5254597f	/* "\177YTR" in little-endian */
+#define YASS_TRACE_VERSION 1
+
+struct yass_trace_header {
+	uint32_t magic;
+	uint32_t version;
+
+	int32_t n_tasks;
+	int32_t n_cpus;
+	int32_t n_ticks;
+	int32_t n_schedulers;
+};
+
+struct yass_trace_record {
+	int32_t d[6];
+};
+
+/*
+ * The compressed trace has the same header, with its own magic,
+ * followed by blocks which can each be decoded on their own: a block
+ * header, then size bytes holding n_records records encoded in
+ * raw_size bytes, at most YASS_TRACE_BLOCK_SIZE, and compressed when
+ * size < raw_size.
+ */
+#define YASS_TRACE_MAGIC_COMPRESSED 0x5a54597f	/* "\177YTZ" in little-endian */
+
+#define YASS_TRACE_BLOCK_SIZE (64 << 10)
+
+struct yass_trace_block {
+	uint32_t size;
+	uint32_t raw_size;
+	uint32_t n_records;
+};
+
 enum yass_execution_class {
 	YASS_OFFLINE,
 	YASS_ONLINE,
@@ -63,6 +116,8 @@ enum yass_execution_class {
 
 enum yass_error_code {
 	YASS_ERROR_0,
+	YASS_ERROR_CAMPAIGN_FILE,
+	YASS_ERROR_CAMPAIGN_FILE_JSON,
 	YASS_ERROR_CPU_FILE,
 	YASS_ERROR_CPU_FILE_JSON,
 	YASS_ERROR_DATA_FILE,
@@ -71,6 +126,7 @@ enum yass_error_code {
 	YASS_ERROR_DLOPEN,
 	YASS_ERROR_DLSYM,
 	YASS_ERROR_FILE,
+	YASS_ERROR_HYPERPERIOD,
 	YASS_ERROR_ID_NOT_UNIQUE,
 	YASS_ERROR_MALLOC,
 	YASS_ERROR_MORE_THAN_ONE_CPU,
@@ -79,10 +135,14 @@ enum yass_error_code {
 	YASS_ERROR_N_TICKS,
 	YASS_ERROR_NOT_SCHEDULABLE,
 	YASS_ERROR_SCHEDULE,
+	YASS_ERROR_SCHEDULER_ABI,
 	YASS_ERROR_SCHEDULER_NOT_UNIQUE,
 	YASS_ERROR_SCHEDULER_NAME_TOO_SHORT,
 	YASS_ERROR_THREAD_CREATE,
-	YASS_ERROR_TICKS_HYPERPERIOD
+	YASS_ERROR_TICKS_HYPERPERIOD,
+	YASS_ERROR_TRACE_FORMAT,
+	YASS_ERROR_TRACE_EVENTS,
+	YASS_ERROR_TRACE_BLOCK
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,444 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compress.h"
+
+#include "common.h"
+#include "private.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 0xffff
+#define LZ_HASH_BITS 12
+
+/*
+ * Event classes whose previous record is kept: the events of enum
+ * yass_events, and a last one for any other value.
+ */
+#define N_SLOTS 8
+
+/* A byte for the slot and the changed fields, up to six varints */
+#define RECORD_MAX_SIZE (1 + 6 * 5)
+
+/*
+ * Records of the block being filled, encoded in raw, and its
+ * compressed form, after its header, in out. Each record is encoded
+ * against the previous record of the same event in the block.
+ */
+struct yass_trace_encoder {
+	int n_records;
+	int size;
+
+	int32_t last[N_SLOTS][6];
+
+	unsigned char raw[YASS_TRACE_BLOCK_SIZE];
+	unsigned char out[sizeof(struct yass_trace_block) +
+			  YASS_TRACE_BLOCK_SIZE];
+};
+
+static uint32_t read32(const unsigned char *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+static int lz_hash(uint32_t v)
+{
+	return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/*
+ * Lengths which do not fit in their 4 bits go on in the following
+ * bytes, 255 meaning that another byte follows.
+ */
+static unsigned char *put_length(unsigned char *p, int n)
+{
+	for (n -= 15; n >= 255; n -= 255)
+		*p++ = 255;
+
+	*p++ = n;
+
+	return p;
+}
+
+static unsigned char *put_sequence(unsigned char *p, const unsigned char *lit,
+				   int n_lit, int offset, int len)
+{
+	unsigned char *token = p++;
+
+	*token = (n_lit < 15 ? n_lit : 15) << 4;
+
+	if (n_lit >= 15)
+		p = put_length(p, n_lit);
+
+	memcpy(p, lit, n_lit);
+	p += n_lit;
+
+	/* The last sequence has no match */
+	if (len == 0)
+		return p;
+
+	*p++ = offset & 0xff;
+	*p++ = offset >> 8;
+
+	len -= LZ_MIN_MATCH;
+
+	*token |= len < 15 ? len : 15;
+
+	if (len >= 15)
+		p = put_length(p, len);
+
+	return p;
+}
+
+/*
+ * Compress the n bytes of in to out, as a sequence of literals and
+ * matches in the previous 64 KiB (LZ77), found greedily through a hash
+ * table of the last position of each 4-byte string. Each sequence is a
+ * token holding the number of literals and the length of the match,
+ * the literals and the offset of the match on two bytes. Return the
+ * compressed size, or 0 if it would not be smaller than n, out having
+ * room for n bytes.
+ */
+YASS_EXPORT int yass_compress(const unsigned char *in, int n,
+			      unsigned char *out)
+{
+	int anchor = 0, i = 0, h, len, n_lit, ref;
+	int table[1 << LZ_HASH_BITS];
+
+	unsigned char *p = out;
+
+	memset(table, -1, sizeof(table));
+
+	while (i + LZ_MIN_MATCH <= n) {
+		h = lz_hash(read32(in + i));
+		ref = table[h];
+		table[h] = i;
+
+		if (ref < 0 || i - ref > LZ_MAX_OFFSET ||
+		    read32(in + ref) != read32(in + i)) {
+			i++;
+			continue;
+		}
+
+		for (len = LZ_MIN_MATCH; i + len < n; len++) {
+			if (in[ref + len] != in[i + len])
+				break;
+		}
+
+		n_lit = i - anchor;
+
+		/* Largest size of the sequence */
+		if ((p - out) + 1 + n_lit / 255 + 1 + n_lit + 2 + len / 255 + 1
+		    >= n)
+			return 0;
+
+		p = put_sequence(p, in + anchor, n_lit, i - ref, len);
+
+		i += len;
+		anchor = i;
+	}
+
+	n_lit = n - anchor;
+
+	if ((p - out) + 1 + n_lit / 255 + 1 + n_lit >= n)
+		return 0;
+
+	p = put_sequence(p, in + anchor, n_lit, 0, 0);
+
+	return p - out;
+}
+
+static const unsigned char *get_length(const unsigned char *p,
+				       const unsigned char *end, int *n)
+{
+	int c;
+
+	do {
+		if (p == end || *n > YASS_TRACE_BLOCK_SIZE)
+			return NULL;
+
+		c = *p++;
+		*n += c;
+	} while (c == 255);
+
+	return p;
+}
+
+/*
+ * Decompress the n bytes of in, which must give exactly size bytes.
+ */
+YASS_EXPORT int yass_decompress(const unsigned char *in, int n,
+				unsigned char *out, int size)
+{
+	int i, len, n_lit, offset;
+
+	const unsigned char *p = in, *end = in + n;
+	unsigned char *q = out;
+
+	while (p < end) {
+		n_lit = *p >> 4;
+		len = *p++ & 15;
+
+		if (n_lit == 15 && (p = get_length(p, end, &n_lit)) == NULL)
+			return -YASS_ERROR_TRACE_BLOCK;
+
+		if (n_lit > end - p || n_lit > size - (q - out))
+			return -YASS_ERROR_TRACE_BLOCK;
+
+		memcpy(q, p, n_lit);
+		p += n_lit;
+		q += n_lit;
+
+		if (p == end)
+			break;
+
+		if (end - p < 2)
+			return -YASS_ERROR_TRACE_BLOCK;
+
+		offset = p[0] | p[1] << 8;
+		p += 2;
+
+		if (len == 15 && (p = get_length(p, end, &len)) == NULL)
+			return -YASS_ERROR_TRACE_BLOCK;
+
+		len += LZ_MIN_MATCH;
+
+		if (offset == 0 || offset > q - out || len > size - (q - out))
+			return -YASS_ERROR_TRACE_BLOCK;
+
+		/* The match can overlap the bytes it produces */
+		for (i = 0; i < len; i++)
+			q[i] = q[i - offset];
+
+		q += len;
+	}
+
+	return q - out == size ? 0 : -YASS_ERROR_TRACE_BLOCK;
+}
+
+static unsigned char *put_varint(unsigned char *p, uint32_t v)
+{
+	while (v >= 0x80) {
+		*p++ = v | 0x80;
+		v >>= 7;
+	}
+
+	*p++ = v;
+
+	return p;
+}
+
+static const unsigned char *get_varint(const unsigned char *p,
+				       const unsigned char *end, uint32_t *v)
+{
+	int shift;
+
+	*v = 0;
+
+	for (shift = 0; shift < 35; shift += 7) {
+		if (p == end)
+			return NULL;
+
+		*v |= (uint32_t)(*p & 0x7f) << shift;
+
+		if (!(*p++ & 0x80))
+			return p;
+	}
+
+	return NULL;
+}
+
+/*
+ * Differences are taken modulo 2^32 and mapped to small unsigned
+ * values whatever their sign.
+ */
+static uint32_t zigzag(int32_t a, int32_t b)
+{
+	uint32_t d = (uint32_t)a - (uint32_t)b;
+
+	return (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+}
+
+static int32_t unzigzag(uint32_t v, int32_t b)
+{
+	return (int32_t)(((v >> 1) ^ -(v & 1)) + (uint32_t)b);
+}
+
+static int event_slot(int32_t event)
+{
+	return event >= 0 && event < N_SLOTS - 1 ? event : N_SLOTS - 1;
+}
+
+YASS_EXPORT struct yass_trace_encoder *yass_trace_encoder_new(void)
+{
+	struct yass_trace_encoder *e = (struct yass_trace_encoder *)
+	    calloc(1, sizeof(struct yass_trace_encoder));
+
+	return e;
+}
+
+YASS_EXPORT void yass_trace_encoder_free(struct yass_trace_encoder *e)
+{
+	free(e);
+}
+
+/*
+ * Add a record to the current block: a byte holding the event slot
+ * and which of the other fields differ from the previous record of the
+ * same slot, the event itself for the last slot, then the difference
+ * of each of these fields. The ticks of the records of an event mostly
+ * grow by small steps, and the other fields repeat. Return 1 when the
+ * block is full and must be flushed before the next record.
+ */
+YASS_EXPORT int yass_trace_encoder_add(struct yass_trace_encoder *e,
+				       const struct yass_trace_record *r)
+{
+	int k, slot = event_slot(r->d[0]);
+
+	int32_t *last = e->last[slot];
+
+	unsigned char *start = e->raw + e->size, *p = start + 1;
+
+	*start = slot;
+
+	if (slot == N_SLOTS - 1)
+		p = put_varint(p, zigzag(r->d[0], 0));
+
+	for (k = 1; k < 6; k++) {
+		if (r->d[k] == last[k])
+			continue;
+
+		*start |= 1 << (k + 2);
+
+		p = put_varint(p, zigzag(r->d[k], last[k]));
+		last[k] = r->d[k];
+	}
+
+	e->size = p - e->raw;
+	e->n_records++;
+
+	return e->size + RECORD_MAX_SIZE > YASS_TRACE_BLOCK_SIZE;
+}
+
+/*
+ * Close the current block: set data to its header followed by its
+ * data, compressed if that makes it smaller, and return their size, 0
+ * if the block is empty. The next record starts a new block.
+ */
+YASS_EXPORT int yass_trace_encoder_flush(struct yass_trace_encoder *e,
+					 const void **data)
+{
+	int size;
+
+	struct yass_trace_block block;
+
+	unsigned char *out = e->out + sizeof(block);
+
+	if (e->n_records == 0)
+		return 0;
+
+	size = yass_compress(e->raw, e->size, out);
+
+	if (size == 0) {
+		memcpy(out, e->raw, e->size);
+		size = e->size;
+	}
+
+	block.size = size;
+	block.raw_size = e->size;
+	block.n_records = e->n_records;
+
+	memcpy(e->out, &block, sizeof(block));
+
+	*data = e->out;
+
+	e->n_records = 0;
+	e->size = 0;
+
+	memset(e->last, 0, sizeof(e->last));
+
+	return sizeof(block) + size;
+}
+
+/*
+ * Decode the n_records records of a block, given its header and its
+ * data. Blocks do not depend on each other, so that they can be
+ * decoded in any order, or concurrently.
+ */
+YASS_EXPORT int yass_trace_decode_block(const struct yass_trace_block *block,
+					const void *data,
+					struct yass_trace_record *records)
+{
+	int error = -YASS_ERROR_TRACE_BLOCK, fields, i, k, slot;
+
+	int32_t last[N_SLOTS][6];
+
+	uint32_t v;
+
+	const unsigned char *p, *end;
+	unsigned char *raw = NULL;
+
+	if (block->raw_size > YASS_TRACE_BLOCK_SIZE ||
+	    block->size > block->raw_size ||
+	    block->n_records > block->raw_size)
+		return -YASS_ERROR_TRACE_BLOCK;
+
+	p = (const unsigned char *)data;
+
+	if (block->size < block->raw_size) {
+		raw = (unsigned char *)malloc(block->raw_size);
+
+		if (raw == NULL)
+			return -YASS_ERROR_MALLOC;
+
+		if (yass_decompress(p, block->size, raw, block->raw_size))
+			goto end;
+
+		p = raw;
+	}
+
+	end = p + block->raw_size;
+
+	memset(last, 0, sizeof(last));
+
+	for (i = 0; i < (int)block->n_records; i++) {
+		if (p == end)
+			goto end;
+
+		fields = *p >> 3;
+		slot = *p++ & 7;
+
+		records[i].d[0] = slot;
+
+		if (slot == N_SLOTS - 1) {
+			if ((p = get_varint(p, end, &v)) == NULL)
+				goto end;
+
+			records[i].d[0] = unzigzag(v, 0);
+		}
+
+		for (k = 1; k < 6; k++) {
+			if (fields & (1 << (k - 1))) {
+				if ((p = get_varint(p, end, &v)) == NULL)
+					goto end;
+
+				last[slot][k] = unzigzag(v, last[slot][k]);
+			}
+
+			records[i].d[k] = last[slot][k];
+		}
+	}
+
+	if (p == end)
+		error = 0;
+
+ end:
+	free(raw);
+
+	return error;
+}
@@ -0,0 +1,35 @@
+#ifndef _YASS_COMPRESS_H
+#define _YASS_COMPRESS_H
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_trace_encoder;
+
+int yass_compress(const unsigned char *in, int n, unsigned char *out);
+
+int yass_decompress(const unsigned char *in, int n, unsigned char *out,
+		    int size);
+
+struct yass_trace_encoder *yass_trace_encoder_new(void);
+
+void yass_trace_encoder_free(struct yass_trace_encoder *e);
+
+int yass_trace_encoder_add(struct yass_trace_encoder *e,
+			   const struct yass_trace_record *r);
+
+int yass_trace_encoder_flush(struct yass_trace_encoder *e,
+			     const void **data);
+
+int yass_trace_decode_block(const struct yass_trace_block *block,
+			    const void *data,
+			    struct yass_trace_record *records);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_COMPRESS_H */
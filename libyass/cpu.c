@@ -40,6 +40,9 @@ struct yass_cpu {
 
 	int idle_time;
 	int idle_periods;
+
+	int n_idle_lengths;
+	int size_idle_lengths;
 	int *idle_lengths;
 
 	int ctx;
@@ -47,8 +50,6 @@ struct yass_cpu {
 
 static void cpu_fill_default(struct yass_cpu *cpu)
 {
-	int i;
-
 	cpu->task = -1;
 
 	cpu->speed = 1;
@@ -68,10 +69,9 @@ static void cpu_fill_default(struct yass_cpu *cpu)
 	cpu->idle_time = 0;
 	cpu->idle_periods = 0;
 
-	cpu->idle_lengths = (int *)malloc(YASS_MAX_IDLE_PERIODS * sizeof(int));
-
-	for (i = 0; i < YASS_MAX_IDLE_PERIODS; i++)
-		cpu->idle_lengths[i] = -1;
+	cpu->n_idle_lengths = 0;
+	cpu->size_idle_lengths = 0;
+	cpu->idle_lengths = NULL;
 
 	cpu->ctx = 0;
 }
@@ -257,11 +257,62 @@ static int cpu_alloc_states(struct yass_cpu *c1, struct yass_cpu *c2)
 	return 0;
 }
 
+/*
+ * Allocate n_cpus processors in their initial state, with the
+ * characteristics of c.
+ */
+static struct yass_cpu **cpu_alloc(struct yass_cpu *c, int n_cpus,
+				   int *error)
+{
+	int i;
+
+	struct yass_cpu **cpus;
+
+	cpus = (struct yass_cpu **)calloc(n_cpus, sizeof(struct yass_cpu));
+
+	if (cpus == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	for (i = 0; i < n_cpus; i++) {
+		cpus[i] = (struct yass_cpu *)malloc(sizeof(struct yass_cpu));
+
+		if (cpus[i] == NULL) {
+			*error = -YASS_ERROR_MALLOC;
+			return NULL;
+		}
+
+		cpu_fill_default(cpus[i]);
+
+		cpus[i]->name = (char *)malloc(strlen(c->name) + 1);
+
+		if (cpus[i]->name == NULL) {
+			*error = -YASS_ERROR_MALLOC;
+			return NULL;
+		}
+
+		strcpy(cpus[i]->name, c->name);
+
+		cpus[i]->type = c->type;
+
+		if (c->type == DISCRETE) {
+			if ((*error = cpu_alloc_discrete(cpus[i], c)) != 0)
+				return NULL;
+		}
+
+		if (c->n_states > 0) {
+			if ((*error = cpu_alloc_states(cpus[i], c)) != 0)
+				return NULL;
+		}
+	}
+
+	return cpus;
+}
+
 YASS_EXPORT struct yass_cpu **yass_cpu_new(const char *cpu, int n_cpus,
 					   int *error)
 {
-	unsigned int i;
-
 	FILE *fp;
 
 	char filename[128];
@@ -339,44 +390,10 @@ YASS_EXPORT struct yass_cpu **yass_cpu_new(const char *cpu, int n_cpus,
 			return NULL;
 	}
 
-	cpus = (struct yass_cpu **)calloc(n_cpus, sizeof(struct yass_cpu));
+	cpus = cpu_alloc(c, n_cpus, error);
 
-	if (cpus == NULL) {
-		*error = -YASS_ERROR_MALLOC;
+	if (cpus == NULL)
 		return NULL;
-	}
-
-	for (i = 0; i < (unsigned int)n_cpus; i++) {
-		cpus[i] = (struct yass_cpu *)malloc(sizeof(struct yass_cpu));
-
-		if (cpus[i] == NULL) {
-			*error = -YASS_ERROR_MALLOC;
-			return NULL;
-		}
-
-		cpu_fill_default(cpus[i]);
-
-		cpus[i]->name = (char *)malloc(strlen(c->name) + 1);
-
-		if (cpus[i]->name == NULL) {
-			*error = -YASS_ERROR_MALLOC;
-			return NULL;
-		}
-
-		strcpy(cpus[i]->name, c->name);
-
-		cpus[i]->type = c->type;
-
-		if (c->type == DISCRETE) {
-			if ((*error = cpu_alloc_discrete(cpus[i], c)) != 0)
-				return NULL;
-		}
-
-		if (c->n_states > 0) {
-			if ((*error = cpu_alloc_states(cpus[i], c)) != 0)
-				return NULL;
-		}
-	}
 
 	json_decref(root);
 
@@ -401,6 +418,18 @@ YASS_EXPORT struct yass_cpu **yass_cpu_new(const char *cpu, int n_cpus,
 	return cpus;
 }
 
+/*
+ * Allocate new processors with the same characteristics as the ones
+ * of sched, without reading the processor file again.
+ */
+YASS_EXPORT struct yass_cpu **yass_cpu_copy(struct sched *sched, int *error)
+{
+	*error = 0;
+
+	return cpu_alloc(yass_sched_get_cpu(sched, 0),
+			 yass_sched_get_ncpus(sched), error);
+}
+
 YASS_EXPORT void yass_cpu_free(struct sched *sched, int cpu)
 {
 	struct yass_cpu *c = yass_sched_get_cpu(sched, cpu);
@@ -468,8 +497,10 @@ YASS_EXPORT void yass_cpu_set_speed(struct sched *sched, int cpu, double speed)
 
 	c->speed = processor_speed;
 
-	yass_log_sched(sched, YASS_EVENT_CPU_SPEED, yass_sched_get_index(sched),
-		       cpu, (int)(processor_speed * 100), 0, 0);
+	if (yass_log_enabled(sched, YASS_TRACE_CPU))
+		yass_log_sched(sched, YASS_EVENT_CPU_SPEED,
+			       yass_sched_get_index(sched), cpu,
+			       (int)(processor_speed * 100), 0, 0);
 }
 
 YASS_EXPORT double yass_cpu_get_average_speed(struct sched *sched, int cpu)
@@ -576,6 +607,16 @@ YASS_EXPORT void yass_cpu_set_nactive(struct sched *sched, int cpu,
 }
 
 YASS_EXPORT void yass_cpu_cons_inc(struct sched *sched, int cpu)
+{
+	yass_cpu_cons_add_ticks(sched, cpu, 1);
+}
+
+/*
+ * Add the consumption of n_ticks ticks during which the processor
+ * keeps the same task and the same speed.
+ */
+YASS_EXPORT void yass_cpu_cons_add_ticks(struct sched *sched, int cpu,
+					 int n_ticks)
 {
 	int criticality, i, id;
 
@@ -601,10 +642,10 @@ YASS_EXPORT void yass_cpu_cons_inc(struct sched *sched, int cpu)
 		return;
 
 	if (speed != 0) {
-		n_active++;
+		n_active += n_ticks;
 
-		average_speed = (average_speed * (n_active - 1) +
-				 speed) / n_active;
+		average_speed = (average_speed * (n_active - n_ticks) +
+				 speed * n_ticks) / n_active;
 
 		yass_cpu_set_nactive(sched, cpu, n_active);
 		yass_cpu_set_average_speed(sched, cpu, average_speed);
@@ -614,14 +655,14 @@ YASS_EXPORT void yass_cpu_cons_inc(struct sched *sched, int cpu)
 	case DISCRETE:
 		for (i = 0; i < c->n_discrete; i++) {
 			if (speed == c->discrete[i]) {
-				c->discrete_n_active[i]++;
-				consumption += c->discrete_cons[i];
+				c->discrete_n_active[i] += n_ticks;
+				consumption += c->discrete_cons[i] * n_ticks;
 			}
 		}
 		break;
 	case CONTINUOUS:
 		/* consumption += pow(speed, 2.5); */
-		consumption += speed;
+		consumption += speed * n_ticks;
 
 		break;
 	}
@@ -772,6 +813,14 @@ YASS_EXPORT void yass_cpu_increase_idle_time(struct sched *sched, int cpu)
 	c->idle_time++;
 }
 
+YASS_EXPORT void yass_cpu_add_idle_time(struct sched *sched, int cpu,
+					int n_ticks)
+{
+	struct yass_cpu *c = yass_sched_get_cpu(sched, cpu);
+
+	c->idle_time += n_ticks;
+}
+
 YASS_EXPORT void yass_cpu_reset_idle_time(struct sched *sched, int cpu)
 {
 	struct yass_cpu *c = yass_sched_get_cpu(sched, cpu);
@@ -797,10 +846,21 @@ YASS_EXPORT void yass_cpu_increase_idle_periods(struct sched *sched, int cpu)
 
 	struct yass_cpu *c = yass_sched_get_cpu(sched, cpu);
 
-	while (c->idle_lengths[i] != -1)
-		i++;
+	int *idle_lengths;
 
-	c->idle_lengths[i] = idle_time;
+	if (c->n_idle_lengths == c->size_idle_lengths) {
+		i = c->size_idle_lengths ? 2 * c->size_idle_lengths : 64;
+
+		idle_lengths = (int *)realloc(c->idle_lengths, i * sizeof(int));
+
+		if (idle_lengths != NULL) {
+			c->idle_lengths = idle_lengths;
+			c->size_idle_lengths = i;
+		}
+	}
+
+	if (c->n_idle_lengths < c->size_idle_lengths)
+		c->idle_lengths[c->n_idle_lengths++] = idle_time;
 
 	for (i = c->n_states - 1; i >= 0; i--) {
 		penalty = c->states_penalty[i];
@@ -836,6 +896,9 @@ YASS_EXPORT int yass_cpu_get_idle_length(struct sched *sched, int cpu, int i)
 {
 	struct yass_cpu *c = yass_sched_get_cpu(sched, cpu);
 
+	if (i < 0 || i >= c->n_idle_lengths)
+		return -1;
+
 	return c->idle_lengths[i];
 }
 
@@ -9,6 +9,8 @@ extern "C" {
 
 struct yass_cpu **yass_cpu_new(const char *cpu, int n_cpus, int *error);
 
+struct yass_cpu **yass_cpu_copy(struct sched *sched, int *error);
+
 void yass_cpu_free(struct sched *sched, int cpu);
 
 int yass_cpu_get_type(struct sched *sched, int cpu);
@@ -48,6 +50,8 @@ void yass_cpu_set_nactive(struct sched *sched, int cpu, int n_active);
 
 void yass_cpu_cons_inc(struct sched *sched, int cpu);
 
+void yass_cpu_cons_add_ticks(struct sched *sched, int cpu, int n_ticks);
+
 void yass_cpu_cons_add_penalty(struct sched *sched, int cpu, double penalty);
 
 double yass_cpu_cons_get_total(struct sched *sched);
@@ -66,6 +70,8 @@ void yass_cpu_reset_idle_time(struct sched *sched, int cpu);
 
 void yass_cpu_increase_idle_time(struct sched *sched, int cpu);
 
+void yass_cpu_add_idle_time(struct sched *sched, int cpu, int n_ticks);
+
 int yass_cpu_get_idle_periods(struct sched *sched, int cpu);
 
 void yass_cpu_increase_idle_periods(struct sched *sched, int cpu);
@@ -0,0 +1,147 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "exec_time.h"
+
+#include "private.h"
+#include "rng.h"
+#include "task.h"
+
+/*
+ * Actual execution times of the jobs of a task set. Nothing is
+ * stored: the execution time of a job is computed from a random
+ * stream keyed by (seed, task id, job index), so that it is
+ * the same for every scheduler and every thread, whatever the order
+ * in which the jobs are asked for.
+ */
+struct yass_exec_time {
+	unsigned long long seed;
+
+	int n_tasks;
+	int *id;
+	int *wcet;
+};
+
+/*
+ * Each job has its own stream, so that its execution time does not
+ * depend on the other jobs.
+ */
+static void job_rng(struct yass_exec_time *e, struct yass_rng *rng, int id,
+		    int n)
+{
+	unsigned long long stream;
+
+	stream = (unsigned long long)(unsigned int)id << 32 | (unsigned int)n;
+
+	yass_rng_init(rng, e->seed, stream);
+}
+
+/*
+ * Gumbel distribution. See :
+ *  http://en.wikipedia.org/wiki/Gumbel_distribution
+ */
+__attribute__ ((__unused__))
+static int generate_gumbel(struct yass_rng *rng, int min, int max)
+{
+	double r = -10, u;
+
+	while (r < -5 || r > 20) {
+
+		u = yass_rng_uniform(rng);
+
+		r = 2 - 4 * log(- log(u));
+	}
+
+	r += 5;
+	r *= (max - min) / 25;
+	r += min;
+
+	return (int)r;
+}
+
+/*
+ * Normal distribution, using Box–Muller method. See :
+ *  http://en.wikipedia.org/wiki/Normal_distribution
+ */
+static int generate_normal(struct yass_rng *rng, int min, int max)
+{
+	double r = 10, u, v;
+
+	while (r < -4 || r > 4) {
+
+		u = yass_rng_uniform(rng);
+		v = yass_rng_uniform(rng);
+
+		r = sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+	}
+
+	r += 4;
+	r *= (max - min) / 8;
+	r += min;
+
+	return (int)r;
+}
+
+YASS_EXPORT struct yass_exec_time *yass_exec_time_new(struct yass_task **tasks,
+						      int n_tasks,
+						      unsigned long long seed)
+{
+	int i;
+
+	struct yass_exec_time *e;
+
+	e = (struct yass_exec_time *)malloc(sizeof(struct yass_exec_time));
+
+	if (e == NULL)
+		return NULL;
+
+	e->seed = seed;
+	e->n_tasks = n_tasks;
+
+	e->id = (int *)malloc(n_tasks * sizeof(int));
+	e->wcet = (int *)malloc(n_tasks * sizeof(int));
+
+	if (e->id == NULL || e->wcet == NULL) {
+		yass_exec_time_free(e);
+		return NULL;
+	}
+
+	for (i = 0; i < n_tasks; i++) {
+		e->id[i] = tasks[i]->id;
+		e->wcet[i] = tasks[i]->wcet;
+	}
+
+	return e;
+}
+
+/*
+ * Actual execution time of the job n of the task at the given index
+ * of the task set.
+ */
+YASS_EXPORT int yass_exec_time_get(struct yass_exec_time *e, int index, int n)
+{
+	/* min = round(0.5 * wcet); */
+	int min = 1;
+	int max = e->wcet[index];
+
+	struct yass_rng rng;
+
+	job_rng(e, &rng, e->id[index], n);
+
+	return generate_normal(&rng, min, max);
+}
+
+YASS_EXPORT int yass_exec_time_get_ntasks(struct yass_exec_time *e)
+{
+	return e->n_tasks;
+}
+
+YASS_EXPORT void yass_exec_time_free(struct yass_exec_time *e)
+{
+	if (e == NULL)
+		return;
+
+	free(e->id);
+	free(e->wcet);
+	free(e);
+}
@@ -0,0 +1,25 @@
+#ifndef _YASS_EXEC_TIME_H
+#define _YASS_EXEC_TIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_exec_time;
+struct yass_task;
+
+struct yass_exec_time *yass_exec_time_new(struct yass_task **tasks,
+					  int n_tasks,
+					  unsigned long long seed);
+
+int yass_exec_time_get(struct yass_exec_time *e, int index, int n);
+
+int yass_exec_time_get_ntasks(struct yass_exec_time *e);
+
+void yass_exec_time_free(struct yass_exec_time *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_EXEC_TIME_H */
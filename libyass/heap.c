@@ -0,0 +1,310 @@
+#include <stdlib.h>
+
+#include "heap.h"
+
+#include "common.h"
+#include "private.h"
+#include "scheduler.h"
+
+/*
+ * Indexed binary min-heap of the tasks of a scheduler, ordered by an
+ * integer key and then by id, e.g. by absolute deadline for EDF. The
+ * position of each task in the heap is stored by task index, so that
+ * a task can be removed or have its key changed in O(log n).
+ */
+struct yass_heap {
+	struct sched *sched;
+
+	int n;
+	int size;
+
+	int *ids;
+	int *keys;
+	int *pos;		/* Position of each task, by task index */
+
+	/* Positions still to be visited by yass_heap_iter_next() */
+	int n_iter;
+	int *iter;
+};
+
+static int heap_less(struct yass_heap *h, int i, int j)
+{
+	if (h->keys[i] != h->keys[j])
+		return h->keys[i] < h->keys[j];
+
+	return h->ids[i] < h->ids[j];
+}
+
+static void heap_swap(struct yass_heap *h, int i, int j)
+{
+	int id = h->ids[i];
+	int key = h->keys[i];
+
+	h->ids[i] = h->ids[j];
+	h->keys[i] = h->keys[j];
+	h->ids[j] = id;
+	h->keys[j] = key;
+
+	h->pos[yass_sched_get_task_from_id(h->sched, h->ids[i])] = i;
+	h->pos[yass_sched_get_task_from_id(h->sched, h->ids[j])] = j;
+}
+
+static void sift_up(struct yass_heap *h, int i)
+{
+	while (i > 0 && heap_less(h, i, (i - 1) / 2)) {
+		heap_swap(h, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void sift_down(struct yass_heap *h, int i)
+{
+	int c;
+
+	for (;;) {
+		c = 2 * i + 1;
+
+		if (c >= h->n)
+			break;
+
+		if (c + 1 < h->n && heap_less(h, c + 1, c))
+			c++;
+
+		if (!heap_less(h, c, i))
+			break;
+
+		heap_swap(h, i, c);
+		i = c;
+	}
+}
+
+static int heap_pos(struct yass_heap *h, int id)
+{
+	int index = yass_sched_get_task_from_id(h->sched, id);
+
+	if (index < 0 || index >= h->size)
+		return -1;
+
+	return h->pos[index];
+}
+
+/*
+ * Heap able to hold every task of sched. Tasks added to sched
+ * afterwards (idle tasks) cannot be added to it.
+ */
+YASS_EXPORT struct yass_heap *yass_heap_new(struct sched *sched)
+{
+	int i;
+
+	int size = yass_sched_get_ntasks(sched);
+
+	struct yass_heap *h =
+	    (struct yass_heap *)malloc(sizeof(struct yass_heap));
+
+	if (h == NULL)
+		return NULL;
+
+	h->sched = sched;
+	h->n = 0;
+	h->n_iter = 0;
+	h->size = size;
+
+	h->ids = (int *)malloc(size * sizeof(int));
+	h->keys = (int *)malloc(size * sizeof(int));
+	h->pos = (int *)malloc(size * sizeof(int));
+	h->iter = (int *)malloc(size * sizeof(int));
+
+	if ((h->ids == NULL || h->keys == NULL || h->pos == NULL ||
+	     h->iter == NULL) && size > 0) {
+		yass_heap_free(h);
+		return NULL;
+	}
+
+	for (i = 0; i < size; i++)
+		h->pos[i] = -1;
+
+	return h;
+}
+
+YASS_EXPORT void yass_heap_free(struct yass_heap *h)
+{
+	free(h->ids);
+	free(h->keys);
+	free(h->pos);
+	free(h->iter);
+	free(h);
+}
+
+YASS_EXPORT void yass_heap_add(struct yass_heap *h, int id, int key)
+{
+	int index = yass_sched_get_task_from_id(h->sched, id);
+
+	yass_warn(index >= 0 && index < h->size);
+	yass_warn(!yass_heap_present(h, id));
+
+	if (index < 0 || index >= h->size || h->pos[index] != -1)
+		return;
+
+	h->ids[h->n] = id;
+	h->keys[h->n] = key;
+	h->pos[index] = h->n;
+
+	h->n++;
+
+	sift_up(h, h->n - 1);
+}
+
+YASS_EXPORT void yass_heap_remove(struct yass_heap *h, int id)
+{
+	int i = heap_pos(h, id);
+
+	yass_warn(i != -1);
+
+	if (i == -1)
+		return;
+
+	h->n--;
+
+	if (i != h->n) {
+		heap_swap(h, i, h->n);
+		sift_down(h, i);
+		sift_up(h, i);
+	}
+
+	h->pos[yass_sched_get_task_from_id(h->sched, id)] = -1;
+}
+
+YASS_EXPORT void yass_heap_update(struct yass_heap *h, int id, int key)
+{
+	int i = heap_pos(h, id);
+
+	yass_warn(i != -1);
+
+	if (i == -1)
+		return;
+
+	h->keys[i] = key;
+
+	sift_down(h, i);
+	sift_up(h, i);
+}
+
+YASS_EXPORT int yass_heap_present(struct yass_heap *h, int id)
+{
+	return heap_pos(h, id) != -1;
+}
+
+YASS_EXPORT int yass_heap_n(struct yass_heap *h)
+{
+	return h->n;
+}
+
+YASS_EXPORT int yass_heap_get_key(struct yass_heap *h, int id)
+{
+	int i = heap_pos(h, id);
+
+	yass_warn(i != -1);
+
+	return i != -1 ? h->keys[i] : 0;
+}
+
+/*
+ * Task with the smallest key, or -1 if the heap is empty.
+ */
+YASS_EXPORT int yass_heap_top(struct yass_heap *h)
+{
+	if (h->n == 0)
+		return -1;
+
+	return h->ids[0];
+}
+
+/*
+ * Iterate over the tasks in key order without modifying the heap:
+ * the candidates for the next task are the children of the tasks
+ * already returned, kept in a second heap of positions. Getting the
+ * first m tasks costs O(m log m). The heap must not be modified during
+ * the iteration.
+ */
+YASS_EXPORT void yass_heap_iter_init(struct yass_heap *h)
+{
+	h->n_iter = 0;
+
+	if (h->n > 0)
+		h->iter[h->n_iter++] = 0;
+}
+
+static void iter_push(struct yass_heap *h, int p)
+{
+	int i = h->n_iter++;
+
+	while (i > 0 && heap_less(h, p, h->iter[(i - 1) / 2])) {
+		h->iter[i] = h->iter[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+
+	h->iter[i] = p;
+}
+
+YASS_EXPORT int yass_heap_iter_next(struct yass_heap *h)
+{
+	int c, i, last, p;
+
+	if (h->n_iter == 0)
+		return -1;
+
+	p = h->iter[0];
+	last = h->iter[--h->n_iter];
+
+	/* Sift last down from the root */
+	i = 0;
+
+	for (;;) {
+		c = 2 * i + 1;
+
+		if (c >= h->n_iter)
+			break;
+
+		if (c + 1 < h->n_iter &&
+		    heap_less(h, h->iter[c + 1], h->iter[c]))
+			c++;
+
+		if (!heap_less(h, h->iter[c], last))
+			break;
+
+		h->iter[i] = h->iter[c];
+		i = c;
+	}
+
+	if (h->n_iter > 0)
+		h->iter[i] = last;
+
+	if (2 * p + 1 < h->n)
+		iter_push(h, 2 * p + 1);
+	if (2 * p + 2 < h->n)
+		iter_push(h, 2 * p + 2);
+
+	return h->ids[p];
+}
+
+/*
+ * Store in ids the (at most) m tasks with the smallest keys, in key
+ * order, and return their number.
+ */
+YASS_EXPORT int yass_heap_first(struct yass_heap *h, int m, int *ids)
+{
+	int i, id;
+
+	yass_heap_iter_init(h);
+
+	for (i = 0; i < m; i++) {
+		id = yass_heap_iter_next(h);
+
+		if (id == -1)
+			break;
+
+		ids[i] = id;
+	}
+
+	return i;
+}
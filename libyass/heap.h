@@ -0,0 +1,40 @@
+#ifndef _YASS_HEAP_H
+#define _YASS_HEAP_H
+
+#include "yass.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_heap;
+
+struct yass_heap *yass_heap_new(struct sched *sched);
+
+void yass_heap_free(struct yass_heap *h);
+
+void yass_heap_add(struct yass_heap *h, int id, int key);
+
+void yass_heap_remove(struct yass_heap *h, int id);
+
+void yass_heap_update(struct yass_heap *h, int id, int key);
+
+int yass_heap_present(struct yass_heap *h, int id);
+
+int yass_heap_get_key(struct yass_heap *h, int id);
+
+int yass_heap_n(struct yass_heap *h);
+
+int yass_heap_top(struct yass_heap *h);
+
+void yass_heap_iter_init(struct yass_heap *h);
+
+int yass_heap_iter_next(struct yass_heap *h);
+
+int yass_heap_first(struct yass_heap *h, int m, int *ids);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_HEAP_H */
@@ -1,6 +1,7 @@
 #include <limits.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "helpers.h"
 
@@ -9,6 +10,7 @@
 #include "log.h"
 #include "list.h"
 #include "private.h"
+#include "simd.h"
 #include "task.h"
 #include "scheduler.h"
 
@@ -116,26 +118,35 @@ YASS_EXPORT int yass_check_ready_tasks(struct sched *sched,
 				       struct yass_list *stalled,
 				       struct yass_list *ready)
 {
-	int delay, i, id, period, r = 0, tick_delay;
+	int i, r = 0, w;
 	int tick = yass_sched_get_tick(sched);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		id = yass_task_get_id(sched, i);
-		period = yass_task_get_period(sched, id);
-		delay = yass_task_get_delay(sched, id);
+	unsigned long long bits, *released;
 
-		tick_delay = tick - delay;
+	struct yass_task_table *t = sched->table;
 
-		if (tick_delay < 0)
-			continue;
+	released = (unsigned long long *)
+	    yass_sched_alloc(sched, YASS_SIMD_MASK_WORDS(t->size) *
+			     sizeof(unsigned long long));
 
-		if (tick_delay % period == 0 && yass_list_present(stalled, id)) {
-			yass_list_remove(stalled, id);
-			yass_list_add(ready, id);
+	if (released == NULL)
+		return 0;
 
-			yass_task_set_release(sched, id, tick + period);
+	yass_simd_mod_mask(tick, t->size, t->delay, t->period, NULL, released);
 
-			r = 1;
+	for (w = 0; w < YASS_SIMD_MASK_WORDS(t->size); w++) {
+		for (bits = released[w]; bits != 0; bits &= bits - 1) {
+			i = w * 64 + __builtin_ctzll(bits);
+
+			if (yass_list_present(stalled, t->id[i])) {
+				yass_list_remove(stalled, t->id[i]);
+				yass_list_add(ready, t->id[i]);
+
+				yass_task_set_release(sched, t->id[i],
+						      tick + t->period[i]);
+
+				r = 1;
+			}
 		}
 	}
 
@@ -158,7 +169,8 @@ YASS_EXPORT void yass_terminate_task(struct sched *sched, int cpu, int id,
 	if (stalled != NULL)
 		yass_list_add(stalled, id);
 
-	if (!yass_sched_task_is_idle_task(sched, id)) {
+	if (yass_log_enabled(sched, YASS_TRACE_TASKS) &&
+	    !yass_sched_task_is_idle_task(sched, id)) {
 		yass_log_sched(sched,
 			       YASS_EVENT_TASK_TERMINATE,
 			       yass_sched_get_index(sched), id, tick, cpu, 0);
@@ -176,7 +188,8 @@ YASS_EXPORT void yass_terminate_task_tick(struct sched *sched, int cpu,
 	if (stalled != NULL)
 		yass_list_add(stalled, id);
 
-	if (!yass_sched_task_is_idle_task(sched, id)) {
+	if (yass_log_enabled(sched, YASS_TRACE_TASKS) &&
+	    !yass_sched_task_is_idle_task(sched, id)) {
 		yass_log_sched(sched,
 			       YASS_EVENT_TASK_TERMINATE,
 			       yass_sched_get_index(sched), id, tick, cpu, 0);
@@ -194,7 +207,8 @@ YASS_EXPORT void yass_preempt_task(struct sched *sched, int cpu,
 
 	yass_warn(yass_cpu_is_active(sched, cpu));
 
-	if (!yass_sched_task_is_idle_task(sched, id)) {
+	if (yass_log_enabled(sched, YASS_TRACE_TASKS) &&
+	    !yass_sched_task_is_idle_task(sched, id)) {
 		yass_log_sched(sched,
 			       YASS_EVENT_TASK_TERMINATE,
 			       yass_sched_get_index(sched), id, tick, cpu, 0);
@@ -212,7 +226,8 @@ YASS_EXPORT void yass_run_task(struct sched *sched, int cpu, int id,
 {
 	int tick = yass_sched_get_tick(sched);
 
-	if (!yass_sched_task_is_idle_task(sched, id)) {
+	if (yass_log_enabled(sched, YASS_TRACE_TASKS) &&
+	    !yass_sched_task_is_idle_task(sched, id)) {
 		yass_log_sched(sched,
 			       YASS_EVENT_TASK_RUN,
 			       yass_sched_get_index(sched), id, tick, cpu, 0);
@@ -224,87 +239,171 @@ YASS_EXPORT void yass_run_task(struct sched *sched, int cpu, int id,
 	yass_cpu_set_task(sched, cpu, id);
 }
 
-YASS_EXPORT void yass_sort_list_int(struct sched *sched, struct yass_list *q,
-				    int (*f) (struct sched *, int))
+/*
+ * Task of a list to sort, with its sort key computed once. Integer keys
+ * are exact in a double.
+ */
+struct sort_key {
+	double key;
+	int id;
+};
+
+static int sort_key_less(const struct sort_key *a, const struct sort_key *b)
 {
-	int i, j;
-	int n, tmp;
+	return a->key < b->key || (a->key == b->key && a->id < b->id);
+}
+
+/*
+ * Fill keys with the tasks of q and their key, given either by fi or by
+ * fd. Keys are taken from the scratch memory of sched.
+ */
+static struct sort_key *sort_keys(struct sched *sched, struct yass_list *q,
+				  int (*fi) (struct sched *, int),
+				  double (*fd) (struct sched *, int))
+{
+	int i, id;
 
-	int id1, id2;
-	int r1, r2;
+	int n = yass_list_n(q);
 
-	if (yass_list_n(q) <= 1)
-		return;
+	struct sort_key *keys;
 
-	for (i = 0; i < yass_list_n(q); i++) {
-		id1 = yass_list_get(q, i);
-		r1 = f(sched, id1);
+	keys = (struct sort_key *)yass_sched_alloc(sched, 2 * n *
+						   sizeof(struct sort_key));
+
+	yass_warn(keys != NULL);
+
+	if (keys == NULL)
+		return NULL;
+
+	for (i = 0; i < n; i++) {
+		id = yass_list_get(q, i);
+
+		keys[i].id = id;
+		keys[i].key = fi != NULL ? fi(sched, id) : fd(sched, id);
+	}
+
+	return keys;
+}
+
+static void sort_keys_store(struct yass_list *q, struct sort_key *keys)
+{
+	int i;
+
+	for (i = 0; i < yass_list_n(q); i++)
+		yass_list_set(q, i, keys[i].id);
+}
 
-		n = -1;
+/*
+ * Bottom-up merge sort of the n first keys, using the n following ones
+ * as a buffer.
+ */
+static void merge_sort(struct sort_key *keys, int n)
+{
+	int i, j, k, l, m, r, width;
 
-		for (j = i + 1; j < yass_list_n(q); j++) {
-			id2 = yass_list_get(q, j);
+	struct sort_key *a = keys, *b = keys + n, *tmp;
 
-			if (id2 == -1)
-				continue;
+	for (width = 1; width < n; width *= 2) {
+		for (l = 0; l < n; l += 2 * width) {
+			m = l + width < n ? l + width : n;
+			r = l + 2 * width < n ? l + 2 * width : n;
 
-			r2 = f(sched, id2);
+			i = l;
+			j = m;
 
-			if (r2 < r1 || (r2 == r1 && id2 < id1)) {
-				n = j;
-				r1 = r2;
-				id1 = id2;
+			for (k = l; k < r; k++) {
+				if (i < m &&
+				    (j >= r || !sort_key_less(&a[j], &a[i])))
+					b[k] = a[i++];
+				else
+					b[k] = a[j++];
 			}
 		}
 
-		if (n != -1) {
-			tmp = yass_list_get(q, i);
-			yass_list_set(q, i, yass_list_get(q, n));
-			yass_list_set(q, n, tmp);
-		}
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	if (a != keys) {
+		for (i = 0; i < n; i++)
+			keys[i] = a[i];
 	}
 }
 
-YASS_EXPORT void yass_sort_list_double(struct sched *sched,
-				       struct yass_list *q,
-				       double (*f) (struct sched *, int))
+static void insertion_sort(struct sort_key *keys, int n)
 {
 	int i, j;
-	int n, tmp;
 
-	int id1, id2;
-	double r1, r2;
+	struct sort_key k;
+
+	for (i = 1; i < n; i++) {
+		k = keys[i];
+
+		for (j = i; j > 0 && sort_key_less(&k, &keys[j - 1]); j--)
+			keys[j] = keys[j - 1];
+
+		keys[j] = k;
+	}
+}
+
+static void sort_list(struct sched *sched, struct yass_list *q,
+		      int (*fi) (struct sched *, int),
+		      double (*fd) (struct sched *, int), int nearly_sorted)
+{
+	struct sort_key *keys;
 
 	if (yass_list_n(q) <= 1)
 		return;
 
-	for (i = 0; i < yass_list_n(q); i++) {
-		id1 = yass_list_get(q, i);
-		r1 = f(sched, id1);
+	keys = sort_keys(sched, q, fi, fd);
 
-		n = -1;
+	if (keys == NULL)
+		return;
 
-		for (j = i + 1; j < yass_list_n(q); j++) {
-			id2 = yass_list_get(q, j);
+	if (nearly_sorted)
+		insertion_sort(keys, yass_list_n(q));
+	else
+		merge_sort(keys, yass_list_n(q));
 
-			if (id2 == -1)
-				continue;
+	sort_keys_store(q, keys);
+}
 
-			r2 = f(sched, id2);
+/*
+ * Sort the list by increasing value of f, and then by increasing id.
+ * f is called once per task.
+ */
+YASS_EXPORT void yass_sort_list_int(struct sched *sched, struct yass_list *q,
+				    int (*f) (struct sched *, int))
+{
+	sort_list(sched, q, f, NULL, 0);
+}
 
-			if (r2 < r1 || (r2 == r1 && id2 < id1)) {
-				n = j;
-				r1 = r2;
-				id1 = id2;
-			}
-		}
+YASS_EXPORT void yass_sort_list_double(struct sched *sched,
+				       struct yass_list *q,
+				       double (*f) (struct sched *, int))
+{
+	sort_list(sched, q, NULL, f, 0);
+}
 
-		if (n != -1) {
-			tmp = yass_list_get(q, i);
-			yass_list_set(q, i, yass_list_get(q, n));
-			yass_list_set(q, n, tmp);
-		}
-	}
+/*
+ * Same as yass_sort_list_int(), for a list which is already nearly
+ * sorted, e.g. sorted at the previous tick with a few tasks added at
+ * the end since. It runs in O(n + number of misplaced pairs).
+ */
+YASS_EXPORT void yass_insert_sort_list_int(struct sched *sched,
+					   struct yass_list *q,
+					   int (*f) (struct sched *, int))
+{
+	sort_list(sched, q, f, NULL, 1);
+}
+
+YASS_EXPORT void yass_insert_sort_list_double(struct sched *sched,
+					      struct yass_list *q,
+					      double (*f) (struct sched *,
+							   int))
+{
+	sort_list(sched, q, NULL, f, 1);
 }
 
 YASS_EXPORT int yass_optimal_schedulability_test(struct sched *sched)
@@ -375,96 +474,169 @@ YASS_EXPORT void yass_print_task_set(struct sched *sched)
 }
 
 /*
- * There must be another way to write this function, it seems so
- * ugly. And it may not work in some situations.
+ * Binary GCD (Stein's algorithm), exact for any 64-bit value.
  */
 YASS_EXPORT unsigned long long yass_gcd(unsigned long long a,
 					unsigned long long b)
 {
-	float div = (double)b / (double)a;
-	unsigned long long d = b / a;
+	int shift;
 
-	if (div - d < 0 || div - d > 0)
-		return yass_gcd(b - d * a, a);
-	else
+	if (a == 0)
+		return b;
+	if (b == 0)
 		return a;
+
+	shift = __builtin_ctzll(a | b);
+
+	a >>= __builtin_ctzll(a);
+
+	do {
+		b >>= __builtin_ctzll(b);
+
+		if (a > b) {
+			unsigned long long t = b;
+			b = a;
+			a = t;
+		}
+
+		b -= a;
+	} while (b != 0);
+
+	return a << shift;
 }
 
 YASS_EXPORT unsigned long long yass_lcm(unsigned long long a,
 					unsigned long long b)
 {
-	unsigned long long g = yass_gcd(a, b);
+	unsigned long long g;
+
+	if (a == 0 || b == 0)
+		return 0;
+
+	if (a == YASS_HYPERPERIOD_OVERFLOW || b == YASS_HYPERPERIOD_OVERFLOW)
+		return YASS_HYPERPERIOD_OVERFLOW;
+
+	g = yass_gcd(a, b);
+
+	a /= g;
 
-	return a * b / g;
+	if (a > YASS_HYPERPERIOD_OVERFLOW / b)
+		return YASS_HYPERPERIOD_OVERFLOW;
+
+	return a * b;
 }
 
-YASS_EXPORT int yass_compute_intervals(struct sched *sched, int *I)
+/*
+ * Build the sorted list of the period boundaries of the tasks in the
+ * hyperperiod, starting with 0, by merging the multiples of their
+ * periods. The list is kept until the tasks change.
+ */
+static int build_intervals(struct sched *sched)
 {
-	unsigned long long t, tick, tmp;
-	int n_intervals = 0;
+	int n = 0, size = 0, t = 0;
+	int *b = NULL, *tmp;
 
 	unsigned long long h = yass_sched_get_hyperperiod(sched);
 
-	tick = yass_sched_get_tick(sched);
+	if (sched->intervals != NULL)
+		return 0;
 
-	t = tick;
+	yass_warn(h <= INT_MAX);
 
-	while (t < tick + h) {
-		tmp = yass_sched_get_next_boundary(sched, t);
+	if (h > INT_MAX)
+		return -YASS_ERROR_HYPERPERIOD;
 
-		I[n_intervals] = tmp - t;
-		n_intervals++;
+	while (t >= 0 && (unsigned long long)t < h) {
+		if (n == size) {
+			size = size > 0 ? 2 * size : 64;
+
+			tmp = (int *)realloc(b, size * sizeof(int));
+
+			if (tmp == NULL) {
+				free(b);
+				return -YASS_ERROR_MALLOC;
+			}
 
-		t = tmp;
+			b = tmp;
+		}
+
+		b[n++] = t;
 
-		yass_warn(n_intervals < INT_MAX);
+		t = yass_sched_get_next_boundary(sched, t);
 	}
 
-	return n_intervals;
+	sched->n_intervals = n;
+	sched->intervals = b;
+
+	return 0;
 }
 
-YASS_EXPORT int yass_get_current_interval(struct sched *sched)
+/*
+ * Number of period boundaries of the hyperperiod not after tick,
+ * which must be in the hyperperiod.
+ */
+static int count_boundaries(struct sched *sched, int tick)
 {
-	int i, r = -1, t = 0;
-	int id, period;
+	int i = 0, j = sched->n_intervals, k;
 
-	int n_tasks = yass_sched_get_ntasks(sched);
+	while (i < j) {
+		k = (i + j) / 2;
 
-	int tick = yass_sched_get_tick(sched);;
-	int h = yass_sched_get_hyperperiod(sched);
+		if (sched->intervals[k] <= tick)
+			i = k + 1;
+		else
+			j = k;
+	}
 
-	while (tick >= h)
-		tick -= h;
+	return i;
+}
 
-	while (t <= tick) {
-		for (i = 0; i < n_tasks; i++) {
-			id = yass_task_get_id(sched, i);
-			period = yass_task_get_period(sched, id);
+YASS_EXPORT int yass_compute_intervals(struct sched *sched, int *I)
+{
+	int h, i, n, next, start, t;
+	int n_intervals = 0;
 
-			if (t % period == 0) {
-				r++;
-				break;
-			}
-		}
+	if (build_intervals(sched) || sched->n_intervals == 0)
+		return 0;
+
+	h = yass_sched_get_hyperperiod(sched);
+	n = sched->n_intervals;
+
+	start = yass_sched_get_tick(sched) % h;
 
-		t++;
+	/*
+	 * From the first boundary after the current tick, up to one
+	 * hyperperiod later. The boundaries of the next hyperperiod are
+	 * those of the list shifted by h.
+	 */
+	for (i = count_boundaries(sched, start), t = start; t < start + h;
+	     i++) {
+		next = sched->intervals[i % n] + (i / n) * h;
+
+		I[n_intervals] = next - t;
+		n_intervals++;
+
+		t = next;
 	}
 
-	return r;
+	return n_intervals;
 }
 
-YASS_EXPORT int yass_tick_is_interval_boundary(struct sched *sched, int tick)
+YASS_EXPORT int yass_get_current_interval(struct sched *sched)
 {
-	int i;
-	int id, period;
+	int tick = yass_sched_get_tick(sched);
+	int h = yass_sched_get_hyperperiod(sched);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		id = yass_task_get_id(sched, i);
-		period = yass_task_get_period(sched, id);
+	if (build_intervals(sched))
+		return -1;
 
-		if (tick % period == 0)
-			return 1;
-	}
+	while (tick >= h)
+		tick -= h;
 
-	return 0;
+	return count_boundaries(sched, tick) - 1;
+}
+
+YASS_EXPORT int yass_tick_is_interval_boundary(struct sched *sched, int tick)
+{
+	return yass_sched_get_next_boundary(sched, tick - 1) == tick;
 }
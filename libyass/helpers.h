@@ -42,6 +42,12 @@ void yass_sort_list_int(struct sched *sched, struct yass_list *q,
 void yass_sort_list_double(struct sched *sched, struct yass_list *q,
 			    double (*f) (struct sched *, int));
 
+void yass_insert_sort_list_int(struct sched *sched, struct yass_list *q,
+			       int (*f) (struct sched *, int));
+
+void yass_insert_sort_list_double(struct sched *sched, struct yass_list *q,
+				  double (*f) (struct sched *, int));
+
 int yass_optimal_schedulability_test(struct sched *sched);
 
 int yass_rm_schedulability_test(struct sched *sched);
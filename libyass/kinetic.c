@@ -0,0 +1,443 @@
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "kinetic.h"
+
+#include "common.h"
+#include "heap.h"
+#include "private.h"
+#include "scheduler.h"
+
+/*
+ * Kinetic heap of the tasks of a scheduler: the key of each task is a
+ * linear function of the tick, a + b * tick, e.g. its laxity. The heap
+ * is ordered at the current tick, by key and then by id. Each task
+ * which is not the root has a certificate, the first tick at which it
+ * comes before its parent. Certificates are kept in a heap, so that
+ * moving to a later tick only swaps the tasks whose order changed.
+ */
+struct yass_kinetic {
+	struct sched *sched;
+
+	int tick;
+
+	int n;
+	int size;
+
+	int *ids;
+	double *a;
+	double *b;
+	int *pos;		/* Position of each task, by task index */
+
+	/* Failure tick of the certificate of each task, by id */
+	struct yass_heap *certs;
+
+	int n_iter;
+	int *iter;
+};
+
+static double key(struct yass_kinetic *k, int p, int tick)
+{
+	return k->a[p] + k->b[p] * tick;
+}
+
+static int less(struct yass_kinetic *k, int p, int q, int tick)
+{
+	double kp = key(k, p, tick);
+	double kq = key(k, q, tick);
+
+	if (kp != kq)
+		return kp < kq;
+
+	return k->ids[p] < k->ids[q];
+}
+
+/*
+ * First tick from from on at which the task at p comes before the one
+ * at q, or INT_MAX. Keys are linear, so once p comes before q it stays
+ * before.
+ */
+static int first_before(struct yass_kinetic *k, int p, int q, int from)
+{
+	int tick;
+	double slope, crossing;
+
+	if (less(k, p, q, from))
+		return from;
+
+	slope = k->b[q] - k->b[p];
+
+	if (slope <= 0)
+		return INT_MAX;
+
+	crossing = (k->a[p] - k->a[q]) / slope;
+
+	if (crossing >= INT_MAX - 2)
+		return INT_MAX;
+
+	/* Rounding errors are fixed by the loop */
+	tick = (int)floor(crossing) - 1;
+
+	if (tick <= from)
+		tick = from + 1;
+
+	while (!less(k, p, q, tick))
+		tick++;
+
+	return tick;
+}
+
+static void cert_update(struct yass_kinetic *k, int p)
+{
+	int id, tick;
+
+	if (p >= k->n)
+		return;
+
+	id = k->ids[p];
+
+	tick = p > 0 ? first_before(k, p, (p - 1) / 2, k->tick) : INT_MAX;
+
+	if (tick == INT_MAX) {
+		if (yass_heap_present(k->certs, id))
+			yass_heap_remove(k->certs, id);
+	} else if (yass_heap_present(k->certs, id)) {
+		yass_heap_update(k->certs, id, tick);
+	} else {
+		yass_heap_add(k->certs, id, tick);
+	}
+}
+
+/*
+ * Update the certificates of the edges of the node at p.
+ */
+static void cert_update_node(struct yass_kinetic *k, int p)
+{
+	cert_update(k, p);
+	cert_update(k, 2 * p + 1);
+	cert_update(k, 2 * p + 2);
+}
+
+static void set_pos(struct yass_kinetic *k, int p)
+{
+	k->pos[yass_sched_get_task_from_id(k->sched, k->ids[p])] = p;
+}
+
+static void swap(struct yass_kinetic *k, int p, int q)
+{
+	int id = k->ids[p];
+	double a = k->a[p];
+	double b = k->b[p];
+
+	k->ids[p] = k->ids[q];
+	k->a[p] = k->a[q];
+	k->b[p] = k->b[q];
+	k->ids[q] = id;
+	k->a[q] = a;
+	k->b[q] = b;
+
+	set_pos(k, p);
+	set_pos(k, q);
+}
+
+static int sift_up(struct yass_kinetic *k, int p)
+{
+	while (p > 0 && less(k, p, (p - 1) / 2, k->tick)) {
+		swap(k, p, (p - 1) / 2);
+		cert_update_node(k, p);
+		p = (p - 1) / 2;
+	}
+
+	return p;
+}
+
+static int sift_down(struct yass_kinetic *k, int p)
+{
+	int c;
+
+	for (;;) {
+		c = 2 * p + 1;
+
+		if (c >= k->n)
+			break;
+
+		if (c + 1 < k->n && less(k, c + 1, c, k->tick))
+			c++;
+
+		if (!less(k, c, p, k->tick))
+			break;
+
+		swap(k, p, c);
+		cert_update_node(k, p);
+		p = c;
+	}
+
+	return p;
+}
+
+static void fix(struct yass_kinetic *k, int p)
+{
+	p = sift_down(k, p);
+	p = sift_up(k, p);
+
+	cert_update_node(k, p);
+}
+
+static int kinetic_pos(struct yass_kinetic *k, int id)
+{
+	int index = yass_sched_get_task_from_id(k->sched, id);
+
+	if (index < 0 || index >= k->size)
+		return -1;
+
+	return k->pos[index];
+}
+
+/*
+ * Kinetic heap able to hold every task of sched, at tick 0.
+ */
+YASS_EXPORT struct yass_kinetic *yass_kinetic_new(struct sched *sched)
+{
+	int i;
+
+	int size = yass_sched_get_ntasks(sched);
+
+	struct yass_kinetic *k =
+	    (struct yass_kinetic *)malloc(sizeof(struct yass_kinetic));
+
+	if (k == NULL)
+		return NULL;
+
+	k->sched = sched;
+	k->tick = 0;
+	k->n = 0;
+	k->n_iter = 0;
+	k->size = size;
+
+	k->ids = (int *)malloc(size * sizeof(int));
+	k->a = (double *)malloc(size * sizeof(double));
+	k->b = (double *)malloc(size * sizeof(double));
+	k->pos = (int *)malloc(size * sizeof(int));
+	k->iter = (int *)malloc(size * sizeof(int));
+	k->certs = yass_heap_new(sched);
+
+	if (((k->ids == NULL || k->a == NULL || k->b == NULL ||
+	      k->pos == NULL || k->iter == NULL) && size > 0) ||
+	    k->certs == NULL) {
+		yass_kinetic_free(k);
+		return NULL;
+	}
+
+	for (i = 0; i < size; i++)
+		k->pos[i] = -1;
+
+	return k;
+}
+
+YASS_EXPORT void yass_kinetic_free(struct yass_kinetic *k)
+{
+	if (k->certs != NULL)
+		yass_heap_free(k->certs);
+
+	free(k->ids);
+	free(k->a);
+	free(k->b);
+	free(k->pos);
+	free(k->iter);
+	free(k);
+}
+
+YASS_EXPORT void yass_kinetic_add(struct yass_kinetic *k, int id, double a,
+				  double b)
+{
+	int index = yass_sched_get_task_from_id(k->sched, id);
+
+	yass_warn(index >= 0 && index < k->size);
+	yass_warn(!yass_kinetic_present(k, id));
+
+	k->ids[k->n] = id;
+	k->a[k->n] = a;
+	k->b[k->n] = b;
+	k->pos[index] = k->n;
+
+	k->n++;
+
+	fix(k, k->n - 1);
+}
+
+YASS_EXPORT void yass_kinetic_remove(struct yass_kinetic *k, int id)
+{
+	int p = kinetic_pos(k, id);
+
+	yass_warn(p != -1);
+
+	if (p == -1)
+		return;
+
+	if (yass_heap_present(k->certs, id))
+		yass_heap_remove(k->certs, id);
+
+	k->pos[yass_sched_get_task_from_id(k->sched, id)] = -1;
+
+	k->n--;
+
+	if (p == k->n)
+		return;
+
+	k->ids[p] = k->ids[k->n];
+	k->a[p] = k->a[k->n];
+	k->b[p] = k->b[k->n];
+
+	set_pos(k, p);
+
+	fix(k, p);
+}
+
+/*
+ * Change the key function of a task, e.g. when it starts or stops
+ * running.
+ */
+YASS_EXPORT void yass_kinetic_update(struct yass_kinetic *k, int id,
+				     double a, double b)
+{
+	int p = kinetic_pos(k, id);
+
+	yass_warn(p != -1);
+
+	if (p == -1)
+		return;
+
+	k->a[p] = a;
+	k->b[p] = b;
+
+	fix(k, p);
+}
+
+YASS_EXPORT int yass_kinetic_present(struct yass_kinetic *k, int id)
+{
+	return kinetic_pos(k, id) != -1;
+}
+
+YASS_EXPORT int yass_kinetic_n(struct yass_kinetic *k)
+{
+	return k->n;
+}
+
+/*
+ * Move the heap to the given tick, which cannot be before the current
+ * one. Failed certificates are handled in tick order: the task comes
+ * before its parent, they are swapped.
+ */
+YASS_EXPORT void yass_kinetic_advance(struct yass_kinetic *k, int tick)
+{
+	int id, p, q;
+
+	yass_warn(tick >= k->tick);
+
+	while (yass_heap_n(k->certs) > 0) {
+		id = yass_heap_top(k->certs);
+
+		if (yass_heap_get_key(k->certs, id) > tick)
+			break;
+
+		k->tick = yass_heap_get_key(k->certs, id);
+
+		p = kinetic_pos(k, id);
+		q = (p - 1) / 2;
+
+		swap(k, p, q);
+
+		cert_update_node(k, q);
+		cert_update_node(k, p);
+	}
+
+	k->tick = tick;
+}
+
+static void iter_push(struct yass_kinetic *k, int p)
+{
+	int i = k->n_iter++;
+
+	while (i > 0 && less(k, p, k->iter[(i - 1) / 2], k->tick)) {
+		k->iter[i] = k->iter[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+
+	k->iter[i] = p;
+}
+
+static int iter_pop(struct yass_kinetic *k)
+{
+	int c, i = 0, last, p;
+
+	p = k->iter[0];
+	last = k->iter[--k->n_iter];
+
+	for (;;) {
+		c = 2 * i + 1;
+
+		if (c >= k->n_iter)
+			break;
+
+		if (c + 1 < k->n_iter &&
+		    less(k, k->iter[c + 1], k->iter[c], k->tick))
+			c++;
+
+		if (!less(k, k->iter[c], last, k->tick))
+			break;
+
+		k->iter[i] = k->iter[c];
+		i = c;
+	}
+
+	if (k->n_iter > 0)
+		k->iter[i] = last;
+
+	return p;
+}
+
+/*
+ * Store in ids the (at most) m tasks with the smallest keys at the
+ * current tick, in key order, and return their number. O(m log m).
+ */
+YASS_EXPORT int yass_kinetic_first(struct yass_kinetic *k, int m, int *ids)
+{
+	int i, p;
+
+	k->n_iter = 0;
+
+	if (k->n > 0)
+		k->iter[k->n_iter++] = 0;
+
+	for (i = 0; i < m && k->n_iter > 0; i++) {
+		p = iter_pop(k);
+
+		ids[i] = k->ids[p];
+
+		if (2 * p + 1 < k->n)
+			iter_push(k, 2 * p + 1);
+		if (2 * p + 2 < k->n)
+			iter_push(k, 2 * p + 2);
+	}
+
+	return i;
+}
+
+/*
+ * First tick from from on at which id1 comes before id2, or INT_MAX if
+ * it never does.
+ */
+YASS_EXPORT int yass_kinetic_crossing(struct yass_kinetic *k, int id1,
+				      int id2, int from)
+{
+	int p = kinetic_pos(k, id1);
+	int q = kinetic_pos(k, id2);
+
+	yass_warn(p != -1 && q != -1);
+
+	if (p == -1 || q == -1)
+		return INT_MAX;
+
+	return first_before(k, p, q, from);
+}
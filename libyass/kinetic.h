@@ -0,0 +1,36 @@
+#ifndef _YASS_KINETIC_H
+#define _YASS_KINETIC_H
+
+#include "yass.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_kinetic;
+
+struct yass_kinetic *yass_kinetic_new(struct sched *sched);
+
+void yass_kinetic_free(struct yass_kinetic *k);
+
+void yass_kinetic_add(struct yass_kinetic *k, int id, double a, double b);
+
+void yass_kinetic_remove(struct yass_kinetic *k, int id);
+
+void yass_kinetic_update(struct yass_kinetic *k, int id, double a, double b);
+
+int yass_kinetic_present(struct yass_kinetic *k, int id);
+
+int yass_kinetic_n(struct yass_kinetic *k);
+
+void yass_kinetic_advance(struct yass_kinetic *k, int tick);
+
+int yass_kinetic_first(struct yass_kinetic *k, int m, int *ids);
+
+int yass_kinetic_crossing(struct yass_kinetic *k, int id1, int id2, int from);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_KINETIC_H */
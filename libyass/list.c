@@ -1,3 +1,4 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -5,13 +6,117 @@
 
 #include "common.h"
 #include "private.h"
-
+#include "scheduler.h"
+
+/* Removed slot of tasks, or empty slot of the index */
+#define EMPTY INT_MIN
+
+/*
+ * Tasks are kept in an array, in the order in which they were added
+ * (or set). Removing a task only clears its slot: the array is
+ * compacted the next time it is read, so that removing several tasks
+ * in a row costs a single pass. An open addressing hash table maps
+ * each task to its slot, for constant time membership tests.
+ */
 struct yass_list {
 	int n;			/* Number of tasks */
 	int size;
 	int *tasks;
+
+	int end;		/* Slots used in tasks, removed ones included */
+
+	int mask;		/* Size of the index - 1 */
+	int shift;		/* 32 - log2 of the size of the index */
+	int *keys;
+	int *slots;
 };
 
+static unsigned int hash(struct yass_list *q, int n)
+{
+	return ((unsigned int)n * 2654435761U) >> q->shift;
+}
+
+static int index_find(struct yass_list *q, int n)
+{
+	unsigned int h = hash(q, n);
+
+	while (q->keys[h] != EMPTY) {
+		if (q->keys[h] == n)
+			return h;
+
+		h = (h + 1) & q->mask;
+	}
+
+	return -1;
+}
+
+static void index_add(struct yass_list *q, int n, int slot)
+{
+	unsigned int h = hash(q, n);
+
+	while (q->keys[h] != EMPTY && q->keys[h] != n)
+		h = (h + 1) & q->mask;
+
+	q->keys[h] = n;
+	q->slots[h] = slot;
+}
+
+/*
+ * Linear probing without tombstones: move back the following keys
+ * which would not be found anymore once h is empty.
+ */
+static void index_remove(struct yass_list *q, int h)
+{
+	unsigned int i = h, j = h, k;
+
+	for (;;) {
+		j = (j + 1) & q->mask;
+
+		if (q->keys[j] == EMPTY)
+			break;
+
+		k = hash(q, q->keys[j]);
+
+		if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+			continue;
+
+		q->keys[i] = q->keys[j];
+		q->slots[i] = q->slots[j];
+		i = j;
+	}
+
+	q->keys[i] = EMPTY;
+}
+
+static void compact(struct yass_list *q)
+{
+	int h, i, j = 0;
+
+	if (q->end == q->n)
+		return;
+
+	for (i = 0; i < q->end; i++) {
+		if (q->tasks[i] == EMPTY)
+			continue;
+
+		if (i != j) {
+			h = index_find(q, q->tasks[i]);
+
+			if (h != -1)
+				q->slots[h] = j;
+
+			q->tasks[j] = q->tasks[i];
+		}
+
+		j++;
+	}
+
+	for (i = q->n; i < q->end; i++)
+		q->tasks[i] = -1;
+
+	q->end = q->n;
+}
+
 YASS_EXPORT void yass_list_add(struct yass_list *q, int n)
 {
 	if (q == NULL)
@@ -20,46 +125,48 @@ YASS_EXPORT void yass_list_add(struct yass_list *q, int n)
 	yass_warn(q->n < q->size);
 	yass_warn(!yass_list_present(q, n));
 
-	q->tasks[q->n] = n;
+	if (q->n == q->size || index_find(q, n) != -1)
+		return;
+
+	if (q->end == q->size)
+		compact(q);
 
+	q->tasks[q->end] = n;
+	index_add(q, n, q->end);
+
+	q->end++;
 	q->n++;
 }
 
 YASS_EXPORT int yass_list_remove(struct yass_list *q, int n)
 {
-	int i;
-	int found = -1;
+	int h;
 
 	if (q == NULL)
 		return -1;
 
 	yass_warn(yass_list_present(q, n));
 
-	for (i = 0; i < q->size; i++) {
-		if (q->tasks[i] == n)
-			found = 0;
+	h = index_find(q, n);
 
-		if (found == 0 && i < q->size - 1) {
-			q->tasks[i] = q->tasks[i + 1];
-		}
-	}
+	if (h == -1)
+		return -1;
+
+	q->tasks[q->slots[h]] = EMPTY;
+	index_remove(q, h);
 
-	q->tasks[q->size - 1] = -1;
 	q->n--;
 
-	return found;
+	return 0;
 }
 
 YASS_EXPORT int yass_list_present(struct yass_list *q, int n)
 {
-	int i;
-
-	for (i = 0; i < q->size; i++) {
-		if (q->tasks[i] == n)
-			return 1;
-	}
+	/* Empty slots hold -1, schedulers rely on it for idle cpus */
+	if (n == -1)
+		return q->n < q->size;
 
-	return 0;
+	return index_find(q, n) != -1;
 }
 
 YASS_EXPORT int yass_list_size(struct yass_list *q)
@@ -74,34 +181,111 @@ YASS_EXPORT int yass_list_n(struct yass_list *q)
 
 YASS_EXPORT int yass_list_get(struct yass_list *q, int index)
 {
+	compact(q);
+
 	return q->tasks[index];
 }
 
 YASS_EXPORT void yass_list_set(struct yass_list *q, int index, int value)
 {
+	int h;
+
+	compact(q);
+
+	h = index_find(q, q->tasks[index]);
+
+	if (h != -1 && q->slots[h] == index)
+		index_remove(q, h);
+
 	q->tasks[index] = value;
+
+	if (index < q->n)
+		index_add(q, value, index);
 }
 
-YASS_EXPORT struct yass_list *yass_list_new(int size)
+static int index_size(int size, int *shift)
+{
+	int n_keys = 8;
+
+	*shift = 29;
+
+	while (n_keys < 2 * size) {
+		n_keys *= 2;
+		(*shift)--;
+	}
+
+	return n_keys;
+}
+
+static void list_init(struct yass_list *q, int size, int n_keys, int shift)
 {
 	int i;
 
+	for (i = 0; i < size; i++)
+		q->tasks[i] = -1;
+
+	for (i = 0; i < n_keys; i++)
+		q->keys[i] = EMPTY;
+
+	q->n = 0;
+	q->end = 0;
+	q->size = size;
+	q->mask = n_keys - 1;
+	q->shift = shift;
+}
+
+YASS_EXPORT struct yass_list *yass_list_new(int size)
+{
+	int n_keys, shift;
+
 	struct yass_list *q =
-	    (struct yass_list *)malloc((2 + size) * sizeof(int));
+	    (struct yass_list *)malloc(sizeof(struct yass_list));
 
 	if (q == NULL)
 		return NULL;
 
+	n_keys = index_size(size, &shift);
+
 	q->tasks = (int *)malloc(size * sizeof(int));
+	q->keys = (int *)malloc(n_keys * sizeof(int));
+	q->slots = (int *)malloc(n_keys * sizeof(int));
 
-	if (q->tasks == NULL)
+	if (q->tasks == NULL || q->keys == NULL || q->slots == NULL) {
+		yass_list_free(q);
 		return NULL;
+	}
 
-	for (i = 0; i < size; i++)
-		q->tasks[i] = -1;
+	list_init(q, size, n_keys, shift);
 
-	q->n = 0;
-	q->size = size;
+	return q;
+}
+
+/*
+ * List taken from the scratch memory of sched, released at the end of
+ * the tick: it must not be given to yass_list_free().
+ */
+YASS_EXPORT struct yass_list *yass_list_new_scratch(struct sched *sched,
+						    int size)
+{
+	int n_keys, shift;
+
+	struct yass_list *q =
+	    (struct yass_list *)yass_sched_alloc(sched,
+						 sizeof(struct yass_list));
+
+	if (q == NULL)
+		return NULL;
+
+	n_keys = index_size(size, &shift);
+
+	q->tasks = (int *)yass_sched_alloc(sched, size * sizeof(int));
+	q->keys = (int *)yass_sched_alloc(sched, n_keys * sizeof(int));
+	q->slots = (int *)yass_sched_alloc(sched, n_keys * sizeof(int));
+
+	if (q->tasks == NULL || q->keys == NULL || q->slots == NULL)
+		return NULL;
+
+	list_init(q, size, n_keys, shift);
 
 	return q;
 }
@@ -109,25 +293,34 @@ YASS_EXPORT struct yass_list *yass_list_new(int size)
 YASS_EXPORT void yass_list_free(struct yass_list *q)
 {
 	free(q->tasks);
+	free(q->keys);
+	free(q->slots);
 	free(q);
 }
 
 YASS_EXPORT int yass_list_index(struct yass_list *q, int n)
 {
-	int i;
+	int h;
 
-	for (i = 0; i < q->size; i++) {
-		if (q->tasks[i] == n)
-			return i;
-	}
+	compact(q);
 
-	return -1;
+	if (n == -1)
+		return q->n < q->size ? q->n : -1;
+
+	h = index_find(q, n);
+
+	if (h == -1)
+		return -1;
+
+	return q->slots[h];
 }
 
 YASS_EXPORT void yass_list_print(struct yass_list *q)
 {
 	int i;
 
+	compact(q);
+
 	for (i = 0; i < q->n; i++)
 		printf(" %d", q->tasks[i]);
 
@@ -5,6 +5,8 @@
 extern "C" {
 #endif
 
+struct sched;
+
 struct yass_list;
 
 void yass_list_add(struct yass_list *q, int n);
@@ -23,6 +25,8 @@ void yass_list_set(struct yass_list *q, int index, int value);
 
 struct yass_list *yass_list_new(int size);
 
+struct yass_list *yass_list_new_scratch(struct sched *sched, int size);
+
 void yass_list_free(struct yass_list *q);
 
 int yass_list_index(struct yass_list *q, int n);
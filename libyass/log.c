@@ -1,19 +1,31 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "log.h"
 
 #include "common.h"
+#include "compress.h"
 #include "private.h"
 #include "scheduler.h"
+#include "writer.h"
 #include "yass.h"
 
-YASS_EXPORT FILE *yass_log_new(struct yass *yass, const char *output)
+#define LOG_BUFFER_SIZE (1 << 20)
+
+/*
+ * Create the trace file and write its header, in the given format
+ * (enum yass_trace_format). The schedulers writing to it must be set
+ * to the same format.
+ */
+YASS_EXPORT FILE *yass_log_new(struct yass *yass, const char *output,
+			       int format)
 {
 	FILE *fp;
 	char tmp[128] = "";
 
 	struct sched *sched = yass_get_sched(yass, 0);
+	struct yass_trace_header header;
 
 	if ((fp = fopen(output, "r")) != NULL) {
 		fclose(fp);
@@ -25,6 +37,25 @@ YASS_EXPORT FILE *yass_log_new(struct yass *yass, const char *output)
 	if ((fp = fopen(output, "w+")) == NULL)
 		return NULL;
 
+	setvbuf(fp, NULL, _IOFBF, LOG_BUFFER_SIZE);
+
+	if (format != YASS_TRACE_TEXT) {
+		header.magic = format == YASS_TRACE_BINARY ? YASS_TRACE_MAGIC :
+		    YASS_TRACE_MAGIC_COMPRESSED;
+		header.version = YASS_TRACE_VERSION;
+		header.n_tasks = yass_sched_get_ntasks(sched);
+		header.n_cpus = yass_sched_get_ncpus(sched);
+		header.n_ticks = yass_get_nticks(yass);
+		header.n_schedulers = yass_get_nschedulers(yass);
+
+		if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+			fclose(fp);
+			return NULL;
+		}
+
+		return fp;
+	}
+
 	fprintf(fp, "%d %d %d %d\n",
 		yass_sched_get_ntasks(sched),
 		yass_sched_get_ncpus(sched),
@@ -33,48 +64,294 @@ YASS_EXPORT FILE *yass_log_new(struct yass *yass, const char *output)
 	return fp;
 }
 
+/*
+ * Give each scheduler writing a trace its own segment, a temporary
+ * file with a large buffer, so that schedulers run by different
+ * threads neither share a FILE nor interleave their events.
+ */
+YASS_EXPORT int yass_log_segments_new(struct yass *yass)
+{
+	int i;
+
+	struct sched *sched;
+
+	for (i = 0; i < yass_get_nschedulers(yass); i++) {
+		sched = yass_get_sched(yass, i);
+
+		if (yass_sched_get_fp(sched) == NULL)
+			continue;
+
+		sched->segment = tmpfile();
+
+		if (sched->segment == NULL)
+			return -YASS_ERROR_FILE;
+
+		setvbuf(sched->segment, NULL, _IOFBF, LOG_BUFFER_SIZE);
+	}
+
+	return 0;
+}
+
+/*
+ * Append the segments to the traces in the order of the schedulers,
+ * so that the trace does not depend on the number of threads, and
+ * close them.
+ */
+YASS_EXPORT int yass_log_segments_merge(struct yass *yass)
+{
+	int error = 0, i;
+
+	size_t n;
+
+	char *buffer = NULL;
+
+	struct sched *sched;
+
+	for (i = 0; i < yass_get_nschedulers(yass); i++) {
+		sched = yass_get_sched(yass, i);
+
+		if (sched->segment == NULL)
+			continue;
+
+		if (buffer == NULL && !error) {
+			buffer = (char *)malloc(LOG_BUFFER_SIZE);
+
+			if (buffer == NULL)
+				error = -YASS_ERROR_MALLOC;
+		}
+
+		rewind(sched->segment);
+
+		while (!error && (n = fread(buffer, 1, LOG_BUFFER_SIZE,
+					    sched->segment)) > 0) {
+			if (fwrite(buffer, 1, n, yass_sched_get_fp(sched)) != n)
+				error = -YASS_ERROR_FILE;
+		}
+
+		if (ferror(sched->segment))
+			error = -YASS_ERROR_FILE;
+
+		fclose(sched->segment);
+		sched->segment = NULL;
+	}
+
+	free(buffer);
+
+	return error;
+}
+
+/*
+ * Hand the trace and the verbose output of each scheduler to the
+ * writer thread, so that the schedulers do not wait for the writes.
+ */
+YASS_EXPORT int yass_log_streams_new(struct yass *yass,
+				     struct yass_writer *writer)
+{
+	int i;
+
+	FILE *fp;
+
+	struct sched *sched;
+
+	for (i = 0; i < yass_get_nschedulers(yass); i++) {
+		sched = yass_get_sched(yass, i);
+
+		fp = sched->segment != NULL ? sched->segment : sched->fp;
+
+		if (fp != NULL) {
+			sched->stream = yass_stream_new(writer, fp);
+
+			if (sched->stream == NULL)
+				return -YASS_ERROR_MALLOC;
+		}
+
+		if (yass_sched_get_verbose(sched)) {
+			sched->verbose_stream = yass_stream_new(writer, stdout);
+
+			if (sched->verbose_stream == NULL)
+				return -YASS_ERROR_MALLOC;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Give the last buffers of the streams to the writer thread.
+ */
+YASS_EXPORT void yass_log_streams_free(struct yass *yass)
+{
+	int i;
+
+	struct sched *sched;
+
+	for (i = 0; i < yass_get_nschedulers(yass); i++) {
+		sched = yass_get_sched(yass, i);
+
+		yass_stream_free(sched->stream);
+		yass_stream_free(sched->verbose_stream);
+
+		sched->stream = NULL;
+		sched->verbose_stream = NULL;
+	}
+}
+
+/*
+ * Give each scheduler writing a compressed trace the encoder of its
+ * blocks.
+ */
+YASS_EXPORT int yass_log_encoders_new(struct yass *yass)
+{
+	int i;
+
+	struct sched *sched;
+
+	for (i = 0; i < yass_get_nschedulers(yass); i++) {
+		sched = yass_get_sched(yass, i);
+
+		if (yass_sched_get_fp(sched) == NULL ||
+		    yass_sched_get_trace_format(sched) != YASS_TRACE_COMPRESSED)
+			continue;
+
+		sched->encoder = yass_trace_encoder_new();
+
+		if (sched->encoder == NULL)
+			return -YASS_ERROR_MALLOC;
+	}
+
+	return 0;
+}
+
+/*
+ * A single write per record, or per block, keeps them whole when
+ * schedulers share a file.
+ */
+static void log_write(struct sched *sched, const void *data, size_t n)
+{
+	if (sched->stream != NULL)
+		yass_stream_write(sched->stream, data, n);
+	else
+		fwrite(data, 1, n,
+		       sched->segment != NULL ? sched->segment : sched->fp);
+}
+
+static void log_flush_block(struct sched *sched)
+{
+	int n;
+
+	const void *data;
+
+	n = yass_trace_encoder_flush(sched->encoder, &data);
+
+	if (n > 0)
+		log_write(sched, data, n);
+}
+
+/*
+ * Write what a scheduler which has run still holds: the last block of
+ * its compressed trace and the buffers of its streams.
+ */
+YASS_EXPORT void yass_log_sched_flush(struct sched *sched)
+{
+	if (sched->encoder != NULL)
+		log_flush_block(sched);
+
+	yass_stream_flush(sched->stream);
+	yass_stream_flush(sched->verbose_stream);
+}
+
+/*
+ * Write the last block of each compressed trace.
+ */
+YASS_EXPORT void yass_log_encoders_free(struct yass *yass)
+{
+	int i;
+
+	struct sched *sched;
+
+	for (i = 0; i < yass_get_nschedulers(yass); i++) {
+		sched = yass_get_sched(yass, i);
+
+		if (sched->encoder == NULL)
+			continue;
+
+		log_flush_block(sched);
+
+		yass_trace_encoder_free(sched->encoder);
+		sched->encoder = NULL;
+	}
+}
+
 YASS_EXPORT void yass_log_sched(struct sched *sched,
 				int i1, int i2, int i3, int i4, int i5, int i6)
 {
 	char tmp[128] = "";
 
+	FILE *fp = sched->segment != NULL ? sched->segment : sched->fp;
+
+	struct yass_trace_record record;
+
 	if (yass_sched_get_verbose(sched)) {
 		switch (i1) {
 		case YASS_EVENT_TASK_RELEASE:
-			printf("%d RELEASE task %d\n", i3, i2);
+			sprintf(tmp, "%d RELEASE task %d\n", i3, i2);
 			break;
 		case YASS_EVENT_TASK_DEADLINE:
-			printf("%d DEADLINE task %d\n", i3, i2);
+			sprintf(tmp, "%d DEADLINE task %d\n", i3, i2);
 			break;
 
 		case YASS_EVENT_TASK_RUN:
-			printf("%d RUN sched %d task %d cpu %d\n",
-			       i4, i2, i3, i5);
+			sprintf(tmp, "%d RUN sched %d task %d cpu %d\n",
+				i4, i2, i3, i5);
 			break;
 		case YASS_EVENT_TASK_TERMINATE:
-			printf("%d TERMINATE sched %d task %d cpu %d\n",
-			       i4, i2, i3, i5);
+			sprintf(tmp, "%d TERMINATE sched %d task %d cpu %d\n",
+				i4, i2, i3, i5);
 			break;
 
 		case YASS_EVENT_CPU_SPEED:
-			printf("%d SPEED sched %d cpu %d speed %d\n",
-			       yass_sched_get_tick(sched), i2, i3, i4);
+			sprintf(tmp, "%d SPEED sched %d cpu %d speed %d\n",
+				yass_sched_get_tick(sched), i2, i3, i4);
 			break;
 		case YASS_EVENT_CPU_MODE:
-			printf("%d MODE sched %d cpu %d mode %d\n",
-			       yass_sched_get_tick(sched), i2, i3, i4);
+			sprintf(tmp, "%d MODE sched %d cpu %d mode %d\n",
+				yass_sched_get_tick(sched), i2, i3, i4);
 			break;
 		case YASS_EVENT_CPU_CONSUMPTION:
 			/* printf("%d CONS sched %d cpu %d consumption %d\n", */
 			/*        yass_sched_get_tick(sched), i2, i3, i4); */
 			break;
 		}
+
+		if (sched->verbose_stream != NULL)
+			yass_stream_write(sched->verbose_stream, tmp,
+					  strlen(tmp));
+		else
+			fputs(tmp, stdout);
 	}
 
-	if (yass_sched_get_fp(sched) == NULL)
+	if (fp == NULL || !(sched->trace & (i1 <= YASS_EVENT_TASK_TERMINATE ?
+					    YASS_TRACE_TASKS :
+					    YASS_TRACE_CPU)))
+		return;
+
+	if (yass_sched_get_trace_format(sched) != YASS_TRACE_TEXT) {
+		record.d[0] = i1;
+		record.d[1] = i2;
+		record.d[2] = i3;
+		record.d[3] = i4;
+		record.d[4] = i5;
+		record.d[5] = i6;
+
+		if (sched->encoder == NULL)
+			log_write(sched, &record, sizeof(record));
+		else if (yass_trace_encoder_add(sched->encoder, &record))
+			log_flush_block(sched);
+
 		return;
+	}
 
-	sprintf(tmp, "%d %d %d %d %d %d", i1, i2, i3, i4, i5, i6);
+	sprintf(tmp, "%d %d %d %d %d %d\n", i1, i2, i3, i4, i5, i6);
 
-	fprintf(yass_sched_get_fp(sched), "%s\n", tmp);
+	log_write(sched, tmp, strlen(tmp));
 }
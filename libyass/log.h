@@ -3,15 +3,39 @@
 
 #include "yass.h"
 
+struct yass_writer;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-FILE *yass_log_new(struct yass *yass, const char *output);
+/*
+ * Whether the events of the given class (enum yass_trace_events) are
+ * logged, to check before computing them. --verbose prints all of
+ * them, the class only filters the trace file.
+ */
+#define yass_log_enabled(sched, events)				\
+	(((sched)->trace & (events)) || (sched)->verbose)
+
+FILE *yass_log_new(struct yass *yass, const char *output, int format);
 
 void yass_log_sched(struct sched *sched,
 		    int i1, int i2, int i3, int i4, int i5, int i6);
 
+int yass_log_segments_new(struct yass *yass);
+
+int yass_log_segments_merge(struct yass *yass);
+
+int yass_log_streams_new(struct yass *yass, struct yass_writer *writer);
+
+void yass_log_streams_free(struct yass *yass);
+
+int yass_log_encoders_new(struct yass *yass);
+
+void yass_log_encoders_free(struct yass *yass);
+
+void yass_log_sched_flush(struct sched *sched);
+
 void yass_log_free(void);
 
 #ifdef __cplusplus
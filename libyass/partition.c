@@ -0,0 +1,319 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include "partition.h"
+
+#include "common.h"
+#include "private.h"
+#include "scheduler.h"
+#include "task.h"
+
+/*
+ * Tasks of a scheduler partitioned among cpus (or among servers for
+ * hierarchical schedulers). Each cpu has its own queue of ready tasks,
+ * a binary min-heap ordered by an integer key, e.g. the absolute
+ * deadline, and then by order of assignment. All queues share a single
+ * array: the queue of a cpu starts after the slots of the tasks
+ * assigned to the previous cpus, so tasks must all be assigned before
+ * the first one is queued.
+ */
+struct yass_partition {
+	struct sched *sched;
+
+	int n_cpus;
+	int size;
+
+	/* By task index */
+	int *cpu;
+	int *rank;		/* Order of assignment on its cpu */
+	int *keys;
+	int *pos;		/* Position in the queue of its cpu */
+
+	/* By cpu */
+	int *n_assigned;
+	int *n;
+	int *start;
+	unsigned long long *load;
+
+	int *queues;		/* Task indexes */
+
+	int built;
+};
+
+static int less(struct yass_partition *p, int i, int j)
+{
+	if (p->keys[i] != p->keys[j])
+		return p->keys[i] < p->keys[j];
+
+	return p->rank[i] < p->rank[j];
+}
+
+static void set(struct yass_partition *p, int *q, int i, int index)
+{
+	q[i] = index;
+	p->pos[index] = i;
+}
+
+static void sift_up(struct yass_partition *p, int *q, int i)
+{
+	int index = q[i];
+
+	while (i > 0 && less(p, index, q[(i - 1) / 2])) {
+		set(p, q, i, q[(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+
+	set(p, q, i, index);
+}
+
+static void sift_down(struct yass_partition *p, int *q, int n, int i)
+{
+	int c;
+
+	int index = q[i];
+
+	for (;;) {
+		c = 2 * i + 1;
+
+		if (c >= n)
+			break;
+
+		if (c + 1 < n && less(p, q[c + 1], q[c]))
+			c++;
+
+		if (!less(p, q[c], index))
+			break;
+
+		set(p, q, i, q[c]);
+		i = c;
+	}
+
+	set(p, q, i, index);
+}
+
+static void build(struct yass_partition *p)
+{
+	int i;
+
+	p->start[0] = 0;
+
+	for (i = 1; i < p->n_cpus; i++)
+		p->start[i] = p->start[i - 1] + p->n_assigned[i - 1];
+
+	p->built = 1;
+}
+
+static int get_index(struct yass_partition *p, int id)
+{
+	int index = yass_sched_get_task_from_id(p->sched, id);
+
+	if (index < 0 || index >= p->size)
+		return -1;
+
+	return index;
+}
+
+/*
+ * Partition of the tasks of sched among n_cpus cpus, with no task
+ * assigned yet.
+ */
+YASS_EXPORT struct yass_partition *yass_partition_new(struct sched *sched,
+						      int n_cpus)
+{
+	int i;
+
+	int size = yass_sched_get_ntasks(sched);
+
+	struct yass_partition *p =
+	    (struct yass_partition *)malloc(sizeof(struct yass_partition));
+
+	if (p == NULL)
+		return NULL;
+
+	p->sched = sched;
+	p->n_cpus = n_cpus;
+	p->size = size;
+	p->built = 0;
+
+	p->cpu = (int *)malloc(size * sizeof(int));
+	p->rank = (int *)malloc(size * sizeof(int));
+	p->keys = (int *)malloc(size * sizeof(int));
+	p->pos = (int *)malloc(size * sizeof(int));
+	p->queues = (int *)malloc(size * sizeof(int));
+
+	p->n_assigned = (int *)calloc(n_cpus, sizeof(int));
+	p->n = (int *)calloc(n_cpus, sizeof(int));
+	p->start = (int *)calloc(n_cpus, sizeof(int));
+	p->load = (unsigned long long *)calloc(n_cpus,
+					       sizeof(unsigned long long));
+
+	if (((p->cpu == NULL || p->rank == NULL || p->keys == NULL ||
+	      p->pos == NULL || p->queues == NULL) && size > 0) ||
+	    ((p->n_assigned == NULL || p->n == NULL || p->start == NULL ||
+	      p->load == NULL) && n_cpus > 0)) {
+		yass_partition_free(p);
+		return NULL;
+	}
+
+	for (i = 0; i < size; i++) {
+		p->cpu[i] = -1;
+		p->pos[i] = -1;
+	}
+
+	return p;
+}
+
+YASS_EXPORT void yass_partition_free(struct yass_partition *p)
+{
+	free(p->cpu);
+	free(p->rank);
+	free(p->keys);
+	free(p->pos);
+	free(p->queues);
+	free(p->n_assigned);
+	free(p->n);
+	free(p->start);
+	free(p->load);
+	free(p);
+}
+
+/*
+ * Assign a task to a cpu, once and for all.
+ */
+YASS_EXPORT void yass_partition_assign(struct yass_partition *p, int id,
+				       int cpu)
+{
+	int index = get_index(p, id);
+
+	yass_warn(!p->built);
+	yass_warn(index != -1 && cpu >= 0 && cpu < p->n_cpus);
+
+	if (p->built || index == -1 || cpu < 0 || cpu >= p->n_cpus)
+		return;
+
+	yass_warn(p->cpu[index] == -1);
+
+	if (p->cpu[index] != -1)
+		return;
+
+	p->cpu[index] = cpu;
+	p->rank[index] = p->n_assigned[cpu]++;
+
+	p->load[cpu] += yass_task_get_exec_hyperperiod(p->sched, id);
+}
+
+YASS_EXPORT int yass_partition_get_cpu(struct yass_partition *p, int id)
+{
+	int index = get_index(p, id);
+
+	return index != -1 ? p->cpu[index] : -1;
+}
+
+/*
+ * Execution time over the hyperperiod of the tasks assigned to cpu.
+ */
+YASS_EXPORT unsigned long long yass_partition_get_load(struct yass_partition *p,
+						       int cpu)
+{
+	return p->load[cpu];
+}
+
+/*
+ * Cpu with the lowest load (the first one on ties), for worst fit
+ * partitioning.
+ */
+YASS_EXPORT int yass_partition_worst_fit(struct yass_partition *p)
+{
+	int cpu = -1, i;
+
+	unsigned long long min = ULLONG_MAX;
+
+	for (i = 0; i < p->n_cpus; i++) {
+		if (p->load[i] < min) {
+			min = p->load[i];
+			cpu = i;
+		}
+	}
+
+	return cpu;
+}
+
+/*
+ * Queue a task on its cpu, in O(log k) for the k tasks assigned to it.
+ */
+YASS_EXPORT void yass_partition_add(struct yass_partition *p, int id, int key)
+{
+	int cpu, index = get_index(p, id);
+
+	yass_warn(index != -1 && p->cpu[index] != -1);
+	yass_warn(!yass_partition_present(p, id));
+
+	if (index == -1 || p->cpu[index] == -1 || p->pos[index] != -1)
+		return;
+
+	if (!p->built)
+		build(p);
+
+	cpu = p->cpu[index];
+
+	p->keys[index] = key;
+
+	p->queues[p->start[cpu] + p->n[cpu]] = index;
+	p->n[cpu]++;
+
+	sift_up(p, p->queues + p->start[cpu], p->n[cpu] - 1);
+}
+
+YASS_EXPORT void yass_partition_remove(struct yass_partition *p, int id)
+{
+	int cpu, i, last, *q, index = get_index(p, id);
+
+	yass_warn(yass_partition_present(p, id));
+
+	if (index == -1 || p->pos[index] == -1)
+		return;
+
+	cpu = p->cpu[index];
+	q = p->queues + p->start[cpu];
+	i = p->pos[index];
+
+	p->pos[index] = -1;
+	p->n[cpu]--;
+
+	if (i == p->n[cpu])
+		return;
+
+	last = q[p->n[cpu]];
+
+	set(p, q, i, last);
+	sift_down(p, q, p->n[cpu], i);
+
+	if (p->pos[last] == i)
+		sift_up(p, q, i);
+}
+
+YASS_EXPORT int yass_partition_present(struct yass_partition *p, int id)
+{
+	int index = get_index(p, id);
+
+	return index != -1 && p->pos[index] != -1;
+}
+
+/*
+ * Number of tasks queued on cpu.
+ */
+YASS_EXPORT int yass_partition_n(struct yass_partition *p, int cpu)
+{
+	return p->n[cpu];
+}
+
+/*
+ * Queued task of cpu with the smallest key, or -1.
+ */
+YASS_EXPORT int yass_partition_top(struct yass_partition *p, int cpu)
+{
+	if (p->n[cpu] == 0)
+		return -1;
+
+	return yass_task_get_id(p->sched, p->queues[p->start[cpu]]);
+}
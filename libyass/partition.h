@@ -0,0 +1,38 @@
+#ifndef _YASS_PARTITION_H
+#define _YASS_PARTITION_H
+
+#include "yass.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_partition;
+
+struct yass_partition *yass_partition_new(struct sched *sched, int n_cpus);
+
+void yass_partition_free(struct yass_partition *p);
+
+void yass_partition_assign(struct yass_partition *p, int id, int cpu);
+
+int yass_partition_get_cpu(struct yass_partition *p, int id);
+
+unsigned long long yass_partition_get_load(struct yass_partition *p, int cpu);
+
+int yass_partition_worst_fit(struct yass_partition *p);
+
+void yass_partition_add(struct yass_partition *p, int id, int key);
+
+void yass_partition_remove(struct yass_partition *p, int id);
+
+int yass_partition_present(struct yass_partition *p, int id);
+
+int yass_partition_n(struct yass_partition *p, int cpu);
+
+int yass_partition_top(struct yass_partition *p, int cpu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_PARTITION_H */
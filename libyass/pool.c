@@ -0,0 +1,349 @@
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "pool.h"
+
+#include "common.h"
+#include "private.h"
+
+#define POOL_DEQUE_SIZE 64
+
+struct work {
+	void (*fn) (void *);
+	void *arg;
+};
+
+/*
+ * Each worker owns a deque. The owner pushes and pops works at the
+ * bottom, idle workers steal works from the top.
+ */
+struct deque {
+	pthread_mutex_t lock;
+
+	int size;
+	int top;
+	int bottom;
+	struct work *works;
+};
+
+struct worker {
+	pthread_t id;
+	int index;
+
+	struct yass_pool *pool;
+	struct deque deque;
+};
+
+struct yass_pool {
+	int n_workers;
+	struct worker *workers;
+
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+
+	int queued;		/* Works not yet taken by a worker */
+	int pending;		/* Works not yet finished */
+	int next;		/* Deque used by the next external submit */
+	int stop;
+};
+
+static __thread struct worker *current;
+
+static int deque_init(struct deque *d)
+{
+	d->size = POOL_DEQUE_SIZE;
+	d->top = 0;
+	d->bottom = 0;
+
+	d->works = (struct work *)malloc(d->size * sizeof(struct work));
+
+	if (d->works == NULL)
+		return -YASS_ERROR_MALLOC;
+
+	pthread_mutex_init(&d->lock, NULL);
+
+	return 0;
+}
+
+static int deque_push(struct deque *d, struct work *w)
+{
+	int i;
+	struct work *works;
+
+	pthread_mutex_lock(&d->lock);
+
+	if (d->bottom - d->top == d->size) {
+		works = (struct work *)malloc(2 * d->size *
+					      sizeof(struct work));
+
+		if (works == NULL) {
+			pthread_mutex_unlock(&d->lock);
+			return -YASS_ERROR_MALLOC;
+		}
+
+		for (i = d->top; i < d->bottom; i++)
+			works[i - d->top] = d->works[i % d->size];
+
+		free(d->works);
+
+		d->works = works;
+		d->bottom -= d->top;
+		d->top = 0;
+		d->size *= 2;
+	}
+
+	d->works[d->bottom % d->size] = *w;
+	d->bottom++;
+
+	pthread_mutex_unlock(&d->lock);
+
+	return 0;
+}
+
+static int deque_take(struct deque *d, struct work *w, int steal)
+{
+	pthread_mutex_lock(&d->lock);
+
+	if (d->top == d->bottom) {
+		pthread_mutex_unlock(&d->lock);
+		return 0;
+	}
+
+	if (steal) {
+		*w = d->works[d->top % d->size];
+		d->top++;
+	} else {
+		d->bottom--;
+		*w = d->works[d->bottom % d->size];
+	}
+
+	if (d->top == d->bottom) {
+		d->top = 0;
+		d->bottom = 0;
+	}
+
+	pthread_mutex_unlock(&d->lock);
+
+	return 1;
+}
+
+/*
+ * Take a work, first from the deque of the worker, then from the
+ * other ones. The caller has reserved a work, so one is available.
+ */
+static void pool_get_work(struct worker *self, struct work *w)
+{
+	int i;
+
+	struct yass_pool *pool = self->pool;
+
+	while (1) {
+		if (deque_take(&self->deque, w, 0))
+			return;
+
+		for (i = 1; i < pool->n_workers; i++) {
+			if (deque_take(&pool->workers[(self->index + i) %
+						      pool->n_workers].deque,
+				       w, 1))
+				return;
+		}
+	}
+}
+
+static void *pool_worker(void *arg)
+{
+	struct work w;
+
+	struct worker *self = (struct worker *)arg;
+	struct yass_pool *pool = self->pool;
+
+	current = self;
+
+	while (1) {
+		pthread_mutex_lock(&pool->lock);
+
+		while (pool->queued == 0 && !pool->stop)
+			pthread_cond_wait(&pool->work, &pool->lock);
+
+		if (pool->queued == 0) {
+			pthread_mutex_unlock(&pool->lock);
+			break;
+		}
+
+		pool->queued--;
+
+		pthread_mutex_unlock(&pool->lock);
+
+		pool_get_work(self, &w);
+
+		w.fn(w.arg);
+
+		pthread_mutex_lock(&pool->lock);
+
+		pool->pending--;
+
+		if (pool->pending == 0)
+			pthread_cond_broadcast(&pool->done);
+
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	return NULL;
+}
+
+YASS_EXPORT struct yass_pool *yass_pool_new(int n_workers, int *error)
+{
+	int i;
+
+	struct yass_pool *pool;
+
+	*error = 0;
+
+	if (n_workers <= 0) {
+		*error = -YASS_ERROR_N_JOBS;
+		return NULL;
+	}
+
+	pool = (struct yass_pool *)malloc(sizeof(struct yass_pool));
+
+	if (pool == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	pool->workers = (struct worker *)calloc(n_workers,
+						sizeof(struct worker));
+
+	if (pool->workers == NULL) {
+		free(pool);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	pool->n_workers = 0;
+	pool->queued = 0;
+	pool->pending = 0;
+	pool->next = 0;
+	pool->stop = 0;
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work, NULL);
+	pthread_cond_init(&pool->done, NULL);
+
+	for (i = 0; i < n_workers; i++) {
+		pool->workers[i].index = i;
+		pool->workers[i].pool = pool;
+
+		*error = deque_init(&pool->workers[i].deque);
+
+		if (*error)
+			break;
+
+		if (pthread_create(&pool->workers[i].id, NULL, &pool_worker,
+				   &pool->workers[i])) {
+			pthread_mutex_destroy(&pool->workers[i].deque.lock);
+			free(pool->workers[i].deque.works);
+			*error = -YASS_ERROR_THREAD_CREATE;
+			break;
+		}
+
+		pool->n_workers++;
+	}
+
+	if (*error) {
+		yass_pool_free(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+/*
+ * Add a work to the pool. A work submitted from a worker goes to the
+ * deque of this worker, other works are spread over all deques.
+ */
+YASS_EXPORT int yass_pool_submit(struct yass_pool *pool, void (*fn) (void *),
+				 void *arg)
+{
+	int error;
+
+	struct work w;
+	struct worker *worker;
+
+	w.fn = fn;
+	w.arg = arg;
+
+	if (current != NULL && current->pool == pool) {
+		worker = current;
+	} else {
+		pthread_mutex_lock(&pool->lock);
+
+		worker = &pool->workers[pool->next];
+		pool->next = (pool->next + 1) % pool->n_workers;
+
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	error = deque_push(&worker->deque, &w);
+
+	if (error)
+		return error;
+
+	pthread_mutex_lock(&pool->lock);
+
+	pool->queued++;
+	pool->pending++;
+
+	pthread_cond_signal(&pool->work);
+
+	pthread_mutex_unlock(&pool->lock);
+
+	return 0;
+}
+
+/*
+ * Wait until all submitted works are finished. Must not be called
+ * from a work.
+ */
+YASS_EXPORT void yass_pool_wait(struct yass_pool *pool)
+{
+	pthread_mutex_lock(&pool->lock);
+
+	while (pool->pending > 0)
+		pthread_cond_wait(&pool->done, &pool->lock);
+
+	pthread_mutex_unlock(&pool->lock);
+}
+
+YASS_EXPORT int yass_pool_get_nworkers(struct yass_pool *pool)
+{
+	return pool->n_workers;
+}
+
+YASS_EXPORT void yass_pool_free(struct yass_pool *pool)
+{
+	int i;
+
+	pthread_mutex_lock(&pool->lock);
+
+	pool->stop = 1;
+
+	pthread_cond_broadcast(&pool->work);
+
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 0; i < pool->n_workers; i++) {
+		pthread_join(pool->workers[i].id, NULL);
+
+		pthread_mutex_destroy(&pool->workers[i].deque.lock);
+		free(pool->workers[i].deque.works);
+	}
+
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->work);
+	pthread_cond_destroy(&pool->done);
+
+	free(pool->workers);
+	free(pool);
+}
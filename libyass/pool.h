@@ -0,0 +1,24 @@
+#ifndef _YASS_POOL_H
+#define _YASS_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_pool;
+
+struct yass_pool *yass_pool_new(int n_workers, int *error);
+
+int yass_pool_submit(struct yass_pool *pool, void (*fn) (void *), void *arg);
+
+void yass_pool_wait(struct yass_pool *pool);
+
+int yass_pool_get_nworkers(struct yass_pool *pool);
+
+void yass_pool_free(struct yass_pool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_POOL_H */
@@ -0,0 +1,78 @@
+#include "rng.h"
+
+#include "private.h"
+
+/*
+ * splitmix64, used to seed the streams. See :
+ *  http://xoshiro.di.unimi.it/splitmix64.c
+ */
+static unsigned long long splitmix64(unsigned long long *x)
+{
+	unsigned long long z = (*x += 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+	return z ^ (z >> 31);
+}
+
+static unsigned long long rotl(unsigned long long x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/*
+ * Seed of the given stream of a seed. Streams of the same seed are
+ * independent, and do not depend on the order in which they are
+ * created.
+ */
+YASS_EXPORT unsigned long long yass_rng_derive(unsigned long long seed,
+					       unsigned long long stream)
+{
+	unsigned long long x = seed;
+
+	x = splitmix64(&x) ^ stream;
+
+	return splitmix64(&x);
+}
+
+YASS_EXPORT void yass_rng_init(struct yass_rng *rng, unsigned long long seed,
+			       unsigned long long stream)
+{
+	int i;
+
+	unsigned long long x = yass_rng_derive(seed, stream);
+
+	for (i = 0; i < 4; i++)
+		rng->s[i] = splitmix64(&x);
+}
+
+/*
+ * xoshiro256**. See :
+ *  http://xoshiro.di.unimi.it/xoshiro256starstar.c
+ */
+YASS_EXPORT unsigned long long yass_rng_next(struct yass_rng *rng)
+{
+	unsigned long long *s = rng->s;
+	unsigned long long r = rotl(s[1] * 5, 7) * 9;
+	unsigned long long t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+
+	s[3] = rotl(s[3], 45);
+
+	return r;
+}
+
+/*
+ * Uniform number in (0, 1], so that its logarithm is defined.
+ */
+YASS_EXPORT double yass_rng_uniform(struct yass_rng *rng)
+{
+	return ((yass_rng_next(rng) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
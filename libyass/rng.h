@@ -0,0 +1,30 @@
+#ifndef _YASS_RNG_H
+#define _YASS_RNG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * State of a random number stream. A stream has no shared state, so
+ * each thread can use its own streams without locking.
+ */
+struct yass_rng {
+	unsigned long long s[4];
+};
+
+void yass_rng_init(struct yass_rng *rng, unsigned long long seed,
+		   unsigned long long stream);
+
+unsigned long long yass_rng_next(struct yass_rng *rng);
+
+double yass_rng_uniform(struct yass_rng *rng);
+
+unsigned long long yass_rng_derive(unsigned long long seed,
+				   unsigned long long stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_RNG_H */
@@ -1,13 +1,18 @@
 #include <dlfcn.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "scheduler.h"
 
+#include "arena.h"
+#include "calendar.h"
 #include "cpu.h"
+#include "heap.h"
 #include "helpers.h"
 #include "private.h"
+#include "simd.h"
 
 YASS_EXPORT int yass_sched_get_index(struct sched *sched)
 {
@@ -24,6 +29,34 @@ YASS_EXPORT void yass_sched_set_fp(struct sched *sched, FILE * fp)
 	sched->fp = fp;
 }
 
+YASS_EXPORT int yass_sched_get_trace_format(struct sched *sched)
+{
+	return sched->trace_format;
+}
+
+/*
+ * Format of the events written to the file of the scheduler, one of
+ * enum yass_trace_format.
+ */
+YASS_EXPORT void yass_sched_set_trace_format(struct sched *sched, int format)
+{
+	sched->trace_format = format;
+}
+
+YASS_EXPORT int yass_sched_get_trace(struct sched *sched)
+{
+	return sched->trace;
+}
+
+/*
+ * Classes of events traced and printed with verbose, a combination of
+ * enum yass_trace_events. The others are not even computed.
+ */
+YASS_EXPORT void yass_sched_set_trace(struct sched *sched, int trace)
+{
+	sched->trace = trace;
+}
+
 YASS_EXPORT int yass_sched_get_verbose(struct sched *sched)
 {
 	return sched->verbose;
@@ -49,6 +82,22 @@ YASS_EXPORT void yass_sched_tick_inc(struct sched *sched)
 	sched->tick++;
 }
 
+/*
+ * Event-driven mode is only used if it has been requested and if the
+ * scheduler provides a next_event() function.
+ */
+YASS_EXPORT int yass_sched_get_event_driven(struct sched *sched)
+{
+	return sched->event_driven &&
+	    (sched->next_event != NULL || sched->next_event_r != NULL);
+}
+
+YASS_EXPORT void yass_sched_set_event_driven(struct sched *sched,
+					     int event_driven)
+{
+	sched->event_driven = event_driven;
+}
+
 YASS_EXPORT int yass_sched_get_stat(struct sched *sched)
 {
 	return sched->stat;
@@ -71,7 +120,7 @@ YASS_EXPORT double yass_sched_get_deadline_misses(struct sched *sched, int choic
 	int i, n_jobs = 0;
 	int id, period;
 
-	int hyperperiod = yass_sched_get_hyperperiod(sched);
+	unsigned long long hyperperiod = yass_sched_get_hyperperiod(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
 	if (choice == 0)
@@ -92,28 +141,40 @@ YASS_EXPORT double yass_sched_get_deadline_misses(struct sched *sched, int choic
 
 YASS_EXPORT int yass_sched_check_deadline_misses(struct sched *sched)
 {
-	int i, id, deadline, n, period, aet;
-	double exec;
+	int i, id, w;
 
 	int r = 0;
 
-	int n_tasks = yass_sched_get_ntasks(sched);
 	int tick = yass_sched_get_tick(sched);
 
-	for (i = 0; i < n_tasks; i++) {
-		id = yass_task_get_id(sched, i);
-		exec = yass_task_get_exec(sched, id);
-		deadline = yass_task_get_deadline(sched, id);
-		n = yass_task_get_n_exec(sched, id);
-		period = yass_task_get_period(sched, id);
+	unsigned long long bits, *due;
 
-		if (yass_sched_task_is_idle_task(sched, id))
-			continue;
+	struct yass_task_table *t = sched->table;
+
+	if (tick == 0)
+		return 0;
+
+	due = (unsigned long long *)
+	    yass_sched_alloc(sched, YASS_SIMD_MASK_WORDS(t->size) *
+			     sizeof(unsigned long long));
+
+	if (due == NULL)
+		return 0;
+
+	/* Tasks with a job whose deadline is the current tick */
+	yass_simd_mod_mask(tick, t->size, NULL, t->period, t->deadline_mod,
+			   due);
+
+	for (w = 0; w < YASS_SIMD_MASK_WORDS(t->size); w++) {
+		for (bits = due[w]; bits != 0; bits &= bits - 1) {
+			i = w * 64 + __builtin_ctzll(bits);
 
-		aet = yass_task_get_aet(sched, id);
+			id = t->id[i];
 
-		if (tick != 0 && n * period + deadline == tick) {
-			if (exec < aet - 0.001) {
+			if (yass_sched_task_is_idle_task(sched, id))
+				continue;
+
+			if (t->exec[i] < yass_task_get_aet(sched, id) - 0.001) {
 				/* yass_sched_inc_deadline_misses(sched); */
 				r = 1;
 			}
@@ -133,14 +194,255 @@ YASS_EXPORT int yass_sched_get_ncpus(struct sched *sched)
 	return sched->n_cpus;
 }
 
+static void sched_compute_hyperperiod(struct sched *sched)
+{
+	int i;
+	unsigned long long h = 1;
+
+	for (i = 0; i < yass_sched_get_ntasks(sched); i++)
+		h = yass_lcm(h, sched->tasks[i]->period);
+
+	sched->hyperperiod = h;
+}
+
+static unsigned int task_hash(int id)
+{
+	return (unsigned int)id * 2654435761U;
+}
+
+static int sched_hash_lookup(struct sched *sched, int id)
+{
+	int h, i;
+
+	for (h = task_hash(id) & sched->task_hash_mask;;
+	     h = (h + 1) & sched->task_hash_mask) {
+		i = sched->task_hash[h];
+
+		if (i == -1 || sched->tasks[i]->id == id)
+			return i;
+	}
+}
+
+YASS_EXPORT int yass_sched_get_task_from_id(struct sched *sched, int id)
+{
+	int i;
+
+	/* Idle tasks are not in the table: they are few and come last */
+	if (id >= YASS_IDLE_TASK_ID) {
+		for (i = sched->n_tasks - 1; i >= 0; i--) {
+			if (sched->tasks[i]->id == id)
+				return i;
+		}
+
+		return -1;
+	}
+
+	if (sched->task_hash != NULL)
+		return sched_hash_lookup(sched, id);
+
+	if (id < 0 || id >= sched->task_index_size)
+		return -1;
+
+	return sched->task_index[id];
+}
+
+/*
+ * Hash the indexes of the tasks by id, in a table at least twice as
+ * large as the number of tasks.
+ */
+static int sched_build_task_hash(struct sched *sched)
+{
+	int h, i, id, size = 16;
+
+	int n_tasks = yass_sched_get_ntasks(sched);
+
+	while (size < 2 * n_tasks)
+		size *= 2;
+
+	sched->task_hash = (int *)malloc(size * sizeof(int));
+
+	if (sched->task_hash == NULL)
+		return -YASS_ERROR_MALLOC;
+
+	sched->task_hash_mask = size - 1;
+
+	for (h = 0; h < size; h++)
+		sched->task_hash[h] = -1;
+
+	for (i = 0; i < n_tasks; i++) {
+		id = sched->tasks[i]->id;
+
+		if (id < 0 || id >= YASS_IDLE_TASK_ID)
+			continue;
+
+		if (sched_hash_lookup(sched, id) != -1)
+			return -YASS_ERROR_ID_NOT_UNIQUE;
+
+		for (h = task_hash(id) & sched->task_hash_mask;
+		     sched->task_hash[h] != -1;
+		     h = (h + 1) & sched->task_hash_mask)
+			continue;
+
+		sched->task_hash[h] = i;
+	}
+
+	return 0;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+	int x = *(const int *)a, y = *(const int *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Count the distinct vms of the tasks, once per task set: the tasks
+ * without a vm (-1) are not in any.
+ */
+static int sched_count_vms(struct sched *sched)
+{
+	int i, n = 0, vm;
+
+	int n_tasks = yass_sched_get_ntasks(sched);
+
+	int *vms = (int *)malloc(n_tasks * sizeof(int));
+
+	sched->n_vms = 0;
+
+	if (vms == NULL && n_tasks > 0)
+		return -YASS_ERROR_MALLOC;
+
+	for (i = 0; i < n_tasks; i++) {
+		vm = sched->tasks[i]->vm;
+
+		if (vm >= 0)
+			vms[n++] = vm;
+	}
+
+	qsort(vms, n, sizeof(int), compare_int);
+
+	for (i = 0; i < n; i++) {
+		if (i == 0 || vms[i] != vms[i - 1])
+			sched->n_vms++;
+	}
+
+	free(vms);
+
+	return 0;
+}
+
+/*
+ * Build the table giving the index of each task from its id, so that
+ * tasks can be found in constant time. Ids are usually small integers,
+ * the table is then indexed by the id itself. When they are too sparse
+ * for that, the indexes are hashed by id instead. Idle tasks are left
+ * out, their ids start at YASS_IDLE_TASK_ID.
+ */
+static int sched_build_task_index(struct sched *sched)
+{
+	int i, id, size;
+
+	int error, n_tasks = yass_sched_get_ntasks(sched);
+
+	error = sched_count_vms(sched);
+
+	if (error)
+		return error;
+
+	size = 0;
+
+	for (i = 0; i < n_tasks; i++) {
+		id = sched->tasks[i]->id;
+
+		if (id >= size && id < YASS_IDLE_TASK_ID)
+			size = id + 1;
+	}
+
+	free(sched->task_index);
+	free(sched->task_hash);
+
+	sched->task_hash = NULL;
+
+	if (size > 4 * n_tasks + 1024) {
+		sched->task_index = NULL;
+		sched->task_index_size = 0;
+
+		return sched_build_task_hash(sched);
+	}
+
+	sched->task_index = (int *)malloc(size * sizeof(int));
+	sched->task_index_size = 0;
+
+	if (sched->task_index == NULL && size > 0)
+		return -YASS_ERROR_MALLOC;
+
+	for (i = 0; i < size; i++)
+		sched->task_index[i] = -1;
+
+	sched->task_index_size = size;
+
+	for (i = 0; i < n_tasks; i++) {
+		id = sched->tasks[i]->id;
+
+		if (id < 0 || id >= YASS_IDLE_TASK_ID)
+			continue;
+
+		if (sched->task_index[id] != -1)
+			return -YASS_ERROR_ID_NOT_UNIQUE;
+
+		sched->task_index[id] = i;
+	}
+
+	return 0;
+}
+
+/*
+ * Drop the calendars and the heap of the next releases, to be built
+ * again from the tasks on the next query.
+ */
+static void sched_reset_calendars(struct sched *sched)
+{
+	yass_calendar_free(sched->boundaries);
+	yass_calendar_free(sched->events);
+
+	if (sched->releases != NULL)
+		yass_heap_free(sched->releases);
+
+	free(sched->intervals);
+
+	sched->boundaries = NULL;
+	sched->events = NULL;
+	sched->releases = NULL;
+
+	sched->n_intervals = 0;
+	sched->intervals = NULL;
+}
+
 YASS_EXPORT int yass_sched_get_ntasks(struct sched *sched)
 {
 	return sched->n_tasks;
 }
 
-YASS_EXPORT void yass_sched_set_ntasks(struct sched *sched, int n_tasks)
+YASS_EXPORT int yass_sched_set_ntasks(struct sched *sched, int n_tasks)
 {
+	int error;
+
 	sched->n_tasks = n_tasks;
+
+	sched_reset_calendars(sched);
+
+	if (sched->tasks == NULL)
+		return 0;
+
+	error = sched_build_task_index(sched);
+
+	if (error)
+		return error;
+
+	sched_compute_hyperperiod(sched);
+
+	return 0;
 }
 
 YASS_EXPORT struct yass_cpu *yass_sched_get_cpu(struct sched *sched, int cpu)
@@ -150,14 +452,12 @@ YASS_EXPORT struct yass_cpu *yass_sched_get_cpu(struct sched *sched, int cpu)
 
 YASS_EXPORT struct yass_task *yass_sched_get_task(struct sched *sched, int id)
 {
-	int i;
+	int index = yass_sched_get_task_from_id(sched, id);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		if (yass_task_get_id(sched, i) == id)
-			return sched->tasks[i];
-	}
+	if (index == -1)
+		return NULL;
 
-	return NULL;
+	return sched->tasks[index];
 }
 
 YASS_EXPORT struct yass_task **yass_sched_get_tasks(struct sched *sched)
@@ -174,14 +474,12 @@ YASS_EXPORT struct yass_task *yass_sched_get_task_index(struct sched *sched,
 YASS_EXPORT struct yass_task_sched *yass_sched_get_task_sched(struct sched
 							      *sched, int id)
 {
-	int i;
+	int index = yass_sched_get_task_from_id(sched, id);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		if (yass_task_get_id(sched, i) == id)
-			return sched->tasks_sched[i];
-	}
+	if (index == -1)
+		return NULL;
 
-	return NULL;
+	return sched->tasks_sched[index];
 }
 
 static int sched_open(struct sched *sched, const char *filename)
@@ -201,6 +499,59 @@ static void *assign(struct sched *sched, const char *s)
 	return dlsym(sched->handle, s);
 }
 
+/*
+ * Load the symbols of a scheduler. The version 2 of the interface is
+ * used if the plugin has an abi_version symbol returning 2.
+ */
+static int sched_load(struct sched *sched)
+{
+	int (*abi_version) (void);
+
+	abi_version = (int (*)(void))assign(sched, "abi_version");
+
+	if (abi_version != NULL)
+		sched->abi = abi_version();
+
+	if (sched->abi == YASS_SCHED_ABI_V1) {
+		sched->offline = (int (*)(struct sched *))
+		    assign(sched, "offline");
+		sched->schedule = (int (*)(struct sched *))
+		    assign(sched, "schedule");
+		sched->close = (int (*)(struct sched *))
+		    assign(sched, "sched_close");
+
+		if (!sched->offline || !sched->schedule || !sched->close)
+			return -YASS_ERROR_DLSYM;
+
+		/*
+		 * next_event() is optional, schedulers without it are
+		 * always called at every tick.
+		 */
+		sched->next_event = (int (*)(struct sched *))
+		    assign(sched, "next_event");
+	} else if (sched->abi == YASS_SCHED_ABI_V2) {
+		sched->offline_r = (void *(*)(struct sched *, int *))
+		    assign(sched, "offline");
+		sched->schedule_r = (int (*)(struct sched *, void *))
+		    assign(sched, "schedule");
+		sched->close_r = (int (*)(struct sched *, void *))
+		    assign(sched, "sched_close");
+
+		if (!sched->offline_r || !sched->schedule_r || !sched->close_r)
+			return -YASS_ERROR_DLSYM;
+
+		sched->next_event_r = (int (*)(struct sched *, void *))
+		    assign(sched, "next_event");
+	} else {
+		return -YASS_ERROR_SCHEDULER_ABI;
+	}
+
+	if ((sched->name = (const char *(*)())assign(sched, "name")) == NULL)
+		return -YASS_ERROR_DLSYM;
+
+	return 0;
+}
+
 YASS_EXPORT struct sched **yass_sched_new(int n_schedulers)
 {
 	return (struct sched **)calloc(n_schedulers, sizeof(struct sched));
@@ -213,19 +564,6 @@ YASS_EXPORT int yass_sched_init(struct sched **sched, int n_schedulers,
 	int i, j, error;
 	char filename[256];
 
-	/*
-	 * This test is not enough to guarantee that a scheduler is
-	 * not used twice because a scheduler can be called with two
-	 * differente strings, for example "edf" and
-	 * "schedulers/.libs/edf.so".
-	 */
-	for (i = 0; i < n_schedulers; i++) {
-		for (j = i + 1; j < n_schedulers; j++) {
-			if (!strcmp(schedulers[i], schedulers[j]))
-				return -YASS_ERROR_SCHEDULER_NOT_UNIQUE;
-		}
-	}
-
 	for (i = 0; i < n_schedulers; i++) {
 		sched[i] = (struct sched *)malloc(sizeof(struct sched));
 
@@ -235,22 +573,56 @@ YASS_EXPORT int yass_sched_init(struct sched **sched, int n_schedulers,
 		sched[i]->id = i + 1;
 		sched[i]->index = i;
 		sched[i]->fp = NULL;
+		sched[i]->trace_format = YASS_TRACE_TEXT;
+		sched[i]->trace = YASS_TRACE_ALL;
+		sched[i]->segment = NULL;
+		sched[i]->stream = NULL;
+		sched[i]->verbose_stream = NULL;
+		sched[i]->encoder = NULL;
 		sched[i]->verbose = verbose;
 		sched[i]->debug = debug;
 		sched[i]->tick = 0;
 		sched[i]->stat = -1;
 		sched[i]->deadline_misses = 0;
+		sched[i]->hyperperiod = 1;
 		sched[i]->n_cpus = n_cpus;
 		sched[i]->n_tasks = n_tasks;
 		sched[i]->online = online;
 
+		sched[i]->abi = YASS_SCHED_ABI_V1;
+		sched[i]->data = NULL;
+
 		sched[i]->offline = NULL;
 		sched[i]->schedule = NULL;
 		sched[i]->close = NULL;
+		sched[i]->next_event = NULL;
+
+		sched[i]->offline_r = NULL;
+		sched[i]->schedule_r = NULL;
+		sched[i]->close_r = NULL;
+		sched[i]->next_event_r = NULL;
+
+		sched[i]->event_driven = 0;
 
 		sched[i]->tasks = NULL;
 		sched[i]->tasks_sched = NULL;
 		sched[i]->exec_time = NULL;
+		sched[i]->table = NULL;
+
+		sched[i]->task_index_size = 0;
+		sched[i]->task_index = NULL;
+		sched[i]->task_hash_mask = 0;
+		sched[i]->task_hash = NULL;
+		sched[i]->n_vms = 0;
+
+		sched[i]->arena = NULL;
+
+		sched[i]->boundaries = NULL;
+		sched[i]->events = NULL;
+		sched[i]->releases = NULL;
+
+		sched[i]->n_intervals = 0;
+		sched[i]->intervals = NULL;
 
 		sched[i]->last_tasks = (int **)calloc(2 * n_cpus, sizeof(int));
 
@@ -275,23 +647,10 @@ YASS_EXPORT int yass_sched_init(struct sched **sched, int n_schedulers,
 			if (error)
 				return error;
 
-			if ((sched[i]->offline = (int (*)(struct sched *))
-			     assign(sched[i], "offline")) == NULL) {
-				return -YASS_ERROR_DLSYM;
-			}
-			if ((sched[i]->schedule = (int (*)(struct sched *))
-			     assign(sched[i], "schedule")) == NULL) {
-				return -YASS_ERROR_DLSYM;
-			}
-			if ((sched[i]->close = (int (*)(struct sched *))
-			     assign(sched[i], "sched_close")) == NULL) {
-				return -YASS_ERROR_DLSYM;
-			}
+			error = sched_load(sched[i]);
 
-			if ((sched[i]->name = (const char *(*)())
-			     assign(sched[i], "name")) == NULL) {
-				return -YASS_ERROR_DLSYM;
-			}
+			if (error)
+				return error;
 
 			if (sched[i]->name && strlen(sched[i]->name()) < 2)
 				return -YASS_ERROR_SCHEDULER_NAME_TOO_SHORT;
@@ -303,17 +662,120 @@ YASS_EXPORT int yass_sched_init(struct sched **sched, int n_schedulers,
 			return error;
 	}
 
+	/*
+	 * dlopen() returns the same handle when a plugin is opened
+	 * twice, so schedulers of the version 1 of the interface,
+	 * which keep their state in global variables, cannot be used
+	 * more than once.
+	 */
+	for (i = 0; i < n_schedulers; i++) {
+		for (j = i + 1; j < n_schedulers; j++) {
+			if (sched[i]->handle != NULL &&
+			    sched[i]->handle == sched[j]->handle &&
+			    !yass_sched_is_reentrant(sched[i]))
+				return -YASS_ERROR_SCHEDULER_NOT_UNIQUE;
+		}
+	}
+
 	return 0;
 }
 
+/*
+ * Create a scheduler using the same plugin and the same kind of
+ * processors as sched, without any task. The plugin stays owned by
+ * sched, which must be freed after all its copies.
+ */
+YASS_EXPORT struct sched *yass_sched_copy(struct sched *sched, int *error)
+{
+	int i;
+
+	struct sched *s;
+
+	*error = 0;
+
+	s = (struct sched *)malloc(sizeof(struct sched));
+
+	if (s == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	memcpy(s, sched, sizeof(struct sched));
+
+	s->fp = NULL;
+	s->segment = NULL;
+	s->stream = NULL;
+	s->verbose_stream = NULL;
+	s->encoder = NULL;
+	s->handle = NULL;
+	s->data = NULL;
+	s->tick = 0;
+	s->stat = -1;
+	s->deadline_misses = 0;
+	s->hyperperiod = 1;
+	s->n_tasks = 0;
+
+	s->tasks = NULL;
+	s->tasks_sched = NULL;
+	s->exec_time = NULL;
+	s->table = NULL;
+
+	s->task_index_size = 0;
+	s->task_index = NULL;
+	s->task_hash_mask = 0;
+	s->task_hash = NULL;
+	s->n_vms = 0;
+
+	s->arena = NULL;
+
+	s->boundaries = NULL;
+	s->events = NULL;
+	s->releases = NULL;
+
+	s->n_intervals = 0;
+	s->intervals = NULL;
+
+	s->cpus = NULL;
+
+	s->last_tasks = (int **)calloc(s->n_cpus, sizeof(int *));
+
+	if (s->last_tasks == NULL) {
+		free(s);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	for (i = 0; i < s->n_cpus; i++) {
+		s->last_tasks[i] = (int *)calloc(2, sizeof(int));
+
+		if (s->last_tasks[i] == NULL) {
+			yass_sched_free(s);
+			*error = -YASS_ERROR_MALLOC;
+			return NULL;
+		}
+
+		s->last_tasks[i][0] = -1;
+		s->last_tasks[i][1] = -1;
+	}
+
+	s->cpus = yass_cpu_copy(sched, error);
+
+	if (s->cpus == NULL) {
+		yass_sched_free(s);
+		return NULL;
+	}
+
+	return s;
+}
+
 YASS_EXPORT int yass_sched_init_tasks(struct sched *sched,
 				      struct yass_task **tasks,
-				      int **exec_time, int n_tasks)
+				      struct yass_exec_time *exec_time,
+				      int n_tasks)
 {
-	int i, j;
+	int error, i;
 
 	struct yass_task **t;
-	int **e;
 
 	t = yass_tasks_new(n_tasks);
 
@@ -323,25 +785,25 @@ YASS_EXPORT int yass_sched_init_tasks(struct sched *sched,
 	for (i = 0; i < n_tasks; i++)
 		memcpy(t[i], tasks[i], sizeof(struct yass_task));
 
-	e = yass_tasks_exec_new(n_tasks);
+	sched->n_tasks = n_tasks;
+	sched->tasks = t;
+	sched->exec_time = exec_time;
 
-	if (!e)
-		return -YASS_ERROR_MALLOC;
+	error = sched_build_task_index(sched);
 
-	for (i = 0; i < n_tasks; i++) {
-		for (j = 0; j < YASS_MAX_N_TASK_EXECUTION; j++)
-			e[i][j] = exec_time[i][j];
-	}
+	if (error)
+		return error;
 
-	sched->tasks = t;
-	sched->exec_time = e;
+	sched_compute_hyperperiod(sched);
 
 	sched->tasks_sched = yass_tasks_sched_new(sched, n_tasks);
 
 	if (!sched->tasks_sched)
 		return -YASS_ERROR_MALLOC;
 
-	return 0;
+	sched_reset_calendars(sched);
+
+	return yass_task_table_build(sched);
 }
 
 YASS_EXPORT void yass_sched_free(struct sched *sched)
@@ -368,13 +830,6 @@ YASS_EXPORT void yass_sched_free(struct sched *sched)
 		free(sched->tasks);
 	}
 
-	if (sched->exec_time != NULL) {
-		for (i = 0; i < sched->n_tasks; i++)
-			free(sched->exec_time[i]);
-
-		free(sched->exec_time);
-	}
-
 	if (sched->tasks_sched) {
 		for (i = 0; i < sched->n_tasks; i++)
 			free(sched->tasks_sched[i]);
@@ -382,6 +837,15 @@ YASS_EXPORT void yass_sched_free(struct sched *sched)
 		free(sched->tasks_sched);
 	}
 
+	yass_task_table_free(sched->table);
+
+	free(sched->task_index);
+	free(sched->task_hash);
+
+	yass_arena_free(sched->arena);
+
+	sched_reset_calendars(sched);
+
 	if (sched->handle)
 		dlclose(sched->handle);
 
@@ -390,17 +854,68 @@ YASS_EXPORT void yass_sched_free(struct sched *sched)
 
 YASS_EXPORT int yass_sched_offline(struct sched *sched)
 {
-	return sched->offline(sched);
+	int error;
+
+	if (!yass_sched_is_reentrant(sched))
+		return sched->offline(sched);
+
+	sched->data = sched->offline_r(sched, &error);
+
+	return error;
 }
 
 YASS_EXPORT int yass_sched_schedule(struct sched *sched)
 {
-	return sched->schedule(sched);
+	if (!yass_sched_is_reentrant(sched))
+		return sched->schedule(sched);
+
+	return sched->schedule_r(sched, sched->data);
 }
 
 YASS_EXPORT int yass_sched_close(struct sched *sched)
 {
-	return sched->close(sched);
+	int error;
+
+	if (!yass_sched_is_reentrant(sched))
+		return sched->close(sched);
+
+	error = sched->close_r(sched, sched->data);
+
+	sched->data = NULL;
+
+	return error;
+}
+
+/*
+ * Scratch memory for the current tick, e.g. for the temporary lists
+ * of schedule(): it is released by yass_sched_alloc_reset() once the
+ * tick is over, and must not be freed. Once the scheduler reaches its
+ * steady state, no heap allocation is made. Returns NULL on failure.
+ */
+YASS_EXPORT void *yass_sched_alloc(struct sched *sched, size_t size)
+{
+	if (sched->arena == NULL)
+		sched->arena = yass_arena_new();
+
+	if (sched->arena == NULL)
+		return NULL;
+
+	return yass_arena_alloc(sched->arena, size);
+}
+
+YASS_EXPORT void yass_sched_alloc_reset(struct sched *sched)
+{
+	if (sched->arena != NULL)
+		yass_arena_reset(sched->arena);
+}
+
+/*
+ * Whether several instances of the scheduler can run at the same
+ * time, i.e. whether it uses the version 2 of the interface.
+ */
+YASS_EXPORT int yass_sched_is_reentrant(struct sched *sched)
+{
+	return sched->abi >= YASS_SCHED_ABI_V2;
 }
 
 YASS_EXPORT double yass_sched_get_exec_time(struct sched *sched, int id,
@@ -408,39 +923,65 @@ YASS_EXPORT double yass_sched_get_exec_time(struct sched *sched, int id,
 {
 	int index = yass_task_get_from_id(sched, id);
 
-	return sched->exec_time[index][n_exec];
-}
+	/*
+	 * Tasks added by the scheduler, such as idle tasks, are not in
+	 * the execution time source.
+	 */
+	if (sched->exec_time == NULL ||
+	    index >= yass_exec_time_get_ntasks(sched->exec_time))
+		return yass_task_get_wcet(sched, id);
 
-YASS_EXPORT int **yass_sched_get_exec_times(struct sched *sched)
-{
-	return sched->exec_time;
+	return yass_exec_time_get(sched->exec_time, index, n_exec);
 }
 
 /*
- * TODO: There must be another way to do that, a way which does not
- * require a check for all tasks in every tick.
+ * Calendar of the events of the tasks of sched: the boundaries of
+ * their periods, and if all is set their delayed and non delayed
+ * releases and deadlines.
  */
-YASS_EXPORT int yass_sched_get_next_boundary(struct sched *sched, int tick)
+static struct yass_calendar *sched_calendar(struct sched *sched, int all)
 {
-	int i, id, period, t;
+	int error = 0, i;
 
-	int n_tasks = yass_sched_get_ntasks(sched);
+	struct yass_task_table *t = sched->table;
+	struct yass_calendar *c = yass_calendar_new();
 
-	t = tick;
+	if (c == NULL)
+		return NULL;
 
-	while (1) {
-		t++;
+	for (i = 0; i < t->size && !error; i++) {
+		error = yass_calendar_add(c, 0, t->period[i]);
 
-		for (i = 0; i < n_tasks; i++) {
-			id = yass_task_get_id(sched, i);
-			period = yass_task_get_period(sched, id);
+		if (!all || error)
+			continue;
 
-			if (t % period == 0)
-				return t;
-		}
+		error = yass_calendar_add(c, t->delay[i], t->period[i]);
+		error |= yass_calendar_add(c, t->deadline[i], t->period[i]);
+		error |= yass_calendar_add(c, t->delay[i] + t->deadline[i],
+					   t->period[i]);
+	}
+
+	if (error) {
+		yass_calendar_free(c);
+		return NULL;
 	}
 
-	return -1;
+	return c;
+}
+
+/*
+ * Return the first tick after tick which is a multiple of the period
+ * of a task, or -1.
+ */
+YASS_EXPORT int yass_sched_get_next_boundary(struct sched *sched, int tick)
+{
+	if (sched->boundaries == NULL)
+		sched->boundaries = sched_calendar(sched, 0);
+
+	if (sched->boundaries == NULL || yass_sched_get_ntasks(sched) == 0)
+		return -1;
+
+	return yass_calendar_next(sched->boundaries, tick + 1);
 }
 
 YASS_EXPORT int yass_sched_all_cpus_active(struct sched *sched)
@@ -476,44 +1017,175 @@ YASS_EXPORT double yass_sched_get_global_utilization(struct sched *sched)
 	return u;
 }
 
+/*
+ * Heap of the tasks of sched ordered by their next release, kept up to
+ * date by yass_task_set_release().
+ */
+static struct yass_heap *sched_releases(struct sched *sched)
+{
+	int i;
+
+	struct yass_task_table *t = sched->table;
+	struct yass_heap *h = yass_heap_new(sched);
+
+	if (h == NULL)
+		return NULL;
+
+	for (i = 0; i < t->size; i++)
+		yass_heap_add(h, t->id[i], t->next_release[i]);
+
+	return h;
+}
+
 YASS_EXPORT int yass_sched_get_next_release(struct sched *sched)
 {
-	int i, id, next;
+	int id, key, next;
 
 	int tick = yass_sched_get_tick(sched);
 	int next_release = YASS_MAX_PERIOD;
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		id = yass_task_get_id(sched, i);
-		next = yass_task_get_next_release(sched, id);
+	if (sched->releases == NULL)
+		sched->releases = sched_releases(sched);
+
+	if (sched->releases == NULL || yass_heap_n(sched->releases) == 0)
+		return next_release;
+
+	next = yass_heap_get_key(sched->releases,
+				 yass_heap_top(sched->releases));
+
+	/*
+	 * A release at the current tick counts as one at twice the
+	 * current tick: look for the first release after it.
+	 */
+	if (next == tick) {
+		next = tick + tick;
+
+		yass_heap_iter_init(sched->releases);
+
+		while ((id = yass_heap_iter_next(sched->releases)) != -1) {
+			key = yass_heap_get_key(sched->releases, id);
 
-		if (next == tick) {
-			if (next_release > next + tick)
-				next_release = next + tick;
-		} else if (next_release > next) {
-			next_release = next;
+			if (key != tick) {
+				if (key < next)
+					next = key;
+				break;
+			}
 		}
 	}
 
+	if (next_release > next)
+		next_release = next;
+
 	return next_release;
 }
 
-YASS_EXPORT unsigned long long yass_sched_get_hyperperiod(struct sched *sched)
+/*
+ * Return the first tick, starting from the current one, at which a
+ * task is released, reaches its deadline or completes. Both the
+ * delayed and the non delayed releases and deadlines are considered,
+ * as well as the worst-case and the actual execution times, so the
+ * result is never later than the real next event.
+ */
+YASS_EXPORT int yass_sched_get_next_event(struct sched *sched)
 {
-	int i, id;
-	unsigned long long h;
+	int i, id, k, next, speed;
+	double remaining;
 
-	int n_tasks = yass_sched_get_ntasks(sched);
+	int tick = yass_sched_get_tick(sched);
+	int event = YASS_MAX_PERIOD;
 
-	h = 1;
+	if (sched->events == NULL)
+		sched->events = sched_calendar(sched, 1);
 
-	for (i = 0; i < n_tasks; i++) {
-		id = yass_task_get_id(sched, i);
+	/* Call the scheduler at each tick if the calendar is missing */
+	if (sched->events == NULL)
+		return tick;
+
+	next = yass_calendar_next(sched->events, tick);
+	if (next < event)
+		event = next;
+
+	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
+		if (!yass_cpu_is_active(sched, i))
+			continue;
+
+		id = yass_cpu_get_task(sched, i);
+		speed = yass_cpu_get_speed(sched, i);
+
+		if (speed <= 0)
+			continue;
+
+		remaining = yass_task_get_wcet(sched, id);
+
+		if (yass_task_get_aet(sched, id) < remaining)
+			remaining = yass_task_get_aet(sched, id);
+
+		remaining -= yass_task_get_exec(sched, id);
+
+		/*
+		 * The execution time is increased at the beginning of
+		 * each tick, the task is seen as completed at the tick
+		 * of its last increment.
+		 */
+		k = (int)ceil(remaining / speed);
 
-		h = yass_lcm(h, yass_task_get_period(sched, id));
+		next = k > 1 ? tick + k - 1 : tick;
+		if (next < event)
+			event = next;
 	}
 
-	return h;
+	return event;
+}
+
+/*
+ * Return the next tick at which the scheduler has to be called. The
+ * current tick is returned if the scheduler is not event-driven.
+ */
+YASS_EXPORT int yass_sched_next_event(struct sched *sched)
+{
+	if (!yass_sched_get_event_driven(sched))
+		return yass_sched_get_tick(sched);
+
+	if (yass_sched_is_reentrant(sched))
+		return sched->next_event_r(sched, sched->data);
+
+	return sched->next_event(sched);
+}
+
+/*
+ * Advance the simulation by n_ticks ticks without calling the
+ * scheduler. The state of the processors does not change, running
+ * tasks are credited as yass_exec_inc() would do.
+ */
+YASS_EXPORT void yass_sched_skip(struct sched *sched, int n_ticks)
+{
+	int i, id, speed;
+
+	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
+		id = yass_cpu_get_task(sched, i);
+
+		if (id != -1) {
+			speed = yass_cpu_get_speed(sched, i);
+
+			yass_task_exec_inc(sched, id, speed * n_ticks);
+		}
+
+		yass_cpu_cons_add_ticks(sched, i, n_ticks);
+
+		if (id == -1 || yass_sched_task_is_idle_task(sched, id))
+			yass_cpu_add_idle_time(sched, i, n_ticks);
+	}
+
+	sched->tick += n_ticks;
+}
+
+/*
+ * The hyperperiod is computed each time the task set changes, it is
+ * YASS_HYPERPERIOD_OVERFLOW if it does not fit in 64 bits.
+ */
+YASS_EXPORT unsigned long long yass_sched_get_hyperperiod(struct sched *sched)
+{
+	return sched->hyperperiod;
 }
 
 YASS_EXPORT unsigned long long yass_sched_get_hyperperiod_vm(struct sched *sched, int vm)
@@ -558,7 +1230,7 @@ YASS_EXPORT int yass_sched_get_total_exec(struct sched *sched)
 
 YASS_EXPORT int yass_sched_add_idle_task(struct sched *sched)
 {
-	int id, n_tasks;
+	int error, id, n_tasks;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 
@@ -610,7 +1282,16 @@ YASS_EXPORT int yass_sched_add_idle_task(struct sched *sched)
 
 	sched->tasks_sched[n_tasks - 1] = task_sched;
 
-	return 0;
+	sched_compute_hyperperiod(sched);
+
+	sched_reset_calendars(sched);
+
+	error = yass_task_table_build(sched);
+
+	if (error)
+		return error;
+
+	return sched_build_task_index(sched);
 }
 
 YASS_EXPORT void yass_sched_update_idle(struct sched *sched)
@@ -701,27 +1382,5 @@ YASS_EXPORT void yass_sched_end_idle_periods(struct sched *sched)
 
 YASS_EXPORT int yass_sched_get_nvms(struct sched *sched)
 {
-	int i, id, j, n = 0;
-
-	int vms[YASS_MAX_N_VMS];
-
-	for (i = 0; i < YASS_MAX_N_VMS; i++)
-		vms[i] = -1;
-
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		id = yass_task_get_id(sched, i);
-
-		for (j = 0; j < YASS_MAX_N_VMS; j++) {
-			if (vms[j] == yass_task_get_vm(sched, id))
-				break;
-
-			if (vms[j] == -1) {
-				vms[j] = yass_task_get_vm(sched, id);
-				n++;
-				break;
-			}
-		}
-	}
-
-	return n;
+	return sched->n_vms;
 }
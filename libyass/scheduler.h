@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "common.h"
+#include "exec_time.h"
 
 #include "task.h"
 
@@ -11,11 +12,46 @@
 extern "C" {
 #endif
 
+/*
+ * Versions of the scheduler interface. In the version 1, offline(),
+ * schedule(), sched_close() and next_event() only get the scheduler
+ * and plugins keep their state in global variables. In the version
+ * 2, offline() returns the state of the instance, which is given to
+ * the other functions. A plugin using the version 2 must export an
+ * abi_version() function returning YASS_SCHED_ABI_V2.
+ */
+#define YASS_SCHED_ABI_V1 1
+#define YASS_SCHED_ABI_V2 2
+
+struct yass_arena;
+
+struct yass_calendar;
+
+struct yass_heap;
+
+struct yass_stream;
+
+struct yass_trace_encoder;
+
+struct yass_task_table;
+
 struct sched {
 	int id;
 	int index;
 
 	FILE *fp;
+	int trace_format;
+	int trace;
+
+	/* Private part of the trace while schedulers run in parallel */
+	FILE *segment;
+
+	/* Trace and verbose output given to the writer thread */
+	struct yass_stream *stream;
+	struct yass_stream *verbose_stream;
+
+	/* Block being filled with the compressed trace format */
+	struct yass_trace_encoder *encoder;
 
 	void *handle;
 
@@ -24,25 +60,68 @@ struct sched {
 
 	int online;
 
+	int event_driven;
+
 	int tick;
 
 	int stat;
 
 	int deadline_misses;
 
+	unsigned long long hyperperiod;
+
 	int n_cpus;
 	struct yass_cpu **cpus;
 
 	int n_tasks;
 	struct yass_task **tasks;
 	struct yass_task_sched **tasks_sched;
-	int **exec_time;
+	struct yass_exec_time *exec_time;
+
+	/* Fields of the tasks stored by task index */
+	struct yass_task_table *table;
+
+	/* Index in tasks of each task id, -1 if the id is not used */
+	int task_index_size;
+	int *task_index;
+
+	/* Indexes of the tasks hashed by id, when the ids are sparse */
+	int task_hash_mask;
+	int *task_hash;
+
+	/* Number of distinct vms of the tasks, tasks without one left out */
+	int n_vms;
 
 	int **last_tasks;
 
+	/* Scratch memory, released after each tick */
+	struct yass_arena *arena;
+
+	/*
+	 * Calendars of the period boundaries and of the releases and
+	 * deadlines of the tasks, and heap of the next releases, built
+	 * on first use and dropped when the tasks change.
+	 */
+	struct yass_calendar *boundaries;
+	struct yass_calendar *events;
+	struct yass_heap *releases;
+
+	/* Period boundaries in the hyperperiod, see helpers.c */
+	int n_intervals;
+	int *intervals;
+
+	int abi;
+	void *data;
+
 	int (*offline) (struct sched * sched);
 	int (*schedule) (struct sched * sched);
 	int (*close) (struct sched * sched);
+	int (*next_event) (struct sched * sched);
+
+	void *(*offline_r) (struct sched * sched, int *error);
+	int (*schedule_r) (struct sched * sched, void *data);
+	int (*close_r) (struct sched * sched, void *data);
+	int (*next_event_r) (struct sched * sched, void *data);
 
 	const char *(*name) (void);
 };
@@ -55,10 +134,12 @@ int yass_sched_init(struct sched **sched, int n_schedulers,
 		    char **schedulers, int n_cpus, const char *cpu,
 		    int n_tasks, int verbose, int online, int debug);
 
+struct sched *yass_sched_copy(struct sched *sched, int *error);
+
 void yass_sched_free(struct sched *sched);
 
 int yass_sched_init_tasks(struct sched *sched, struct yass_task **tasks,
-			  int **exec_time, int n_tasks);
+			  struct yass_exec_time *exec_time, int n_tasks);
 
 int yass_sched_get_index(struct sched *sched);
 
@@ -66,6 +147,14 @@ FILE *yass_sched_get_fp(struct sched *sched);
 
 void yass_sched_set_fp(struct sched *sched, FILE * fp);
 
+int yass_sched_get_trace_format(struct sched *sched);
+
+void yass_sched_set_trace_format(struct sched *sched, int format);
+
+int yass_sched_get_trace(struct sched *sched);
+
+void yass_sched_set_trace(struct sched *sched, int trace);
+
 int yass_sched_get_verbose(struct sched *sched);
 
 int yass_sched_get_debug(struct sched *sched);
@@ -76,6 +165,16 @@ int yass_sched_get_tick(struct sched *sched);
 
 void yass_sched_tick_inc(struct sched *sched);
 
+int yass_sched_get_event_driven(struct sched *sched);
+
+void yass_sched_set_event_driven(struct sched *sched, int event_driven);
+
+int yass_sched_get_next_event(struct sched *sched);
+
+int yass_sched_next_event(struct sched *sched);
+
+void yass_sched_skip(struct sched *sched, int n_ticks);
+
 int yass_sched_get_stat(struct sched *sched);
 
 void yass_sched_set_stat(struct sched *sched, int stat);
@@ -90,10 +189,12 @@ int yass_sched_get_ncpus(struct sched *sched);
 
 int yass_sched_get_ntasks(struct sched *sched);
 
-void yass_sched_set_ntasks(struct sched *sched, int n_tasks);
+int yass_sched_set_ntasks(struct sched *sched, int n_tasks);
 
 struct yass_cpu *yass_sched_get_cpu(struct sched *sched, int cpu);
 
+int yass_sched_get_task_from_id(struct sched *sched, int id);
+
 struct yass_task *yass_sched_get_task(struct sched *sched, int id);
 
 struct yass_task **yass_sched_get_tasks(struct sched *sched);
@@ -108,9 +209,14 @@ int yass_sched_schedule(struct sched *sched);
 
 int yass_sched_close(struct sched *sched);
 
+int yass_sched_is_reentrant(struct sched *sched);
+
+void *yass_sched_alloc(struct sched *sched, size_t size);
+
+void yass_sched_alloc_reset(struct sched *sched);
+
 double yass_sched_get_exec_time(struct sched *sched, int id, int n_exec);
 
-int **yass_sched_get_exec_times(struct sched *sched);
 
 int yass_sched_get_next_boundary(struct sched *sched, int tick);
 
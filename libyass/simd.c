@@ -0,0 +1,163 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simd.h"
+
+#include "private.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * The kernels set, for each task i, the bit i of mask when
+ *
+ *	tick - offset[i] >= 0 && (tick - offset[i]) % period[i] == target[i]
+ *
+ * offset and target can be NULL, for zero. The vectorized versions
+ * divide in double precision: for operands below 2^31 the remainder is
+ * exact, so that they give the same masks as the scalar one.
+ */
+typedef void (*mod_mask_fn) (int tick, int n, const int *offset,
+			     const int *period, const int *target,
+			     unsigned long long *mask);
+
+/*
+ * Scalar loop over the tasks [from, n), also used for the tasks left
+ * after the last full vector.
+ */
+static void mod_mask_tail(int tick, int from, int n, const int *offset,
+			  const int *period, const int *target,
+			  unsigned long long *mask)
+{
+	int i, t;
+
+	for (i = from; i < n; i++) {
+		t = tick - (offset != NULL ? offset[i] : 0);
+
+		if (t >= 0 && t % period[i] == (target != NULL ? target[i] : 0))
+			mask[i / 64] |= 1ULL << (i % 64);
+	}
+}
+
+static void mod_mask_scalar(int tick, int n, const int *offset,
+			    const int *period, const int *target,
+			    unsigned long long *mask)
+{
+	memset(mask, 0, YASS_SIMD_MASK_WORDS(n) * sizeof(*mask));
+
+	mod_mask_tail(tick, 0, n, offset, period, target, mask);
+}
+
+#ifdef SIMD_X86
+
+__attribute__ ((target("avx2")))
+static void mod_mask_avx2(int tick, int n, const int *offset,
+			  const int *period, const int *target,
+			  unsigned long long *mask)
+{
+	int i;
+
+	unsigned long long bits;
+
+	__m128i zero = _mm_setzero_si128();
+	__m256d t, p, q, r, c, z = _mm256_setzero_pd();
+	__m256d k = _mm256_set1_pd(tick);
+
+	memset(mask, 0, YASS_SIMD_MASK_WORDS(n) * sizeof(*mask));
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		t = _mm256_sub_pd(k, _mm256_cvtepi32_pd(offset != NULL ?
+		    _mm_loadu_si128((const __m128i *)(offset + i)) : zero));
+		p = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)
+						       (period + i)));
+		c = _mm256_cvtepi32_pd(target != NULL ?
+		    _mm_loadu_si128((const __m128i *)(target + i)) : zero);
+
+		q = _mm256_floor_pd(_mm256_div_pd(t, p));
+		r = _mm256_sub_pd(t, _mm256_mul_pd(q, p));
+
+		bits = _mm256_movemask_pd(_mm256_and_pd(
+		    _mm256_cmp_pd(r, c, _CMP_EQ_OQ),
+		    _mm256_cmp_pd(t, z, _CMP_GE_OQ)));
+
+		mask[i / 64] |= bits << (i % 64);
+	}
+
+	mod_mask_tail(tick, i, n, offset, period, target, mask);
+}
+
+__attribute__ ((target("sse4.1")))
+static void mod_mask_sse4(int tick, int n, const int *offset,
+			  const int *period, const int *target,
+			  unsigned long long *mask)
+{
+	int i;
+
+	unsigned long long bits;
+
+	__m128i zero = _mm_setzero_si128();
+	__m128d t, p, q, r, c, z = _mm_setzero_pd();
+	__m128d k = _mm_set1_pd(tick);
+
+	memset(mask, 0, YASS_SIMD_MASK_WORDS(n) * sizeof(*mask));
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		t = _mm_sub_pd(k, _mm_cvtepi32_pd(offset != NULL ?
+		    _mm_loadl_epi64((const __m128i *)(offset + i)) : zero));
+		p = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)
+						    (period + i)));
+		c = _mm_cvtepi32_pd(target != NULL ?
+		    _mm_loadl_epi64((const __m128i *)(target + i)) : zero);
+
+		q = _mm_floor_pd(_mm_div_pd(t, p));
+		r = _mm_sub_pd(t, _mm_mul_pd(q, p));
+
+		bits = _mm_movemask_pd(_mm_and_pd(_mm_cmpeq_pd(r, c),
+						  _mm_cmpge_pd(t, z)));
+
+		mask[i / 64] |= bits << (i % 64);
+	}
+
+	mod_mask_tail(tick, i, n, offset, period, target, mask);
+}
+
+#endif
+
+static mod_mask_fn mod_mask = mod_mask_scalar;
+
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Pick the widest kernel supported by the cpu. The YASS_SIMD
+ * environment variable ("avx2", "sse4" or "scalar") limits the choice,
+ * e.g. to compare the kernels.
+ */
+static void dispatch(void)
+{
+#ifdef SIMD_X86
+	const char *env = getenv("YASS_SIMD");
+
+	if (env != NULL && strcmp(env, "scalar") == 0)
+		return;
+
+	__builtin_cpu_init();
+
+	if ((env == NULL || strcmp(env, "avx2") == 0) &&
+	    __builtin_cpu_supports("avx2"))
+		mod_mask = mod_mask_avx2;
+	else if (__builtin_cpu_supports("sse4.1"))
+		mod_mask = mod_mask_sse4;
+#endif
+}
+
+YASS_EXPORT void yass_simd_mod_mask(int tick, int n, const int *offset,
+				    const int *period, const int *target,
+				    unsigned long long *mask)
+{
+	pthread_once(&dispatch_once, dispatch);
+
+	mod_mask(tick, n, offset, period, target, mask);
+}
@@ -0,0 +1,18 @@
+#ifndef _YASS_SIMD_H
+#define _YASS_SIMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define YASS_SIMD_MASK_WORDS(n) (((n) + 63) / 64)
+
+void yass_simd_mod_mask(int tick, int n, const int *offset,
+			const int *period, const int *target,
+			unsigned long long *mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_SIMD_H */
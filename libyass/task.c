@@ -1,5 +1,4 @@
 #include <jansson.h>
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,19 +6,13 @@
 #include "task.h"
 
 #include "cpu.h"
+#include "heap.h"
 #include "private.h"
 #include "scheduler.h"
 
 YASS_EXPORT int yass_task_exist(struct sched *sched, int id)
 {
-	int i;
-
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		if (yass_task_get_id(sched, i) == id)
-			return 1;
-	}
-
-	return 0;
+	return yass_sched_get_task_from_id(sched, id) != -1;
 }
 
 YASS_EXPORT struct yass_task *yass_task_new(int id)
@@ -38,8 +31,10 @@ YASS_EXPORT struct yass_task *yass_task_new(int id)
 	task->criticality = 1;
 	task->delay = 0;
 	task->threads = 0;
+	task->vm = -1;
 	task->s = -1;
 	task->parallel = -1;
+	task->segments = NULL;
 
 	return task;
 }
@@ -55,8 +50,6 @@ YASS_EXPORT struct yass_task_sched *yass_task_sched_new(int id)
 
 	task->id = id;
 	task->priority = -1;
-	task->release = 0;
-	task->exec = 0;
 
 	return task;
 }
@@ -103,15 +96,11 @@ YASS_EXPORT struct yass_task **yass_tasks_create(const char *data, int *n_tasks,
 	unsigned int j;
 
 	char filename[256];
-	char tmp[128];
-	char s[1024 * 1024] = "";
 
 	json_t *root;
 	json_t *objects, *object, *segments;
 	json_error_t json_error;
 
-	FILE *fp;
-
 	struct yass_task **tasks;
 
 	*error = 0;
@@ -121,17 +110,7 @@ YASS_EXPORT struct yass_task **yass_tasks_create(const char *data, int *n_tasks,
 		return NULL;
 	}
 
-	if ((fp = fopen(filename, "r")) == NULL) {
-		*error = -YASS_ERROR_DATA_FILE;
-		return NULL;
-	}
-
-	while (fgets(tmp, 1024, fp) != NULL)
-		strcat(s, tmp);
-
-	root = json_loads(s, 0, &json_error);
-
-	fclose(fp);
+	root = json_load_file(filename, 0, &json_error);
 
 	if (!root) {
 		fprintf(stderr, "%s: error on line %d: %s\n", filename,
@@ -168,6 +147,18 @@ YASS_EXPORT struct yass_task **yass_tasks_create(const char *data, int *n_tasks,
 		}
 
 		tasks[i]->id = get_int(object, "id");
+
+		if (tasks[i]->id < 0 || tasks[i]->id >= YASS_IDLE_TASK_ID) {
+			fprintf(stderr,
+				"%s: error: task %d has no id or an id "
+				"outside [0, %d)\n", filename, i + 1,
+				YASS_IDLE_TASK_ID);
+			yass_task_free_tasks(tasks, *n_tasks);
+			json_decref(root);
+			*error = -YASS_ERROR_DATA_FILE_JSON;
+			return NULL;
+		}
+
 		tasks[i]->vm = get_int(object, "vm");
 		tasks[i]->threads = get_int(object, "threads");
 		tasks[i]->deadline = get_int(object, "deadline");
@@ -200,6 +191,14 @@ YASS_EXPORT struct yass_task **yass_tasks_create(const char *data, int *n_tasks,
 			tasks[i]->parallel = get_int(object, "parallel");
 			tasks[i]->s = json_array_size(segments);
 
+			tasks[i]->segments = (int *)
+			    malloc(tasks[i]->s * sizeof(int));
+
+			if (tasks[i]->segments == NULL) {
+				*error = -YASS_ERROR_MALLOC;
+				return NULL;
+			}
+
 			for (j = 0; j < json_array_size(segments); j++) {
 				object = json_array_get(segments, j);
 
@@ -222,22 +221,14 @@ YASS_EXPORT void yass_task_free_tasks(struct yass_task **tasks, int n)
 {
 	int i;
 
-	for (i = 0; i < n; i++)
+	for (i = 0; i < n; i++) {
+		free(tasks[i]->segments);
 		free(tasks[i]);
+	}
 
 	free(tasks);
 }
 
-YASS_EXPORT void yass_task_free_exec_time(int **exec_time, int n)
-{
-	int i;
-
-	for (i = 0; i < n; i++)
-		free(exec_time[i]);
-
-	free(exec_time);
-}
-
 YASS_EXPORT struct yass_task_sched **yass_tasks_sched_new(struct sched *sched,
 							  int n_tasks)
 {
@@ -263,28 +254,138 @@ YASS_EXPORT struct yass_task_sched **yass_tasks_sched_new(struct sched *sched,
 	return tasks_sched;
 }
 
-YASS_EXPORT int yass_task_get_from_id(struct sched *sched, int id)
+static void *table_realloc(void *p, int size, size_t n, int *error)
 {
-	int i;
+	void *q = realloc(p, size * n);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		if (yass_task_get_id(sched, i) == id)
-			return i;
+	if (q == NULL && size > 0) {
+		*error = -YASS_ERROR_MALLOC;
+		return p;
 	}
 
-	return -1;
+	return q;
 }
 
-YASS_EXPORT int yass_task_time_to_deadline(struct sched *sched, int id)
+/*
+ * Fill the table of sched from its tasks. Rows already in the table,
+ * e.g. when an idle task is added, keep their next release and their
+ * execution time.
+ */
+YASS_EXPORT int yass_task_table_build(struct sched *sched)
+{
+	int error = 0, i, old;
+
+	int n = sched->n_tasks;
+
+	struct yass_task_table *t = sched->table;
+
+	if (t == NULL) {
+		t = (struct yass_task_table *)
+		    calloc(1, sizeof(struct yass_task_table));
+
+		if (t == NULL)
+			return -YASS_ERROR_MALLOC;
+
+		sched->table = t;
+	}
+
+	t->id = (int *)table_realloc(t->id, n, sizeof(int), &error);
+	t->period = (int *)table_realloc(t->period, n, sizeof(int), &error);
+	t->deadline = (int *)table_realloc(t->deadline, n, sizeof(int),
+					   &error);
+	t->delay = (int *)table_realloc(t->delay, n, sizeof(int), &error);
+	t->wcet = (int *)table_realloc(t->wcet, n, sizeof(int), &error);
+	t->criticality = (int *)table_realloc(t->criticality, n, sizeof(int),
+					      &error);
+	t->deadline_mod = (int *)table_realloc(t->deadline_mod, n, sizeof(int),
+					       &error);
+	t->next_release = (int *)table_realloc(t->next_release, n,
+					       sizeof(int), &error);
+	t->exec = (double *)table_realloc(t->exec, n, sizeof(double), &error);
+
+	if (error)
+		return error;
+
+	old = t->size < n ? t->size : n;
+
+	for (i = 0; i < n; i++) {
+		t->id[i] = sched->tasks[i]->id;
+		t->period[i] = sched->tasks[i]->period;
+		t->deadline[i] = sched->tasks[i]->deadline;
+		t->delay[i] = sched->tasks[i]->delay;
+		t->wcet[i] = sched->tasks[i]->wcet;
+		t->criticality[i] = sched->tasks[i]->criticality;
+
+		if (t->deadline[i] >= 0 && t->deadline[i] <= t->period[i])
+			t->deadline_mod[i] = t->deadline[i] % t->period[i];
+		else
+			t->deadline_mod[i] = -1;
+
+		if (i >= old) {
+			t->next_release[i] = 0;
+			t->exec[i] = 0;
+		}
+	}
+
+	t->size = n;
+
+	return 0;
+}
+
+YASS_EXPORT void yass_task_table_free(struct yass_task_table *t)
+{
+	if (t == NULL)
+		return;
+
+	free(t->id);
+	free(t->period);
+	free(t->deadline);
+	free(t->delay);
+	free(t->wcet);
+	free(t->criticality);
+	free(t->deadline_mod);
+	free(t->next_release);
+	free(t->exec);
+	free(t);
+}
+
+/*
+ * Row of the task in the table of sched, or -1.
+ */
+static int table_row(struct sched *sched, int id)
+{
+	int index = yass_sched_get_task_from_id(sched, id);
+
+	if (index < 0 || sched->table == NULL || index >= sched->table->size)
+		return -1;
+
+	return index;
+}
+
+YASS_EXPORT int yass_task_get_from_id(struct sched *sched, int id)
+{
+	return yass_sched_get_task_from_id(sched, id);
+}
+
+/*
+ * Absolute deadline of the current job of the task. It only changes
+ * when the task is released.
+ */
+YASS_EXPORT int yass_task_get_absolute_deadline(struct sched *sched, int id)
 {
 	yass_warn(yass_task_exist(sched, id));
 
-	int tick = yass_sched_get_tick(sched);
 	int deadline = yass_task_get_deadline(sched, id);
 	int next_release = yass_task_get_next_release(sched, id);
 	int period = yass_task_get_period(sched, id);
 
-	return next_release - period + deadline - tick;
+	return next_release - period + deadline;
+}
+
+YASS_EXPORT int yass_task_time_to_deadline(struct sched *sched, int id)
+{
+	return yass_task_get_absolute_deadline(sched, id) -
+	    yass_sched_get_tick(sched);
 }
 
 YASS_EXPORT int yass_task_get_id(struct sched *sched, int index)
@@ -308,9 +409,28 @@ YASS_EXPORT int yass_task_get_threads(struct sched *sched, int id)
 
 YASS_EXPORT int yass_task_get_wcet(struct sched *sched, int id)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
+
+	yass_warn(index != -1);
+
+	return index != -1 ? sched->table->wcet[index] : 0;
+}
+
+/*
+ * Change the wcet of a task, e.g. of an idle task added by a
+ * scheduler.
+ */
+YASS_EXPORT void yass_task_set_wcet(struct sched *sched, int id, int wcet)
+{
+	int index = table_row(sched, id);
+
+	yass_warn(index != -1);
 
-	return (yass_sched_get_task(sched, id))->wcet;
+	if (index == -1)
+		return;
+
+	sched->tasks[index]->wcet = wcet;
+	sched->table->wcet[index] = wcet;
 }
 
 /*
@@ -339,30 +459,38 @@ YASS_EXPORT int yass_task_get_aet(struct sched *sched, int id)
 
 YASS_EXPORT int yass_task_get_deadline(struct sched *sched, int id)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
+
+	yass_warn(index != -1);
 
-	return (yass_sched_get_task(sched, id))->deadline;
+	return index != -1 ? sched->table->deadline[index] : 0;
 }
 
 YASS_EXPORT int yass_task_get_period(struct sched *sched, int id)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
+
+	yass_warn(index != -1);
 
-	return (yass_sched_get_task(sched, id))->period;
+	return index != -1 ? sched->table->period[index] : 0;
 }
 
 YASS_EXPORT int yass_task_get_delay(struct sched *sched, int id)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
+
+	yass_warn(index != -1);
 
-	return (yass_sched_get_task(sched, id))->delay;
+	return index != -1 ? sched->table->delay[index] : 0;
 }
 
 YASS_EXPORT int yass_task_get_criticality(struct sched *sched, int id)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
 
-	return (yass_sched_get_task(sched, id))->criticality;
+	yass_warn(index != -1);
+
+	return index != -1 ? sched->table->criticality[index] : 0;
 }
 
 YASS_EXPORT int yass_task_get_priority(struct sched *sched, int id)
@@ -382,31 +510,31 @@ YASS_EXPORT void yass_task_set_priority(struct sched *sched, int id,
 
 YASS_EXPORT double yass_task_get_exec(struct sched *sched, int id)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
 
-	return (yass_sched_get_task_sched(sched, id))->exec;
+	yass_warn(index != -1);
+
+	return index != -1 ? sched->table->exec[index] : 0;
 }
 
 YASS_EXPORT void yass_task_set_exec(struct sched *sched, int id, double exec)
 {
-	yass_warn(yass_task_exist(sched, id));
+	int index = table_row(sched, id);
+
+	yass_warn(index != -1);
 
-	(yass_sched_get_task_sched(sched, id))->exec = exec;
+	if (index != -1)
+		sched->table->exec[index] = exec;
 }
 
 YASS_EXPORT void yass_task_exec_inc(struct sched *sched, int id, double exec)
 {
-	int i;
-	double tmp;
+	int index = table_row(sched, id);
 
-	yass_warn(yass_task_exist(sched, id));
+	yass_warn(index != -1);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		if (yass_task_get_id(sched, i) == id) {
-			tmp = yass_task_get_exec(sched, id);
-			yass_task_set_exec(sched, id, tmp + exec);
-		}
-	}
+	if (index != -1)
+		sched->table->exec[index] += exec;
 }
 
 /* Does not work if a task has more than one thread */
@@ -486,110 +614,24 @@ YASS_EXPORT double yass_task_get_lag(struct sched *sched, int id)
 
 YASS_EXPORT void yass_task_set_release(struct sched *sched, int id, int release)
 {
-	yass_warn(yass_task_exist(sched, id));
-
-	(yass_sched_get_task_sched(sched, id))->release = release;
-}
-
-YASS_EXPORT int yass_task_get_next_release(struct sched *sched, int id)
-{
-	yass_warn(yass_task_exist(sched, id));
-
-	return (yass_sched_get_task_sched(sched, id))->release;
-}
-
-YASS_EXPORT int **yass_tasks_exec_new(int n_tasks)
-{
-	int i, j;
-	int **e;
-
-	e = (int **)calloc(n_tasks * YASS_MAX_N_TASK_EXECUTION, sizeof(int));
-
-	if (e == NULL)
-		return NULL;
-
-	for (i = 0; i < n_tasks; i++) {
-		e[i] = (int *)calloc(YASS_MAX_N_TASK_EXECUTION, sizeof(int));
-
-		if (e[i] == NULL)
-			return NULL;
-
-		for (j = 0; j < YASS_MAX_N_TASK_EXECUTION; j++)
-			e[i][j] = 0;
-	}
-
-	return e;
-}
-
-/*
- * Gumbel distribution. See :
- *  http://en.wikipedia.org/wiki/Gumbel_distribution
- */
-__attribute__ ((__unused__))
-static int generate_gumbel(int min, int max)
-{
-	double r = -10, u;
-
-	while (r < -5 || r > 20) {
+	int index = table_row(sched, id);
 
-		u = ((double) rand()) / RAND_MAX;
+	yass_warn(index != -1);
 
-		r = 2 - 4 * log(- log(u));
-	}
-
-	r += 5;
-	r *= (max - min) / 25;
-	r += min;
+	if (index != -1)
+		sched->table->next_release[index] = release;
 
-	return (int)r;
+	if (sched->releases != NULL)
+		yass_heap_update(sched->releases, id, release);
 }
 
-/*
- * Normal distribution, using Box–Muller method. See :
- *  http://en.wikipedia.org/wiki/Normal_distribution
- */
-__attribute__ ((__unused__))
-static int generate_normal(int min, int max)
-{
-	double r = 10, u, v;
-
-	while (r < -4 || r > 4) {
-
-		u = ((double) rand()) / RAND_MAX;
-		v = ((double) rand()) / RAND_MAX;
-
-		r = sqrt(-2 * log(u)) * cos(2 * M_PI * v);
-	}
-
-	r += 4;
-	r *= (max - min) / 8;
-	r += min;
-
-	return (int)r;
-}
-
-YASS_EXPORT int **yass_tasks_generate_exec(struct yass_task **tasks,
-					   int n_tasks)
+YASS_EXPORT int yass_task_get_next_release(struct sched *sched, int id)
 {
-	int i, j;
-	int min, max;
+	int index = table_row(sched, id);
 
-	int **exec_time = yass_tasks_exec_new(n_tasks);
+	yass_warn(index != -1);
 
-	if (exec_time == NULL)
-		return NULL;
-
-	for (i = 0; i < n_tasks; i++) {
-
-		/* min = round(0.5 * tasks[i]->wcet); */
-		min = 1;
-		max = tasks[i]->wcet;
-
-		for (j = 0; j < YASS_MAX_N_TASK_EXECUTION; j++)
-			exec_time[i][j] = generate_normal(min, max);
-	}
-
-	return exec_time;
+	return index != -1 ? sched->table->next_release[index] : 0;
 }
 
 YASS_EXPORT int yass_task_is_active(struct sched *sched, int id)
@@ -617,17 +659,15 @@ YASS_EXPORT int yass_task_get_n_exec(struct sched *sched, int id)
 	int deadline = yass_task_get_deadline(sched, id);
 	int period = yass_task_get_period(sched, id);
 
-	int n = -1, t = 0;
-
-	while (t <= tick) {
-		if (t % period == 0)
-			n++;
-
-		t++;
-	}
+	/*
+	 * Index of the last job released at or before tick. When the
+	 * deadline is equal to the period, a job reaching its deadline
+	 * at tick is still the current one.
+	 */
+	int n = tick / period;
 
 	if (tick != 0 && tick % period == 0 && deadline == period)
 		n--;
 
- 	return n;
+	return n;
 }
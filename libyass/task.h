@@ -22,18 +22,44 @@ struct yass_task {
 
 	int delay;
 
-	/* Fork-join task model */
+	/*
+	 * Fork-join task model. segments is shared with the copies
+	 * made by yass_sched_init_tasks().
+	 */
 	int parallel;
 	int s;
-	int segments[YASS_MAX_SEGMENTS];
+	int *segments;
 };
 
 struct yass_task_sched {
 	int id;
 	int priority;
-	int release;
+};
 
-	double exec;
+/*
+ * Copy of the fields of the tasks used by the scans made at each tick,
+ * in arrays indexed like the tasks of the scheduler, so that the scans
+ * go through contiguous memory. The next release and the execution
+ * time of the current job are only stored here.
+ */
+struct yass_task_table {
+	int size;
+
+	int *id;
+	int *period;
+	int *deadline;
+	int *delay;
+	int *wcet;
+	int *criticality;
+
+	/*
+	 * Remainder modulo the period at which the deadlines of the task
+	 * fall, or -1 if the deadline is larger than the period.
+	 */
+	int *deadline_mod;
+
+	int *next_release;
+	double *exec;
 };
 
 int yass_task_exist(struct sched *sched, int id);
@@ -51,10 +77,14 @@ struct yass_task **yass_tasks_create(const char *data, int *n_tasks,
 
 void yass_task_free_tasks(struct yass_task **tasks, int n);
 
-void yass_task_free_exec_time(int **exec_time, int n);
-
 struct yass_task_sched **yass_tasks_sched_new(struct sched *sched, int n_tasks);
 
+int yass_task_table_build(struct sched *sched);
+
+void yass_task_table_free(struct yass_task_table *t);
+
+int yass_task_get_absolute_deadline(struct sched *sched, int id);
+
 int yass_task_time_to_deadline(struct sched *sched, int id);
 
 int yass_task_get_id(struct sched *sched, int index);
@@ -65,6 +95,8 @@ int yass_task_get_threads(struct sched *sched, int id);
 
 int yass_task_get_wcet(struct sched *sched, int id);
 
+void yass_task_set_wcet(struct sched *sched, int id, int wcet);
+
 int yass_task_get_aet(struct sched *sched, int id);
 
 int yass_task_get_deadline(struct sched *sched, int id);
@@ -105,10 +137,6 @@ void yass_task_set_release(struct sched *sched, int id, int release);
 
 int yass_task_get_next_release(struct sched *sched, int id);
 
-int **yass_tasks_exec_new(int n_tasks);
-
-int **yass_tasks_generate_exec(struct yass_task **tasks, int n_tasks);
-
 int yass_task_is_active(struct sched *sched, int id);
 
 int yass_task_get_exec_hyperperiod(struct sched *sched, int id);
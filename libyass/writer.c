@@ -0,0 +1,378 @@
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "writer.h"
+
+#include "common.h"
+#include "private.h"
+
+#define WRITER_BUFFER_SIZE (256 << 10)
+
+/*
+ * Number of buffers of a writer on top of the one each stream can
+ * hold. When they are all filled and not yet written, streams wait for
+ * one to be written: this bounds the memory used when the disk cannot
+ * keep up.
+ */
+#define WRITER_N_BUFFERS 16
+
+struct buffer {
+	FILE *fp;
+	size_t used;
+	char *data;
+};
+
+struct cell {
+	size_t seq;
+	struct buffer *b;
+};
+
+/*
+ * Bounded multi-producer multi-consumer queue of buffers (Vyukov's),
+ * without locks: the sequence number of each cell tells whether it is
+ * ready to be written or read for the current turn of the ring.
+ */
+struct ring {
+	size_t mask;
+	struct cell *cells;
+
+	size_t head;
+	size_t tail;
+};
+
+/*
+ * Background thread writing the buffers filled by the streams. Filled
+ * buffers go through the filled ring to the thread, which gives them
+ * back through the free ring once written. The semaphores count the
+ * buffers in each ring, so that both sides can sleep.
+ */
+struct yass_writer {
+	pthread_t thread;
+
+	int n_buffers;
+	struct buffer *buffers;
+
+	struct ring filled;
+	struct ring free;
+
+	sem_t n_filled;
+	sem_t n_free;
+
+	/* Queued after the last buffer to stop the thread */
+	struct buffer stop;
+
+	int error;
+};
+
+struct yass_stream {
+	struct yass_writer *w;
+	FILE *fp;
+
+	struct buffer *b;
+};
+
+static int ring_init(struct ring *r, int size)
+{
+	int i;
+
+	r->mask = size - 1;
+	r->head = 0;
+	r->tail = 0;
+
+	r->cells = (struct cell *)malloc(size * sizeof(struct cell));
+
+	if (r->cells == NULL)
+		return -YASS_ERROR_MALLOC;
+
+	for (i = 0; i < size; i++)
+		r->cells[i].seq = i;
+
+	return 0;
+}
+
+/*
+ * The rings are large enough for all the buffers, so a push always
+ * succeeds.
+ */
+static void ring_push(struct ring *r, struct buffer *b)
+{
+	size_t pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+
+	struct cell *c;
+
+	for (;;) {
+		c = &r->cells[pos & r->mask];
+
+		if (__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) == pos &&
+		    __atomic_compare_exchange_n(&r->tail, &pos, pos + 1, 1,
+						__ATOMIC_RELAXED,
+						__ATOMIC_RELAXED))
+			break;
+
+		pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+	}
+
+	c->b = b;
+
+	__atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Only called after a wait on the semaphore of the ring, so a buffer
+ * is available.
+ */
+static struct buffer *ring_pop(struct ring *r)
+{
+	size_t pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+
+	struct buffer *b;
+	struct cell *c;
+
+	for (;;) {
+		c = &r->cells[pos & r->mask];
+
+		if (__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) == pos + 1 &&
+		    __atomic_compare_exchange_n(&r->head, &pos, pos + 1, 1,
+						__ATOMIC_RELAXED,
+						__ATOMIC_RELAXED))
+			break;
+
+		pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+	}
+
+	b = c->b;
+
+	__atomic_store_n(&c->seq, pos + r->mask + 1, __ATOMIC_RELEASE);
+
+	return b;
+}
+
+static void *writer_thread(void *arg)
+{
+	struct yass_writer *w = (struct yass_writer *)arg;
+
+	struct buffer *b;
+
+	for (;;) {
+		while (sem_wait(&w->n_filled) != 0)
+			continue;
+
+		b = ring_pop(&w->filled);
+
+		if (b == &w->stop)
+			break;
+
+		if (fwrite(b->data, 1, b->used, b->fp) != b->used)
+			__atomic_store_n(&w->error, -YASS_ERROR_FILE,
+					 __ATOMIC_RELAXED);
+
+		b->used = 0;
+
+		ring_push(&w->free, b);
+		sem_post(&w->n_free);
+	}
+
+	return NULL;
+}
+
+static void writer_release(struct yass_writer *w)
+{
+	int i;
+
+	if (w->buffers != NULL) {
+		for (i = 0; i < w->n_buffers; i++)
+			free(w->buffers[i].data);
+	}
+
+	free(w->buffers);
+	free(w->filled.cells);
+	free(w->free.cells);
+	free(w);
+}
+
+/*
+ * Start a writer thread, or return NULL and set error. n_streams is
+ * the largest number of streams holding a buffer at the same time,
+ * i.e. between their first write and their yass_stream_flush(): when
+ * more streams write concurrently, the ones waiting for a buffer may
+ * never get one.
+ */
+YASS_EXPORT struct yass_writer *yass_writer_new(int n_streams, int *error)
+{
+	int i, size = 1;
+
+	struct yass_writer *w =
+	    (struct yass_writer *)calloc(1, sizeof(struct yass_writer));
+
+	*error = -YASS_ERROR_MALLOC;
+
+	if (w == NULL)
+		return NULL;
+
+	w->n_buffers = n_streams + WRITER_N_BUFFERS;
+	w->buffers = (struct buffer *)calloc(w->n_buffers,
+					     sizeof(struct buffer));
+
+	/* Room in the filled ring for the stop buffer, in a power of two */
+	while (size < w->n_buffers + 1)
+		size *= 2;
+
+	if (w->buffers == NULL || ring_init(&w->filled, size) ||
+	    ring_init(&w->free, size)) {
+		writer_release(w);
+		return NULL;
+	}
+
+	for (i = 0; i < w->n_buffers; i++) {
+		w->buffers[i].data = (char *)malloc(WRITER_BUFFER_SIZE);
+
+		if (w->buffers[i].data == NULL) {
+			writer_release(w);
+			return NULL;
+		}
+
+		ring_push(&w->free, &w->buffers[i]);
+	}
+
+	sem_init(&w->n_filled, 0, 0);
+	sem_init(&w->n_free, 0, w->n_buffers);
+
+	if (pthread_create(&w->thread, NULL, writer_thread, w) != 0) {
+		sem_destroy(&w->n_filled);
+		sem_destroy(&w->n_free);
+		writer_release(w);
+
+		*error = -YASS_ERROR_THREAD_CREATE;
+		return NULL;
+	}
+
+	*error = 0;
+
+	return w;
+}
+
+/*
+ * Wait for all the buffers given to the writer to be written and stop
+ * its thread. The streams must have been freed. Return an error if a
+ * write failed.
+ */
+YASS_EXPORT int yass_writer_free(struct yass_writer *w)
+{
+	int error;
+
+	if (w == NULL)
+		return 0;
+
+	ring_push(&w->filled, &w->stop);
+	sem_post(&w->n_filled);
+
+	pthread_join(w->thread, NULL);
+
+	error = w->error;
+
+	sem_destroy(&w->n_filled);
+	sem_destroy(&w->n_free);
+	writer_release(w);
+
+	return error;
+}
+
+/*
+ * Stream of data written to fp by the writer thread, in the order of
+ * the calls.
+ */
+YASS_EXPORT struct yass_stream *yass_stream_new(struct yass_writer *w,
+						FILE *fp)
+{
+	struct yass_stream *s =
+	    (struct yass_stream *)malloc(sizeof(struct yass_stream));
+
+	if (s == NULL)
+		return NULL;
+
+	s->w = w;
+	s->fp = fp;
+	s->b = NULL;
+
+	return s;
+}
+
+static void stream_submit(struct yass_stream *s)
+{
+	ring_push(&s->w->filled, s->b);
+	sem_post(&s->w->n_filled);
+
+	s->b = NULL;
+}
+
+/*
+ * Space for n bytes at the end of the buffer of the stream, a full
+ * buffer being given to the writer first. Waits for a buffer to be
+ * written if none is free.
+ */
+static char *stream_reserve(struct yass_stream *s, size_t n)
+{
+	if (s->b != NULL && s->b->used + n > WRITER_BUFFER_SIZE)
+		stream_submit(s);
+
+	if (s->b == NULL) {
+		while (sem_wait(&s->w->n_free) != 0)
+			continue;
+
+		s->b = ring_pop(&s->w->free);
+		s->b->fp = s->fp;
+		s->b->used = 0;
+	}
+
+	return s->b->data + s->b->used;
+}
+
+/*
+ * Give the current buffer to the writer, so that the stream holds no
+ * buffer until its next write.
+ */
+YASS_EXPORT void yass_stream_flush(struct yass_stream *s)
+{
+	if (s == NULL || s->b == NULL)
+		return;
+
+	if (s->b->used > 0) {
+		stream_submit(s);
+	} else {
+		ring_push(&s->w->free, s->b);
+		sem_post(&s->w->n_free);
+
+		s->b = NULL;
+	}
+}
+
+YASS_EXPORT void yass_stream_free(struct yass_stream *s)
+{
+	if (s == NULL)
+		return;
+
+	yass_stream_flush(s);
+
+	free(s);
+}
+
+YASS_EXPORT void yass_stream_write(struct yass_stream *s, const void *data,
+				   size_t n)
+{
+	const char *p = (const char *)data;
+
+	size_t k;
+
+	while (n > 0) {
+		k = n < WRITER_BUFFER_SIZE ? n : WRITER_BUFFER_SIZE;
+
+		memcpy(stream_reserve(s, k), p, k);
+		s->b->used += k;
+
+		p += k;
+		n -= k;
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef _YASS_WRITER_H
+#define _YASS_WRITER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct yass_writer;
+
+struct yass_stream;
+
+struct yass_writer *yass_writer_new(int n_streams, int *error);
+
+int yass_writer_free(struct yass_writer *w);
+
+struct yass_stream *yass_stream_new(struct yass_writer *w, FILE *fp);
+
+void yass_stream_flush(struct yass_stream *s);
+
+void yass_stream_free(struct yass_stream *s);
+
+void yass_stream_write(struct yass_stream *s, const void *data, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _YASS_WRITER_H */
@@ -1,4 +1,4 @@
-#include <pthread.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,12 +9,14 @@
 #include "common.h"
 #include "cpu.h"
 #include "log.h"
+#include "pool.h"
 #include "private.h"
+#include "simd.h"
 #include "scheduler.h"
 #include "task.h"
+#include "writer.h"
 
 struct thread_info {
-	pthread_t id;
 	struct sched *sched;
 	int n_ticks;
 	int error;
@@ -27,9 +29,11 @@ struct configuration_type {
 };
 
 YASS_EXPORT int yass_init_tasks(struct yass *yass, struct yass_task **tasks,
-				int **exec_time)
+				struct yass_exec_time *exec_time)
 {
-	int error, h, i, id, j;
+	int error, i;
+	unsigned long long h;
+
 	int n_tasks = yass_sched_get_ntasks(yass_get_sched(yass, 0));
 
 	struct sched *sched;
@@ -49,19 +53,12 @@ YASS_EXPORT int yass_init_tasks(struct yass *yass, struct yass_task **tasks,
 		yass_set_nticks(yass, yass_get_nticks(yass));
 	} else {
 		h = yass_sched_get_hyperperiod(sched);
-		yass_set_nticks(yass, yass_get_nhyperperiods(yass) * h + 1);
-	}
 
-	yass_sched_get_hyperperiod(sched);
+		if (h > (unsigned long long)(INT_MAX - 1) /
+		    yass_get_nhyperperiods(yass))
+			return -YASS_ERROR_HYPERPERIOD;
 
-	/* Check that each id is unique */
-	for (i = 0; i < n_tasks - 1; i++) {
-		id = yass_task_get_id(sched, i);
-
-		for (j = i + 1; j < n_tasks; j++) {
-			if (yass_task_get_id(sched, j) == id)
-				return -YASS_ERROR_ID_NOT_UNIQUE;
-		}
+		yass_set_nticks(yass, yass_get_nhyperperiods(yass) * h + 1);
 	}
 
 	return 0;
@@ -96,64 +93,78 @@ YASS_EXPORT int yass_init(struct yass *yass, int energy, int n_cpus,
 	yass_set_nhyperperiods(yass, n_hyperperiods);
 
 	yass->energy = energy;
+	yass->async_trace = 0;
 
 	return 0;
 }
 
 static void yass_log_indep(struct sched *sched)
 {
-	int i, id, tick_delay;
-	int delay, deadline, period;
+	int i, id, w;
 
 	int tick = yass_sched_get_tick(sched);
 
-	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
-		id = yass_task_get_id(sched, i);
+	unsigned long long bits, *released, *due;
 
-		if (yass_sched_task_is_idle_task(sched, id))
-			continue;
+	struct yass_task_table *t = sched->table;
 
-		delay = yass_task_get_delay(sched, id);
-		deadline = yass_task_get_deadline(sched, id);
-		period = yass_task_get_period(sched, id);
+	released = (unsigned long long *)
+	    yass_sched_alloc(sched, YASS_SIMD_MASK_WORDS(t->size) *
+			     sizeof(unsigned long long));
+	due = (unsigned long long *)
+	    yass_sched_alloc(sched, YASS_SIMD_MASK_WORDS(t->size) *
+			     sizeof(unsigned long long));
 
-		tick_delay = tick - delay;
+	if (released == NULL || due == NULL)
+		return;
 
-		if (tick_delay < 0)
-			continue;
+	yass_simd_mod_mask(tick, t->size, t->delay, t->period, NULL, released);
+	yass_simd_mod_mask(tick, t->size, t->delay, t->period, t->deadline_mod,
+			   due);
 
-		if (tick_delay % period == 0) {
-			yass_log_sched(sched, YASS_EVENT_TASK_RELEASE, id,
-				       tick, 0, 0, 0);
+	for (w = 0; w < YASS_SIMD_MASK_WORDS(t->size); w++) {
+		for (bits = released[w] | due[w]; bits != 0; bits &= bits - 1) {
+			i = w * 64 + __builtin_ctzll(bits);
 
-			if (period == deadline && tick != delay)
-				yass_log_sched(sched, YASS_EVENT_TASK_DEADLINE,
+			id = t->id[i];
+
+			if (yass_sched_task_is_idle_task(sched, id))
+				continue;
+
+			if (released[w] & (1ULL << (i % 64)))
+				yass_log_sched(sched, YASS_EVENT_TASK_RELEASE,
 					       id, tick, 0, 0, 0);
-		}
 
-		if ((tick_delay / period) * period + deadline == tick_delay) {
-			yass_log_sched(sched, YASS_EVENT_TASK_DEADLINE, id,
-				       tick, 0, 0, 0);
+			/* The first release is not the deadline of a job */
+			if ((due[w] & (1ULL << (i % 64))) &&
+			    (t->deadline[i] != t->period[i] ||
+			     tick != t->delay[i]))
+				yass_log_sched(sched, YASS_EVENT_TASK_DEADLINE,
+					       id, tick, 0, 0, 0);
 		}
 	}
 }
 
-static void *routine(void *arg)
+/*
+ * Simulate n_ticks ticks of a scheduler whose tasks have been
+ * initialized.
+ */
+YASS_EXPORT int yass_run_sched(struct sched *sched, int n_ticks)
 {
-	int error = 0, j, k;
-
-	int n_ticks = ((struct thread_info *)arg)->n_ticks;
-	struct sched *sched = ((struct thread_info *)arg)->sched;
+	int error = 0, j, k, skip;
 
 	error = yass_sched_offline(sched);
 
 	if (error)
-		goto error;
+		return error;
+
+	yass_sched_alloc_reset(sched);
 
 	yass_warn(n_ticks >= YASS_DEFAULT_MIN_TICKS);
 
 	for (j = 0; j < n_ticks; j++) {
-		if (yass_sched_get_index(sched) == 0)
+		if (yass_sched_get_index(sched) == 0 &&
+		    yass_log_enabled(sched, YASS_TRACE_TASKS))
 			yass_log_indep(sched);
 
 		yass_sched_check_deadline_misses(sched);
@@ -162,7 +173,7 @@ static void *routine(void *arg)
 
 		if (error) {
 			yass_sched_close(sched);
-			goto error;
+			return error;
 		}
 
 		for (k = 0; k < yass_sched_get_ncpus(sched); k++)
@@ -171,31 +182,55 @@ static void *routine(void *arg)
 		yass_sched_update_idle(sched);
 
 		yass_sched_tick_inc(sched);
+
+		/*
+		 * In event-driven mode, jump directly to the next tick
+		 * at which the scheduler has something to do.
+		 */
+		if (yass_sched_get_event_driven(sched)) {
+			skip = yass_sched_next_event(sched) -
+			    yass_sched_get_tick(sched);
+
+			if (skip > n_ticks - j - 1)
+				skip = n_ticks - j - 1;
+
+			if (skip > 0) {
+				yass_sched_skip(sched, skip);
+				j += skip;
+			}
+		}
+
+		yass_sched_alloc_reset(sched);
 	}
 
 	yass_sched_end_idle_periods(sched);
 
-	error = yass_sched_close(sched);
-
-	if (error)
-		goto error;
+	return yass_sched_close(sched);
+}
 
-	return NULL;
+static void routine(void *arg)
+{
+	struct thread_info *tinfo = (struct thread_info *)arg;
 
- error:
-	((struct thread_info *)arg)->error = error;
+	tinfo->error = yass_run_sched(tinfo->sched, tinfo->n_ticks);
 
-	return NULL;
+	yass_log_sched_flush(tinfo->sched);
 }
 
+/*
+ * Run each scheduler as a work of a pool of jobs threads, so that a
+ * thread is never idle while a scheduler is waiting to be run.
+ */
 YASS_EXPORT int yass_run(struct yass *yass, int jobs)
 {
-	int end, error, i, n, s;
+	int error = 0, i, r;
 
 	int n_ticks = yass_get_nticks(yass);
 	int n_schedulers = yass_get_nschedulers(yass);
 
 	struct sched *sched;
+	struct yass_pool *pool;
+	struct yass_writer *writer = NULL;
 
 	struct thread_info *tinfo = (struct thread_info *)
 	    calloc(n_schedulers, sizeof(struct thread_info));
@@ -203,50 +238,80 @@ YASS_EXPORT int yass_run(struct yass *yass, int jobs)
 	if (tinfo == NULL)
 		return -YASS_ERROR_MALLOC;
 
-	error = 0;
-	n = 0;
-
 	if (n_schedulers <= jobs)
 		jobs = n_schedulers;
 
-	while (n * jobs < n_schedulers) {
-		if ((n + 1) * jobs > n_schedulers - 1)
-			end = n_schedulers;
-		else
-			end = (n + 1) * jobs;
+	if (yass_get_async_trace(yass)) {
+		/* A trace and a verbose stream for each running scheduler */
+		writer = yass_writer_new(2 * jobs, &error);
+
+		if (writer == NULL) {
+			free(tinfo);
+			return error;
+		}
+	}
+
+	/*
+	 * Even with a single thread, the pool does not run the
+	 * schedulers in order: only a single scheduler writes to the
+	 * trace directly.
+	 */
+	if (n_schedulers > 1)
+		error = yass_log_segments_new(yass);
 
-		for (i = n * jobs; i < end; i++) {
-			sched = yass_get_sched(yass, i);
+	if (!error && writer != NULL)
+		error = yass_log_streams_new(yass, writer);
 
-			tinfo[i].sched = sched;
-			tinfo[i].n_ticks = n_ticks;
-			tinfo[i].error = 0;
+	if (!error)
+		error = yass_log_encoders_new(yass);
 
-			if (yass_sched_get_debug(sched))
-				printf("RUN: %s\n", yass_sched_get_name(sched));
+	if (error)
+		goto end_segments;
 
-			s = pthread_create(&tinfo[i].id, NULL, &routine,
-					   &tinfo[i]);
+	pool = yass_pool_new(jobs, &error);
 
-			if (s != 0) {
-				error = -YASS_ERROR_THREAD_CREATE;
-				goto end;
-			}
-		}
+	if (pool == NULL)
+		goto end_segments;
 
-		for (i = n * jobs; i < end; i++) {
-			pthread_join(tinfo[i].id, NULL);
+	for (i = 0; i < n_schedulers; i++) {
+		sched = yass_get_sched(yass, i);
 
-			if (tinfo[i].error < 0) {
-				error = tinfo[i].error;
-				goto end;
-			}
-		}
+		tinfo[i].sched = sched;
+		tinfo[i].n_ticks = n_ticks;
+		tinfo[i].error = 0;
+
+		if (yass_sched_get_debug(sched))
+			printf("RUN: %s\n", yass_sched_get_name(sched));
 
-		n++;
+		error = yass_pool_submit(pool, &routine, &tinfo[i]);
+
+		if (error)
+			break;
+	}
+
+	yass_pool_wait(pool);
+	yass_pool_free(pool);
+
+	for (i = 0; i < n_schedulers && !error; i++) {
+		if (tinfo[i].error < 0)
+			error = tinfo[i].error;
 	}
 
- end:
+ end_segments:
+	yass_log_encoders_free(yass);
+	yass_log_streams_free(yass);
+
+	/* The segments are complete once the writer is done */
+	r = yass_writer_free(writer);
+
+	if (!error)
+		error = r;
+
+	r = yass_log_segments_merge(yass);
+
+	if (!error)
+		error = r;
+
 	free(tinfo);
 
 	return error;
@@ -290,6 +355,16 @@ YASS_EXPORT int yass_get_energy(struct yass *y)
 	return y->energy;
 }
 
+YASS_EXPORT int yass_get_async_trace(struct yass *y)
+{
+	return y->async_trace;
+}
+
+YASS_EXPORT void yass_set_async_trace(struct yass *y, int async_trace)
+{
+	y->async_trace = async_trace;
+}
+
 YASS_EXPORT int yass_get_nticks(struct yass *y)
 {
 	return y->n_ticks;
@@ -355,6 +430,12 @@ YASS_EXPORT void yass_handle_error(int error_code)
 	fprintf(stderr, "Error: ");
 
 	switch (error_code) {
+	case -YASS_ERROR_CAMPAIGN_FILE:
+		fprintf(stderr, "error while parsing campaign file\n");
+		break;
+	case -YASS_ERROR_CAMPAIGN_FILE_JSON:
+		fprintf(stderr, "campaign file is not a valid json file\n");
+		break;
 	case -YASS_ERROR_CPU_FILE:
 		fprintf(stderr, "error while parsing processor file\n");
 		break;
@@ -376,6 +457,9 @@ YASS_EXPORT void yass_handle_error(int error_code)
 	case -YASS_ERROR_FILE:
 		fprintf(stderr, "error while searching a file\n");
 		break;
+	case -YASS_ERROR_HYPERPERIOD:
+		fprintf(stderr, "hyperperiod too large\n");
+		break;
 	case -YASS_ERROR_ID_NOT_UNIQUE:
 		fprintf(stderr, "task id must be unique\n");
 		break;
@@ -400,8 +484,11 @@ YASS_EXPORT void yass_handle_error(int error_code)
 	case -YASS_ERROR_SCHEDULE:
 		fprintf(stderr, "cannot schedule the task set\n");
 		break;
+	case -YASS_ERROR_SCHEDULER_ABI:
+		fprintf(stderr, "unsupported scheduler interface version\n");
+		break;
 	case -YASS_ERROR_SCHEDULER_NOT_UNIQUE:
-		fprintf(stderr, "a scheduler can only be used once\n");
+		fprintf(stderr, "this scheduler can only be used once\n");
 		break;
 	case -YASS_ERROR_SCHEDULER_NAME_TOO_SHORT:
 		fprintf(stderr, "scheduler name must be greater than 1\n");
@@ -412,6 +499,15 @@ YASS_EXPORT void yass_handle_error(int error_code)
 	case -YASS_ERROR_TICKS_HYPERPERIOD:
 		fprintf(stderr, "cannot set both ticks and hyperperiods\n");
 		break;
+	case -YASS_ERROR_TRACE_FORMAT:
+		fprintf(stderr, "unknown trace format\n");
+		break;
+	case -YASS_ERROR_TRACE_EVENTS:
+		fprintf(stderr, "unknown trace events\n");
+		break;
+	case -YASS_ERROR_TRACE_BLOCK:
+		fprintf(stderr, "corrupted trace block\n");
+		break;
 	case -YASS_ERROR_DEFAULT:
 	default:
 		fprintf(stderr, "error while running yass\n");
@@ -15,6 +15,9 @@ struct yass {
 	int n_hyperperiods;
 
 	int energy;
+
+	/* Write the traces from a background thread */
+	int async_trace;
 };
 
 struct yass *yass_new(void);
@@ -25,7 +28,9 @@ int yass_init(struct yass *yass, int energy, int n_cpus, int n_ticks,
 	      int debug);
 
 int yass_init_tasks(struct yass *yass, struct yass_task **tasks,
-		    int **exec_time);
+		    struct yass_exec_time *exec_time);
+
+int yass_run_sched(struct sched *sched, int n_ticks);
 
 int yass_run(struct yass *yass, int jobs);
 
@@ -37,6 +42,10 @@ int yass_get_nschedulers(struct yass *y);
 
 int yass_get_energy(struct yass *y);
 
+int yass_get_async_trace(struct yass *y);
+
+void yass_set_async_trace(struct yass *y, int async_trace);
+
 int yass_get_nticks(struct yass *y);
 
 void yass_set_nticks(struct yass *y, int ticks);
@@ -8,34 +8,47 @@
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
 
-double *rw;
-double *pw;
-double *a;
-double *uf;
-int *m;
-int *o;
+	double *rw;
+	double *pw;
+	double *a;
+	double *uf;
+	int *m;
+	int *o;
 
-int **assign;
+	int **assign;
 
-int k;
+	int k;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "Boundary Fair";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i, id, n_tasks, t;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 
-	if (!yass_dpm_schedulability_test(sched))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+	struct data *d;
+
+	*error = 0;
+
+	if (!yass_dpm_schedulability_test(sched)) {
+		*error = -YASS_ERROR_NOT_SCHEDULABLE;
+		return NULL;
+	}
 
 	t = yass_sched_get_total_exec(sched);
 
@@ -48,42 +61,51 @@ int offline(struct sched *sched)
 	 * yass_dpm_schedulability_test().
 	 */
 	if (n_cpus * yass_sched_get_hyperperiod(sched) - t > 0) {
-		if (yass_sched_add_idle_task(sched))
-			return -YASS_ERROR_NOT_SCHEDULABLE;
+		if (yass_sched_add_idle_task(sched)) {
+			*error = -YASS_ERROR_NOT_SCHEDULABLE;
+			return NULL;
+		}
 	}
 
 	n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	d = (struct data *)malloc(sizeof(struct data));
 
-	rw = (double *)malloc(n_tasks * sizeof(double));
-	pw = (double *)malloc(n_tasks * sizeof(double));
-	a = (double *)malloc(n_tasks * sizeof(double));
-	uf = (double *)malloc(n_tasks * sizeof(double));
-	m = (int *)malloc(n_tasks * sizeof(int));
-	o = (int *)malloc(n_tasks * sizeof(int));
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
+
+	d->rw = (double *)malloc(n_tasks * sizeof(double));
+	d->pw = (double *)malloc(n_tasks * sizeof(double));
+	d->a = (double *)malloc(n_tasks * sizeof(double));
+	d->uf = (double *)malloc(n_tasks * sizeof(double));
+	d->m = (int *)malloc(n_tasks * sizeof(int));
+	d->o = (int *)malloc(n_tasks * sizeof(int));
 
 	for (i = 0; i < n_tasks; i++) {
 		id = yass_task_get_id(sched, i);
 
-		yass_list_add(stalled, id);
+		yass_list_add(d->stalled, id);
 
-		rw[i] = 0;
+		d->rw[i] = 0;
 	}
 
-	assign = (int **)malloc(n_cpus * 2 * sizeof(int));
+	d->assign = (int **)malloc(n_cpus * 2 * sizeof(int));
 
 	for (i = 0; i < n_cpus; i++) {
-		assign[i] = (int *)malloc(2 * sizeof(int));
-		assign[i][0] = 0;
-		assign[i][1] = 0;
+		d->assign[i] = (int *)malloc(2 * sizeof(int));
+		d->assign[i][0] = 0;
+		d->assign[i][1] = 0;
 	}
 
-	k = 0;
+	d->k = 0;
 
-	return 0;
+	return d;
 }
 
 /*
@@ -98,7 +120,7 @@ static int get_period_length(struct sched *sched)
 	return (next_release - tick);
 }
 
-static double compute_ru(struct sched *sched)
+static double compute_ru(struct sched *sched, struct data *d)
 {
 	int i;
 	double sum = 0;
@@ -111,12 +133,12 @@ static double compute_ru(struct sched *sched)
 	 * TODO: Line 6 Algorithm 1
 	 */
 	for (i = 0; i < n_tasks; i++)
-		sum += m[i];
+		sum += d->m[i];
 
 	return length * n_cpus - sum;
 }
 
-static void sort_tab(struct yass_list *q)
+static void sort_tab(struct data *d, struct yass_list *q)
 {
 	int i, j, n, index, tmp;
 	double a1, a2, uf1, uf2;
@@ -125,8 +147,8 @@ static void sort_tab(struct yass_list *q)
 
 		index = yass_list_get(q, i);
 
-		a1 = a[index];
-		uf1 = uf[index];
+		a1 = d->a[index];
+		uf1 = d->uf[index];
 
 		n = -1;
 
@@ -134,8 +156,8 @@ static void sort_tab(struct yass_list *q)
 
 			index = yass_list_get(q, j);
 
-			a2 = a[index];
-			uf2 = uf[index];
+			a2 = d->a[index];
+			uf2 = d->uf[index];
 
 			if (a1 == 0 && a2 == 0)
 				continue;
@@ -164,7 +186,7 @@ static void sort_tab(struct yass_list *q)
  * TODO: Must be updated to use some sort of recursivity, see last
  * paragraph, page 3 of zhu's paper.
  */
-static void compute_a_uf(struct sched *sched)
+static void compute_a_uf(struct sched *sched, struct data *d)
 {
 	int i, id, s;
 	double ak, uf1, w;
@@ -195,18 +217,18 @@ static void compute_a_uf(struct sched *sched)
 
 			bk1 = yass_sched_get_next_boundary(sched, bk);
 
-			if (k > 0)
+			if (d->k > 0)
 				ak = bk1 * w - floorf(bk * w) - (bk1 - bk);
 			else
 				ak = -1;
 
-			if (k >= 1 && ak < 0)
+			if (d->k >= 1 && ak < 0)
 				uf1 = (1 - bk1 * w + floorf(bk1 * w)) / w;
 			else
 				uf1 = 0;
 
-			a[i] = ak;
-			uf[i] = uf1;
+			d->a[i] = ak;
+			d->uf[i] = uf1;
 
 			s++;
 		}
@@ -214,54 +236,52 @@ static void compute_a_uf(struct sched *sched)
 
 }
 
-static int task_selection(struct sched *sched)
+static int task_selection(struct sched *sched, struct data *d)
 {
 	int i;
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 	int tick = yass_sched_get_tick(sched);
 
-	struct yass_list *t = yass_list_new(n_tasks);
+	struct yass_list *t = yass_list_new_scratch(sched, n_tasks);
 
 	/*
 	 * Remainings units
 	 */
-	int ru = compute_ru(sched);
+	int ru = compute_ru(sched, d);
 
 	double bk = tick;
 	double bk1 = yass_sched_get_next_boundary(sched, tick);
 
 	for (i = 0; i < n_tasks; i++) {
-		o[i] = 0;
+		d->o[i] = 0;
 
-		if (pw[i] > 0.0001 && m[i] < (bk1 - bk))
+		if (d->pw[i] > 0.0001 && d->m[i] < (bk1 - bk))
 			yass_list_add(t, i);
 	}
 
-	if (k != 0) {
-		compute_a_uf(sched);
+	if (d->k != 0) {
+		compute_a_uf(sched, d);
 
-		sort_tab(t);
+		sort_tab(d, t);
 	}
 
 	if (ru > n_tasks)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
 	for (i = 0; i < ru; i++) {
-		o[yass_list_get(t, i)] = 1;
-		m[yass_list_get(t, i)]++;
+		d->o[yass_list_get(t, i)] = 1;
+		d->m[yass_list_get(t, i)]++;
 	}
 
 	for (i = 0; i < n_tasks; i++) {
-		rw[i] = pw[i] - o[i];
+		d->rw[i] = d->pw[i] - d->o[i];
 	}
 
-	yass_list_free(t);
-
 	return 0;
 }
 
-static int generate_schedule(struct sched *sched)
+static int generate_schedule(struct sched *sched, struct data *d)
 {
 	int i, j;
 	int cpu = 0;
@@ -272,10 +292,10 @@ static int generate_schedule(struct sched *sched)
 	int n_tasks = yass_sched_get_ntasks(sched);
 
 	for (i = 0; i < n_tasks; i++) {
-		for (j = 0; j < m[i]; j++) {
+		for (j = 0; j < d->m[i]; j++) {
 			if (t % length == 0) {
-				assign[cpu][0] = i;
-				assign[cpu][1] = j;
+				d->assign[cpu][0] = i;
+				d->assign[cpu][1] = j;
 
 				cpu++;
 			}
@@ -290,8 +310,10 @@ static int generate_schedule(struct sched *sched)
 	return 0;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int cpu, i, id;
 	double tmp, utilization;
 
@@ -300,13 +322,14 @@ int schedule(struct sched *sched)
 
 	yass_exec_inc(sched);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
 	/*
 	 * The algorithm is only ran on job boundaries, thus only we a
 	 * task becomes ready.
 	 */
-	if (yass_check_ready_tasks(sched, stalled, ready)) {
+	if (yass_check_ready_tasks(sched, d->stalled, d->ready)) {
 
 		for (i = 0; i < n_tasks; i++) {
 			id = yass_task_get_id(sched, i);
@@ -314,27 +337,27 @@ int schedule(struct sched *sched)
 
 			tmp = get_period_length(sched);
 			tmp *= utilization;
-			tmp += rw[i];
+			tmp += d->rw[i];
 
 			if (tmp <= 0)
-				m[i] = 0;
+				d->m[i] = 0;
 			else
-				m[i] = (int)floorf(tmp);
+				d->m[i] = (int)floorf(tmp);
 
-			pw[i] = tmp - m[i];
+			d->pw[i] = tmp - d->m[i];
 		}
 
-		if (task_selection(sched))
+		if (task_selection(sched, d))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
-		if (generate_schedule(sched))
+		if (generate_schedule(sched, d))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
-		k++;
+		d->k++;
 	}
 
 	for (i = 0; i < n_cpus; i++) {
-		id = yass_task_get_id(sched, assign[i][0]);
+		id = yass_task_get_id(sched, d->assign[i][0]);
 
 		if (id != yass_cpu_get_task(sched, i)) {
 
@@ -342,7 +365,8 @@ int schedule(struct sched *sched)
 			 * Preempt the task running on the cpu
 			 */
 			if (yass_cpu_is_active(sched, i))
-				yass_preempt_task(sched, i, running, ready);
+				yass_preempt_task(sched, i, d->running,
+						  d->ready);
 
 			/*
 			 * The task to schedule can already be active
@@ -351,53 +375,58 @@ int schedule(struct sched *sched)
 			 */
 			if (yass_task_get_cpu(sched, id) != -1) {
 				cpu = yass_task_get_cpu(sched, id);
-				yass_preempt_task(sched, cpu, running, ready);
+				yass_preempt_task(sched, cpu, d->running,
+						  d->ready);
 			}
 
-			yass_run_task(sched, i, id, ready, running);
+			yass_run_task(sched, i, id, d->ready, d->running);
 		}
 
-		assign[i][1]++;
+		d->assign[i][1]++;
 
 		/*
 		 * The current task has finished its execution, find
 		 * the next one.
 		 */
-		if (assign[i][1] == m[assign[i][0]]) {
+		if (d->assign[i][1] == d->m[d->assign[i][0]]) {
 
 			do {
-				assign[i][0]++;
-			} while (assign[i][0] < n_tasks &&
-				 m[assign[i][0]] == 0);
+				d->assign[i][0]++;
+			} while (d->assign[i][0] < n_tasks &&
+				 d->m[d->assign[i][0]] == 0);
 
-			assign[i][1] = 0;
+			d->assign[i][1] = 0;
 		}
 	}
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int i;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
 
-	free(rw);
-	free(m);
-	free(pw);
-	free(a);
-	free(uf);
-	free(o);
+	free(d->rw);
+	free(d->m);
+	free(d->pw);
+	free(d->a);
+	free(d->uf);
+	free(d->o);
 
 	for (i = 0; i < n_cpus; i++)
-		free(assign[i]);
+		free(d->assign[i]);
+
+	free(d->assign);
 
-	free(assign);
+	free(d);
 
 	return 0;
 }
@@ -3,6 +3,7 @@
 
 #include <libyass/yass.h>
 #include <libyass/list.h>
+#include <libyass/partition.h>
 
 #define INC 1
 #define PERIOD 100.0
@@ -50,4 +51,10 @@ void deadline_miss(struct sched *sched,
 		   struct yass_list *ready_tasks,
 		   int *server_running);
 
+void server_tasks_assign(struct sched *sched, struct yass_partition *p,
+			 int n_servers, int id);
+
+void server_tasks_add(struct sched *sched, struct yass_partition *p,
+		      int n_servers, int id);
+
 #endif
@@ -1,10 +1,12 @@
 
 #include <math.h>
+#include <stdlib.h>
 
 #include <libyass/common.h>
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
+#include <libyass/partition.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
@@ -29,9 +31,42 @@ double compute_sbf(struct server *servers, double time, int vm)
 	return sbf;
 }
 
+/*
+ * Number of jobs of each task whose execution time is sampled to
+ * compute the quantile used when prob is negative.
+ */
+#define N_SAMPLES 4096
+
+static int compare_desc(const void *a, const void *b)
+{
+	return *(const int *)b - *(const int *)a;
+}
+
+static int *sort_exec_times(struct sched *sched, int n_tasks)
+{
+	int i, id, j;
+
+	int *sorted = (int *)malloc(n_tasks * N_SAMPLES * sizeof(int));
+
+	if (sorted == NULL)
+		return NULL;
+
+	for (i = 0; i < n_tasks; i++) {
+		id = yass_task_get_id(sched, i);
+
+		for (j = 0; j < N_SAMPLES; j++)
+			sorted[i * N_SAMPLES + j] =
+			    yass_sched_get_exec_time(sched, id, j);
+	}
+
+	qsort(sorted, n_tasks * N_SAMPLES, sizeof(int), compare_desc);
+
+	return sorted;
+}
+
 int is_sched_edf(struct server *servers, struct sched *sched, int vm, double prob)
 {
-	int i, id, j, k, l;
+	int i, id, k;
 	double dbf, sbf, time;
 
 	unsigned long long hyperperiod = yass_sched_get_hyperperiod_vm(sched, vm);
@@ -40,28 +75,14 @@ int is_sched_edf(struct server *servers, struct sched *sched, int vm, double pro
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	int sorted[YASS_MAX_N_TASKS * YASS_MAX_N_TASK_EXECUTION];
-
-	int **exec_times = yass_sched_get_exec_times(sched);
-
-	for (i = 0; i < YASS_MAX_N_TASKS * YASS_MAX_N_TASK_EXECUTION; i++)
-		sorted[i] = -1;
-
-        if (prob != 0 && prob < 0) {
-	        for (i = 0; i < n_tasks; i++) {
-		        for (j = 0; j < YASS_MAX_N_TASK_EXECUTION; j++){
-			        k = 0;
+	int *sorted = NULL;
 
-			        while (sorted[k] > exec_times[i][j] && k < YASS_MAX_N_TASKS * YASS_MAX_N_TASK_EXECUTION)
-				        k++;
+	if (prob != 0 && prob < 0) {
+		sorted = sort_exec_times(sched, n_tasks);
 
-			        for (l = YASS_MAX_N_TASKS * YASS_MAX_N_TASK_EXECUTION - 1; l > k; l--)
-				        sorted[l] = sorted[l - 1];
-
-			        sorted[k] = exec_times[i][j];
-		        }
-	        }
-        }
+		if (sorted == NULL)
+			return 0;
+	}
 
 	for (time = 0; time <= hyperperiod; time++) {
 
@@ -78,7 +99,12 @@ int is_sched_edf(struct server *servers, struct sched *sched, int vm, double pro
 				wcet /= 2;
 				wcet += sqrt((prob * (stddev * stddev) / (1 - prob)));
 			} else if (prob != 0 && prob < 0) {
-				wcet = sorted[(int)ceil(prob * n_tasks * YASS_MAX_N_TASK_EXECUTION)];
+				k = ceil(-prob * n_tasks * N_SAMPLES);
+
+				if (k > n_tasks * N_SAMPLES - 1)
+					k = n_tasks * N_SAMPLES - 1;
+
+				wcet = sorted[k];
 			}
 
 			if (yass_task_get_vm(sched, id) == vm)
@@ -87,10 +113,14 @@ int is_sched_edf(struct server *servers, struct sched *sched, int vm, double pro
 
 		sbf = compute_sbf(servers, time, vm);
 
-		if (dbf > sbf)
+		if (dbf > sbf) {
+			free(sorted);
 			return 0;
+		}
 	}
 
+	free(sorted);
+
 	return 1;
 }
 
@@ -298,3 +328,35 @@ void deadline_miss(struct sched *sched,
 		}
 	}
 }
+
+/*
+ * Tasks without a vm, or with a vm beyond the servers, belong to no
+ * server and are never scheduled: they are kept out of the partition
+ * of the tasks by server.
+ */
+static int task_server(struct sched *sched, int n_servers, int id)
+{
+	int vm = yass_task_get_vm(sched, id);
+
+	return vm >= 0 && vm < n_servers ? vm : -1;
+}
+
+void server_tasks_assign(struct sched *sched, struct yass_partition *p,
+			 int n_servers, int id)
+{
+	int server = task_server(sched, n_servers, id);
+
+	if (server != -1)
+		yass_partition_assign(p, id, server);
+}
+
+/*
+ * Queue a released task on its server, by absolute deadline.
+ */
+void server_tasks_add(struct sched *sched, struct yass_partition *p,
+		      int n_servers, int id)
+{
+	if (task_server(sched, n_servers, id) != -1)
+		yass_partition_add(p, id,
+				   yass_task_get_absolute_deadline(sched, id));
+}
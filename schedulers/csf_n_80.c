@@ -3,33 +3,44 @@
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
+#include <libyass/partition.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
 #include "csf.h"
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
 
-struct yass_list *stalled_tasks;
-struct yass_list *ready_tasks;
-struct yass_list *running_tasks;
+	struct yass_list *stalled_tasks;
+	struct yass_list *ready_tasks;
+	struct yass_list *running_tasks;
 
-int **cpu_task;
+	int **cpu_task;
 
-int *server_running;
+	/* Tasks of each server, the ready and running ones by deadline */
+	struct yass_partition *server_tasks;
 
-struct server *servers;
+	int *server_running;
+
+	struct server *servers;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "CSF-N-80";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
-	int b, cpu, i, j, n, schedulable;
+	int b, cpu, i, id, j, n, schedulable;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_servers = yass_sched_get_nvms(sched);
@@ -37,50 +48,65 @@ int offline(struct sched *sched)
 
 	int period = PERIOD;
 
-	ready = yass_list_new(n_servers);
-	running = yass_list_new(n_servers);
-	stalled = yass_list_new(n_servers);
+	struct data *d = (struct data *)malloc(sizeof(struct data));
+
+	*error = 0;
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_servers);
+	d->running = yass_list_new(n_servers);
+	d->stalled = yass_list_new(n_servers);
 
-	ready_tasks = yass_list_new(n_tasks);
-	running_tasks = yass_list_new(n_tasks);
-	stalled_tasks = yass_list_new(n_tasks);
+	d->ready_tasks = yass_list_new(n_tasks);
+	d->running_tasks = yass_list_new(n_tasks);
+	d->stalled_tasks = yass_list_new(n_tasks);
 
-	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled_tasks, yass_task_get_id(sched, i));
+	d->server_tasks = yass_partition_new(sched, n_servers);
 
-	cpu_task = (int **)malloc(n_cpus * n_servers * sizeof(int));
-	server_running  = (int *)malloc(n_cpus * sizeof(int));
-	servers  = (struct server *)malloc(n_servers * sizeof(struct server));
+	for (i = 0; i < n_tasks; i++) {
+		id = yass_task_get_id(sched, i);
+
+		yass_list_add(d->stalled_tasks, id);
+		server_tasks_assign(sched, d->server_tasks, n_servers, id);
+	}
+
+	d->cpu_task = (int **)malloc(n_cpus * n_servers * sizeof(int));
+	d->server_running  = (int *)malloc(n_cpus * sizeof(int));
+	d->servers = (struct server *)malloc(n_servers * sizeof(struct server));
 
 	for (i = 0; i < n_cpus; i++) {
-		cpu_task[i] = (int *)malloc(n_servers * sizeof(int));
+		d->cpu_task[i] = (int *)malloc(n_servers * sizeof(int));
 
 		for (j = 0; j < n_servers; j++)
-			cpu_task[i][j] = -1;
+			d->cpu_task[i][j] = -1;
 
-		server_running[i] = -1;
+		d->server_running[i] = -1;
 	}
 
 	for (i = 0; i < n_servers; i++) {
 
-		servers[i].period = period;
+		d->servers[i].period = period;
 
 		for (b = INC; b < period; b += INC) {
-			servers[i].budget = b;
+			d->servers[i].budget = b;
 
-			schedulable = is_sched_edf(servers, sched, i, -0.8);
+			schedulable = is_sched_edf(d->servers, sched, i, -0.8);
 
 			if (schedulable) {
-				servers[i].budget = (int)b;
+				d->servers[i].budget = (int)b;
 				break;
 			}
 		}
 
-		servers[i].budget_init = servers[i].budget;
+		d->servers[i].budget_init = d->servers[i].budget;
 	}
 
 	for (i = 0; i < n_servers; i++)
-		yass_list_add(stalled, i);
+		yass_list_add(d->stalled, i);
 
 	/*
 	 * Assign servers to cpus. Assign servers according to
@@ -93,40 +119,60 @@ int offline(struct sched *sched)
 		/*
 		 * Find the cpu with the lowest utilization
 		 */
-		cpu = get_lowest_utilization_cpu(sched, servers, cpu_task);
+		cpu = get_lowest_utilization_cpu(sched, d->servers,
+						 d->cpu_task);
 
 		n = 0;
-		while (cpu_task[cpu][n] != -1 && n != n_servers - 1)
+		while (d->cpu_task[cpu][n] != -1 && n != n_servers - 1)
 			n++;
 
-		cpu_task[cpu][n] = i;
+		d->cpu_task[cpu][n] = i;
 	}
 
-	return 0;
+	return d;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int i, id, index, j;
 	int ttd, ttd_candidate;
-	int candidate, candidate_task, candidate_ttd;
+	int candidate, candidate_task, n_ready, n_stalled;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
-	int n_tasks = yass_sched_get_ntasks(sched);
 	int n_servers = yass_sched_get_nvms(sched);
 
-	exec_inc(sched, server_running, servers);
+	n_stalled = yass_list_n(d->stalled_tasks);
+
+	exec_inc(sched, d->server_running, d->servers);
+
+	check_terminated_tasks(sched, d->running, d->stalled,
+			       d->running_tasks, d->stalled_tasks,
+			       d->ready_tasks, d->servers, d->server_running);
 
-	check_terminated_tasks(sched, running, stalled,
-			       running_tasks, stalled_tasks,
-			       ready_tasks, servers, server_running);
+	deadline_miss(sched, d->running, d->stalled,
+		      d->running_tasks, d->stalled_tasks,
+		      d->ready_tasks, d->server_running);
 
-	deadline_miss(sched, running, stalled,
-		      running_tasks, stalled_tasks,
-		      ready_tasks, server_running);
+	/* Tasks are appended: these ones completed or missed their deadline */
+	for (i = n_stalled; i < yass_list_n(d->stalled_tasks); i++) {
+		id = yass_list_get(d->stalled_tasks, i);
 
-	check_ready_tasks(sched, stalled, ready, stalled_tasks,
-			  ready_tasks, servers);
+		if (yass_partition_present(d->server_tasks, id))
+			yass_partition_remove(d->server_tasks, id);
+	}
+
+	n_ready = yass_list_n(d->ready_tasks);
+
+	check_ready_tasks(sched, d->stalled, d->ready, d->stalled_tasks,
+			  d->ready_tasks, d->servers);
+
+	for (i = n_ready; i < yass_list_n(d->ready_tasks); i++) {
+		id = yass_list_get(d->ready_tasks, i);
+
+		server_tasks_add(sched, d->server_tasks, n_servers, id);
+	}
 
 	for (i = 0; i < n_cpus; i++) {
 		id = -1;
@@ -135,60 +181,47 @@ int schedule(struct sched *sched)
 		ttd_candidate = INT_MAX;
 
 		for (j = 0; j < n_servers; j++) {
-			index = cpu_task[i][j];
+			index = d->cpu_task[i][j];
 
 			if (index == -1)
 				continue;
 
-			ttd = server_time_to_deadline(sched, index, servers);
+			ttd = server_time_to_deadline(sched, index, d->servers);
 
-			if ((yass_list_present(running, index) ||
-			     yass_list_present(ready, index)) &&
+			if ((yass_list_present(d->running, index) ||
+			     yass_list_present(d->ready, index)) &&
 			    ttd < ttd_candidate) {
 				candidate = index;
 				ttd_candidate = ttd;
 			}
 		}
 
-		if (candidate != -1 && server_running[i] != candidate) {
-			if (server_running[i] != -1) {
-				yass_list_remove(running, server_running[i]);
-				yass_list_add(ready, server_running[i]);
+		if (candidate != -1 && d->server_running[i] != candidate) {
+			if (d->server_running[i] != -1) {
+				yass_list_remove(d->running,
+						 d->server_running[i]);
+				yass_list_add(d->ready, d->server_running[i]);
 			}
 
-			server_running[i] = candidate;
-			yass_list_add(running, candidate);
-			yass_list_remove(ready, candidate);
+			d->server_running[i] = candidate;
+			yass_list_add(d->running, candidate);
+			yass_list_remove(d->ready, candidate);
 
 		}
 
 		if (candidate == -1)
 			continue;
 
-		candidate_task = -1;
-		candidate_ttd = INT_MAX;
-
-		for (j = 0; j < n_tasks; j++) {
-			id = yass_task_get_id(sched, j);
-
-			if (yass_task_get_vm(sched, id) != candidate)
-				continue;
-
-			ttd = yass_task_time_to_deadline(sched, id);
-
-			if ((yass_list_present(running_tasks, id) ||
-			     yass_list_present(ready_tasks, id)) &&
-			    ttd < candidate_ttd) {
-				candidate_task = id;
-				candidate_ttd = ttd;
-			}
-		}
+		candidate_task = yass_partition_top(d->server_tasks,
+						    candidate);
 
 		if (candidate_task != -1 && yass_cpu_get_task(sched, i) != candidate_task) {
 			if (yass_cpu_is_active(sched, i))
-				yass_preempt_task(sched, i, running_tasks, ready_tasks);
+				yass_preempt_task(sched, i, d->running_tasks,
+						  d->ready_tasks);
 
-			yass_run_task(sched, i, candidate_task, ready_tasks, running_tasks);
+			yass_run_task(sched, i, candidate_task, d->ready_tasks,
+				      d->running_tasks);
 		}
 
 	}
@@ -196,25 +229,31 @@ int schedule(struct sched *sched)
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int i;
 
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
 
-	yass_list_free(stalled_tasks);
-	yass_list_free(ready_tasks);
-	yass_list_free(running_tasks);
+	yass_list_free(d->stalled_tasks);
+	yass_list_free(d->ready_tasks);
+	yass_list_free(d->running_tasks);
 
-	free(server_running);
-	free(servers);
+	yass_partition_free(d->server_tasks);
+
+	free(d->server_running);
+	free(d->servers);
 
 	for (i = 0; i < yass_sched_get_ncpus(sched); i++)
-		free(cpu_task[i]);
+		free(d->cpu_task[i]);
+
+	free(d->cpu_task);
 
-	free(cpu_task);
+	free(d);
 
 	return 0;
 }
@@ -1,74 +1,149 @@
+#include <stdlib.h>
+
 #include <libyass/common.h>
 #include <libyass/cpu.h>
+#include <libyass/heap.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+
+	/* Ready tasks, by absolute deadline */
+	struct yass_heap *heap;
+};
+
+static void data_free(struct data *d)
+{
+	if (d->stalled != NULL)
+		yass_list_free(d->stalled);
+	if (d->ready != NULL)
+		yass_list_free(d->ready);
+	if (d->running != NULL)
+		yass_list_free(d->running);
+	if (d->heap != NULL)
+		yass_heap_free(d->heap);
+
+	free(d);
+}
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "EDF";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i, n_tasks;
 
-	if (yass_sched_get_ncpus(sched) != 1)
-		return -YASS_ERROR_MORE_THAN_ONE_CPU;
-	else if (!yass_optimal_schedulability_test(sched))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+	struct data *d;
+
+	*error = 0;
+
+	if (yass_sched_get_ncpus(sched) != 1) {
+		*error = -YASS_ERROR_MORE_THAN_ONE_CPU;
+		return NULL;
+	} else if (!yass_optimal_schedulability_test(sched)) {
+		*error = -YASS_ERROR_NOT_SCHEDULABLE;
+		return NULL;
+	}
 
 	n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	d = (struct data *)malloc(sizeof(struct data));
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
+	d->heap = yass_heap_new(sched);
+
+	if (d->ready == NULL || d->running == NULL || d->stalled == NULL ||
+	    d->heap == NULL) {
+		data_free(d);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
 
 	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
-	return 0;
+	return d;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
-	int id, cpu = 0;
+	struct data *d = (struct data *)data;
+
+	int i, id, n_ready, running, cpu = 0;
 
 	yass_exec_inc(sched);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
 	if (yass_deadline_miss(sched))
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	/* Released tasks are added at the end of the ready list */
+	n_ready = yass_list_n(d->ready);
+
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
+
+	for (i = n_ready; i < yass_list_n(d->ready); i++) {
+		id = yass_list_get(d->ready, i);
+
+		yass_heap_add(d->heap, id,
+			      yass_task_get_absolute_deadline(sched, id));
+	}
 
-	if (yass_list_n(ready) > 0) {
-		yass_sort_list_int(sched, ready, yass_task_time_to_deadline);
+	id = yass_heap_top(d->heap);
 
-		id = yass_edf_choose_next_task(sched, ready);
+	if (id == -1)
+		return 0;
 
-		if (id != -1) {
-			if (yass_cpu_is_active(sched, cpu))
-				yass_preempt_task(sched, cpu, running, ready);
+	if (yass_cpu_is_active(sched, cpu)) {
+		running = yass_cpu_get_task(sched, cpu);
 
-			yass_run_task(sched, cpu, id, ready, running);
-		}
+		if (yass_task_time_to_deadline(sched, id) >=
+		    yass_task_time_to_deadline(sched, running))
+			return 0;
+
+		yass_preempt_task(sched, cpu, d->running, d->ready);
+
+		yass_heap_add(d->heap, running,
+			      yass_task_get_absolute_deadline(sched, running));
 	}
 
+	yass_heap_remove(d->heap, id);
+
+	yass_run_task(sched, cpu, id, d->ready, d->running);
+
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int next_event(struct sched *sched,
+	       void *data __attribute__ ((__unused__)))
+{
+	return yass_sched_get_next_event(sched);
+}
+
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	data_free((struct data *)data);
 
 	return 0;
 }
@@ -1,3 +1,5 @@
+#include <stdlib.h>
+
 #include <libyass/common.h>
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
@@ -5,47 +7,67 @@
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "FCFS";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i;
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	struct data *d = (struct data *)malloc(sizeof(struct data));
+
+	*error = 0;
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
 
 	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
-	return 0;
+	return d;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int i, id;
 	int n_cpus = yass_sched_get_ncpus(sched);
 
 	yass_exec_inc(sched);
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
 	for (i = 0; i < n_cpus; i++) {
 		if (yass_cpu_get_task(sched, i) == -1) {
-			if (yass_list_n(ready) > 0) {
-				id = yass_list_get(ready, 0);
-				yass_run_task(sched, i, id, ready, running);
+			if (yass_list_n(d->ready) > 0) {
+				id = yass_list_get(d->ready, 0);
+				yass_run_task(sched, i, id, d->ready,
+					      d->running);
 			}
 		}
 	}
@@ -53,11 +75,21 @@ int schedule(struct sched *sched)
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((unused)))
+int next_event(struct sched *sched,
+	       void *data __attribute__ ((__unused__)))
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	return yass_sched_get_next_event(sched);
+}
+
+int sched_close(struct sched *sched __attribute__ ((unused)), void *data)
+{
+	struct data *d = (struct data *)data;
+
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
+
+	free(d);
 
 	return 0;
 }
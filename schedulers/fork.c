@@ -8,134 +8,208 @@
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
-
 struct yass_task_extra {
 	int id;
 
 	int active_s;
+	int threads_done;
 
-	double exec[YASS_MAX_SEGMENTS][YASS_MAX_THREADS + 1];
+	/* Execution of each thread of each segment */
+	int n_threads;
+	double *exec;
 };
 
-struct yass_task_extra *task_extra;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+
+	struct yass_task_extra *task_extra;
+
+	/*
+	 * The thread i of a segment of task id runs as id * base + i,
+	 * base being a power of 10 greater than the number of threads.
+	 */
+	int base;
 
-int threads_done[YASS_MAX_N_TASKS];
+	/* Number of ids that can be in a list at the same time */
+	int n_ids;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "Fork-join";
 }
 
-int offline(struct sched *sched)
+static void data_free(struct sched *sched, struct data *d)
+{
+	int i;
+
+	int n_tasks = yass_sched_get_ntasks(sched);
+
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
+
+	for (i = 0; i < n_tasks && d->task_extra; i++)
+		free(d->task_extra[i].exec);
+
+	free(d->task_extra);
+	free(d);
+}
+
+void *offline(struct sched *sched, int *error)
 {
-	int i, id, j, k;
+	int i, id, n_segments;
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks * YASS_MAX_THREADS);
-	running = yass_list_new(n_tasks * YASS_MAX_THREADS);
-	stalled = yass_list_new(n_tasks * YASS_MAX_THREADS);
+	struct yass_task_extra *t;
 
-	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+	struct data *d = (struct data *)malloc(sizeof(struct data));
 
-	task_extra = (struct yass_task_extra *)
-	    malloc(n_tasks * sizeof(struct yass_task_extra));
+	*error = 0;
 
-	for (i = 0; i < n_tasks; i++) {
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->task_extra = (struct yass_task_extra *)
+	    calloc(n_tasks, sizeof(struct yass_task_extra));
+
+	d->base = 10;
+	d->n_ids = 0;
+
+	for (i = 0; i < n_tasks && d->task_extra; i++) {
 		id = yass_task_get_id(sched, i);
+		t = &d->task_extra[i];
+
+		t->id = id;
+		t->active_s = 0;
+		t->threads_done = 0;
 
-		task_extra[i].id = id;
-		task_extra[i].active_s = 0;
+		t->n_threads = yass_task_get_parallel(sched, id) + 1;
+		n_segments = yass_task_get_s(sched, id);
+
+		if (n_segments < 1 || t->n_threads < 1) {
+			d->n_ids++;
+			continue;
+		}
 
-		for (j = 0; j < YASS_MAX_SEGMENTS; j++)
-			for (k = 0; k < YASS_MAX_THREADS + 1; k++)
-				task_extra[i].exec[j][k] = 0;
+		while (d->base <= t->n_threads)
+			d->base *= 10;
 
-		threads_done[i] = 0;
+		d->n_ids += t->n_threads;
+
+		t->exec = (double *)calloc(n_segments * t->n_threads,
+					   sizeof(double));
+
+		if (t->exec == NULL)
+			break;
 	}
 
-	return 0;
+	d->ready = yass_list_new(d->n_ids);
+	d->running = yass_list_new(d->n_ids);
+	d->stalled = yass_list_new(d->n_ids);
+
+	if (d->task_extra == NULL || i < n_tasks) {
+		*error = -YASS_ERROR_MALLOC;
+		data_free(sched, d);
+		return NULL;
+	}
+
+	for (i = 0; i < n_tasks; i++)
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
+
+	return d;
 }
 
-static int fork_get_task_id(struct sched *sched, int id)
+static int fork_get_task_id(struct sched *sched, struct data *d, int id)
 {
 	if (id == -1 || yass_task_exist(sched, id))
 		return id;
 
-	return id / 10;
+	return id / d->base;
 }
 
-static int fork_get_thread(int id)
+static int fork_get_thread(struct data *d, int id)
 {
-	return id % 10;
+	return id % d->base;
 }
 
-static int fork_get_active_s(int task_index)
+static int fork_get_active_s(struct data *d, int task_index)
 {
-	return task_extra[task_index].active_s;
+	return d->task_extra[task_index].active_s;
 }
 
-static void fork_reset_active_s(int task_index)
+static void fork_reset_active_s(struct data *d, int task_index)
 {
-	task_extra[task_index].active_s = 0;
+	d->task_extra[task_index].active_s = 0;
 }
 
-static void fork_inc_active_s(int task_index)
+static void fork_inc_active_s(struct data *d, int task_index)
 {
-	task_extra[task_index].active_s++;
+	d->task_extra[task_index].active_s++;
 }
 
-static void fork_exec_inc(int task_index, int thread)
+static double *fork_exec(struct data *d, int task_index, int thread)
 {
-	int active_s = fork_get_active_s(task_index);
+	int active_s = fork_get_active_s(d, task_index);
+
+	struct yass_task_extra *t = &d->task_extra[task_index];
 
-	task_extra[task_index].exec[active_s][thread]++;
+	return &t->exec[active_s * t->n_threads + thread];
 }
 
-static int fork_get_exec(int task_index, int thread)
+static void fork_exec_inc(struct data *d, int task_index, int thread)
 {
-	int active_s = fork_get_active_s(task_index);
-
-	return task_extra[task_index].exec[active_s][thread];
+	(*fork_exec(d, task_index, thread))++;
 }
 
-static void fork_set_exec(int task_index, int thread, double exec)
+static int fork_get_exec(struct data *d, int task_index, int thread)
 {
-	int active_s = fork_get_active_s(task_index);
+	return *fork_exec(d, task_index, thread);
+}
 
-	task_extra[task_index].exec[active_s][thread] = exec;
+static void fork_set_exec(struct data *d, int task_index, int thread,
+			  double exec)
+{
+	*fork_exec(d, task_index, thread) = exec;
 }
 
-static int fork_task_is_finished(struct sched *sched, int id_corrected,
-				 int thread)
+static int fork_task_is_finished(struct sched *sched, struct data *d,
+				 int id_corrected, int thread)
 {
 	int task_index = yass_task_get_from_id(sched, id_corrected);
 
-	double exec = fork_get_exec(task_index, thread);
+	double exec = fork_get_exec(d, task_index, thread);
 
-	int active_s = fork_get_active_s(task_index);
+	int active_s = fork_get_active_s(d, task_index);
 	int s = yass_task_get_segments(sched, id_corrected)[active_s];
 
 	return exec >= s;
 }
 
 static void fork_sort_list_time_to_deadline(struct sched *sched,
+					    struct data *d,
 					    struct yass_list *q)
 {
 	int i, j, id, id2, n;
 	int min, tmp;
 
 	for (i = 0; i < yass_list_n(q); i++) {
-		id = fork_get_task_id(sched, yass_list_get(q, i));
+		id = fork_get_task_id(sched, d, yass_list_get(q, i));
 		min = yass_task_time_to_deadline(sched, id);
 
 		n = -1;
 
 		for (j = i + 1; j < yass_list_n(q); j++) {
-			id2 = fork_get_task_id(sched, yass_list_get(q, j));
+			id2 = fork_get_task_id(sched, d, yass_list_get(q, j));
 
 			if (id2 != -1 &&
 			    ((yass_task_time_to_deadline(sched, id2) < min) ||
@@ -155,38 +229,43 @@ static void fork_sort_list_time_to_deadline(struct sched *sched,
 	}
 }
 
-static void handle_next_tasks(struct sched *sched, int task_index, int id)
+static void handle_next_tasks(struct sched *sched, struct data *d,
+			      int task_index, int id)
 {
 	int i;
 
-	int active_s = fork_get_active_s(task_index);
+	int active_s = fork_get_active_s(d, task_index);
 	int parallel = yass_task_get_parallel(sched, id);
 
+	struct yass_task_extra *extra = &d->task_extra[task_index];
+
 	if (active_s < yass_task_get_s(sched, id) - 1) {
 
 		if (active_s % 2 == 1) {
-			threads_done[task_index]++;
+			extra->threads_done++;
 
-			if (threads_done[task_index] == parallel) {
-				threads_done[task_index] = 0;
-				yass_list_add(ready, id * 10);
-				fork_inc_active_s(task_index);
+			if (extra->threads_done == parallel) {
+				extra->threads_done = 0;
+				yass_list_add(d->ready, id * d->base);
+				fork_inc_active_s(d, task_index);
 			}
 		} else {
 			for (i = 0; i < yass_task_get_parallel(sched, id); i++)
-				yass_list_add(ready, id * 10 + i + 1);
+				yass_list_add(d->ready, id * d->base + i + 1);
 
-			fork_inc_active_s(task_index);
+			fork_inc_active_s(d, task_index);
 		}
 
 	} else {
-		yass_list_add(stalled, id);
-		fork_reset_active_s(task_index);
+		yass_list_add(d->stalled, id);
+		fork_reset_active_s(d, task_index);
 	}
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int cpu, i, id, id_corrected, j;
 	int task_index, thread;
 
@@ -194,8 +273,7 @@ int schedule(struct sched *sched)
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	struct yass_list *candidate =
-	    yass_list_new(YASS_MAX_N_TASKS * YASS_MAX_SEGMENTS);
+	struct yass_list *candidate = yass_list_new_scratch(sched, d->n_ids);
 
 	/*
 	 * Incrémenter l'exécution de toutes les tâches en cours
@@ -206,17 +284,17 @@ int schedule(struct sched *sched)
 			continue;
 
 		id = yass_cpu_get_task(sched, i);
-		id_corrected = fork_get_task_id(sched, id);
+		id_corrected = fork_get_task_id(sched, d, id);
 
 		yass_warn(yass_task_exist(sched, id_corrected));
 
 		if (yass_task_get_s(sched, id_corrected) == -1) {
 			yass_task_exec_inc(sched, id_corrected, 1);
 		} else {
-			thread = fork_get_thread(id);
+			thread = fork_get_thread(d, id);
 			task_index = yass_task_get_from_id(sched, id_corrected);
 
-			fork_exec_inc(task_index, thread);
+			fork_exec_inc(d, task_index, thread);
 		}
 	}
 
@@ -229,21 +307,23 @@ int schedule(struct sched *sched)
 			continue;
 
 		id = yass_cpu_get_task(sched, i);
-		id_corrected = fork_get_task_id(sched, id);
-		thread = fork_get_thread(id);
+		id_corrected = fork_get_task_id(sched, d, id);
+		thread = fork_get_thread(d, id);
 
 		if (yass_task_get_s(sched, id_corrected) == -1 &&
 		    yass_task_get_exec(sched, id) >= yass_task_get_wcet(sched,
 									id)) {
 
-			yass_terminate_task(sched, i, id, running, stalled);
+			yass_terminate_task(sched, i, id, d->running,
+					    d->stalled);
 
-		} else if (yass_task_exist(sched, id / 10) &&
-			   fork_task_is_finished(sched, id_corrected, thread)) {
+		} else if (yass_task_exist(sched, id / d->base) &&
+			   fork_task_is_finished(sched, d, id_corrected,
+						 thread)) {
 
 			task_index = yass_task_get_from_id(sched, id_corrected);
 
-			yass_list_remove(running, id);
+			yass_list_remove(d->running, id);
 
 			yass_log_sched(sched, YASS_EVENT_TASK_TERMINATE,
 				       yass_sched_get_index(sched),
@@ -251,9 +331,9 @@ int schedule(struct sched *sched)
 
 			yass_cpu_remove_task(sched, i);
 
-			fork_set_exec(task_index, thread, 0);
+			fork_set_exec(d, task_index, thread, 0);
 
-			handle_next_tasks(sched, task_index, id_corrected);
+			handle_next_tasks(sched, d, task_index, id_corrected);
 		}
 	}
 
@@ -263,20 +343,20 @@ int schedule(struct sched *sched)
 	 *
 	 * Pour les tâches fork-join, le premier segment est forcément
 	 * non parallèle, donc il peut être placé dans la list ready
-	 * (en n'oubliant pas de multiplier son id par 10)
+	 * (en n'oubliant pas de multiplier son id par base)
 	 */
 	for (i = 0; i < n_tasks; i++) {
 		id = yass_task_get_id(sched, i);
 
 		if (tick % yass_task_get_period(sched, id) == 0 &&
-		    yass_list_present(stalled, id)) {
+		    yass_list_present(d->stalled, id)) {
 
-			yass_list_remove(stalled, id);
+			yass_list_remove(d->stalled, id);
 
 			if (yass_task_get_s(sched, id) == -1)
-				yass_list_add(ready, id);
+				yass_list_add(d->ready, id);
 			else
-				yass_list_add(ready, id * 10);
+				yass_list_add(d->ready, id * d->base);
 		}
 	}
 
@@ -287,12 +367,12 @@ int schedule(struct sched *sched)
 	 * running. De plus, certaines ont plusieurs threads donc ont
 	 * besoin de plusieurs cpus.
 	 */
-	for (i = 0; i < yass_list_n(running); i++)
-		yass_list_add(candidate, yass_list_get(running, i));
-	for (i = 0; i < yass_list_n(ready); i++)
-		yass_list_add(candidate, yass_list_get(ready, i));
+	for (i = 0; i < yass_list_n(d->running); i++)
+		yass_list_add(candidate, yass_list_get(d->running, i));
+	for (i = 0; i < yass_list_n(d->ready); i++)
+		yass_list_add(candidate, yass_list_get(d->ready, i));
 
-	fork_sort_list_time_to_deadline(sched, candidate);
+	fork_sort_list_time_to_deadline(sched, d, candidate);
 
 	/*
 	 * Parmi toutes les tâches candidates, sélectionne celles qui
@@ -315,21 +395,22 @@ int schedule(struct sched *sched)
 		id = yass_task_get_id(sched, i);
 
 		if (yass_task_get_s(sched, id) == -1 &&
-		    yass_list_present(running, id) &&
+		    yass_list_present(d->running, id) &&
 		    !yass_list_present(candidate, id)) {
 
 			cpu = yass_task_get_cpu(sched, id);
-			yass_preempt_task(sched, cpu, running, ready);
+			yass_preempt_task(sched, cpu, d->running, d->ready);
 
 		} else if (yass_task_get_s(sched, id) > 0) {
 
 			for (j = 0; j < yass_task_get_parallel(sched, id) + 1;
 			     j++) {
 
-				id_corrected = id * 10 + j;
+				id_corrected = id * d->base + j;
 				cpu = yass_task_get_cpu(sched, id_corrected);
 
-				if (yass_list_present(running, id_corrected) &&
+				if (yass_list_present(d->running,
+						      id_corrected) &&
 				    !yass_list_present(candidate,
 						       id_corrected)) {
 
@@ -339,8 +420,9 @@ int schedule(struct sched *sched)
 						       (sched), id, tick, cpu,
 						       0);
 
-					yass_list_remove(running, id_corrected);
-					yass_list_add(ready, id_corrected);
+					yass_list_remove(d->running,
+							 id_corrected);
+					yass_list_add(d->ready, id_corrected);
 
 					yass_cpu_remove_task(sched, cpu);
 				}
@@ -361,7 +443,7 @@ int schedule(struct sched *sched)
 
 	for (i = 0; i < n_cpus; i++) {
 		id = yass_list_get(candidate, 0);
-		id_corrected = fork_get_task_id(sched, id);
+		id_corrected = fork_get_task_id(sched, d, id);
 
 		if (!yass_cpu_is_active(sched, i) && id != -1) {
 
@@ -371,8 +453,8 @@ int schedule(struct sched *sched)
 				       yass_sched_get_index(sched),
 				       id_corrected, tick, i, 0);
 
-			yass_list_remove(ready, id);
-			yass_list_add(running, id);
+			yass_list_remove(d->ready, id);
+			yass_list_add(d->running, id);
 
 			yass_cpu_set_task(sched, i, id);
 
@@ -382,16 +464,12 @@ int schedule(struct sched *sched)
 
 	yass_warn(yass_list_n(candidate) == 0);
 
-	yass_list_free(candidate);
-
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched, void *data)
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	data_free(sched, (struct data *)data);
 
 	return 0;
 }
@@ -1,5 +1,8 @@
+#include <stdlib.h>
+
 #include <libyass/common.h>
 #include <libyass/cpu.h>
+#include <libyass/heap.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
 #include <libyass/log.h>
@@ -18,39 +21,88 @@
  * Par rapport à global, cela rajoute quelques tests en plus.
  */
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+
+	/* Tâches prêtes ou en cours d'exécution, par échéance */
+	struct yass_heap *active;
+
+	struct yass_list *candidate;
+};
+
+static void data_free(struct data *d)
+{
+	if (d->stalled != NULL)
+		yass_list_free(d->stalled);
+	if (d->ready != NULL)
+		yass_list_free(d->ready);
+	if (d->running != NULL)
+		yass_list_free(d->running);
+	if (d->candidate != NULL)
+		yass_list_free(d->candidate);
+	if (d->active != NULL)
+		yass_heap_free(d->active);
+
+	free(d);
+}
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "Gang EDF";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i;
 
-	ready = yass_list_new(yass_sched_get_ntasks(sched));
-	running = yass_list_new(yass_sched_get_ntasks(sched));
-	stalled = yass_list_new(yass_sched_get_ntasks(sched));
+	struct data *d = (struct data *)malloc(sizeof(struct data));
+
+	*error = 0;
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(yass_sched_get_ntasks(sched));
+	d->running = yass_list_new(yass_sched_get_ntasks(sched));
+	d->stalled = yass_list_new(yass_sched_get_ntasks(sched));
+	d->candidate = yass_list_new(yass_sched_get_ntasks(sched));
+	d->active = yass_heap_new(sched);
+
+	if (d->ready == NULL || d->running == NULL || d->stalled == NULL ||
+	    d->candidate == NULL || d->active == NULL) {
+		data_free(d);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
 
 	for (i = 0; i < yass_sched_get_ntasks(sched); i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
-	return 0;
+	return d;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
-	int c, i, id, remaining_threads;
+	struct data *d = (struct data *)data;
+
+	int c, free_cpus, i, id, n_ready, remaining_threads;
 	int tick = yass_sched_get_tick(sched);
 	int n_cpus = yass_sched_get_ncpus(sched);
+	int n_stalled = yass_list_n(d->stalled);
 
-	struct yass_list *candidate = yass_list_new(YASS_MAX_N_TASKS);
+	struct yass_list *candidate = d->candidate;
 
-	for (i = 0; i < yass_list_n(running); i++) {
-		id = yass_list_get(running, i);
+	for (i = 0; i < yass_list_n(d->running); i++) {
+		id = yass_list_get(d->running, i);
 		c = yass_task_get_cpu(sched, id);
 
 		yass_task_exec_inc(sched, id, yass_cpu_get_speed(sched, c));
@@ -68,10 +120,10 @@ int schedule(struct sched *sched)
 									id)) {
 			yass_task_set_exec(sched, id, 1000000);
 
-			if (yass_list_present(running, id))
-				yass_list_remove(running, id);
-			if (!yass_list_present(stalled, id))
-				yass_list_add(stalled, id);
+			if (yass_list_present(d->running, id))
+				yass_list_remove(d->running, id);
+			if (!yass_list_present(d->stalled, id))
+				yass_list_add(d->stalled, id);
 
 			yass_log_sched(sched, YASS_EVENT_TASK_TERMINATE,
 				       yass_sched_get_index(sched),
@@ -88,40 +140,42 @@ int schedule(struct sched *sched)
 			yass_task_set_exec(sched, id, 0);
 	}
 
-	yass_check_ready_tasks(sched, stalled, ready);
-
 	/*
-	 * Place dans la list candidate toutes les tâches pouvant
-	 * potentiellement être ordonnancées. Ce sont les tâches des
-	 * lists running et ready.
+	 * Les tâches ne sont ajoutées qu'à la fin des lists : les
+	 * tâches terminées sont à la fin de la list stalled, les
+	 * tâches activées à la fin de la list ready.
 	 */
-	for (i = 0; i < n_cpus; i++) {
-		id = yass_cpu_get_task(sched, i);
+	for (i = n_stalled; i < yass_list_n(d->stalled); i++) {
+		id = yass_list_get(d->stalled, i);
 
-		if (id != -1 && !yass_list_present(candidate, id))
-			yass_list_add(candidate, id);
-	}
-	for (i = 0; i < yass_list_n(ready); i++) {
-		if (yass_list_get(ready, i) != -1)
-			yass_list_add(candidate, yass_list_get(ready, i));
+		if (yass_heap_present(d->active, id))
+			yass_heap_remove(d->active, id);
 	}
 
-	yass_sort_list_int(sched, candidate, yass_task_time_to_deadline);
+	n_ready = yass_list_n(d->ready);
+
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
+
+	for (i = n_ready; i < yass_list_n(d->ready); i++) {
+		id = yass_list_get(d->ready, i);
+
+		yass_heap_add(d->active, id,
+			      yass_task_get_absolute_deadline(sched, id));
+	}
 
 	/*
-	 * Il n'y qu'un nombre limité de cpu. Supprime les tâches qui
-	 * ne seront pas exécutées de la list candidate.
+	 * Place dans la list candidate, par ordre d'échéance, les
+	 * tâches prêtes ou en cours d'exécution dont tous les threads
+	 * peuvent être exécutés sur les cpu restants.
 	 */
-	int free_cpus = n_cpus;
+	free_cpus = n_cpus;
 
-	for (i = 0; i < yass_list_n(candidate); i++) {
-		id = yass_list_get(candidate, i);
+	yass_heap_iter_init(d->active);
 
+	while (free_cpus > 0 && (id = yass_heap_iter_next(d->active)) != -1) {
 		if (yass_task_get_threads(sched, id) <= free_cpus) {
 			free_cpus -= yass_task_get_threads(sched, id);
-		} else {
-			yass_list_remove(candidate, id);
-			i--;
+			yass_list_add(candidate, id);
 		}
 	}
 
@@ -132,15 +186,15 @@ int schedule(struct sched *sched)
 	for (i = 0; i < n_cpus; i++) {
 		id = yass_cpu_get_task(sched, i);
 
-		if (!yass_list_present(candidate, id)) {
+		if (id != -1 && !yass_list_present(candidate, id)) {
 			yass_log_sched(sched, YASS_EVENT_TASK_TERMINATE,
 				       yass_sched_get_index(sched),
 				       id, tick, i, 0);
 
-			if (yass_list_present(running, id))
-				yass_list_remove(running, id);
-			if (!yass_list_present(ready, id))
-				yass_list_add(ready, id);
+			if (yass_list_present(d->running, id))
+				yass_list_remove(d->running, id);
+			if (!yass_list_present(d->ready, id))
+				yass_list_add(d->ready, id);
 
 			yass_cpu_set_task(sched, i, -1);
 		}
@@ -176,8 +230,8 @@ int schedule(struct sched *sched)
 			if (remaining_threads == 0) {
 				yass_list_remove(candidate, id);
 
-				yass_list_remove(ready, id);
-				yass_list_add(running, id);
+				yass_list_remove(d->ready, id);
+				yass_list_add(d->running, id);
 
 				if (yass_list_n(candidate) == 0)
 					goto out;
@@ -197,20 +251,22 @@ int schedule(struct sched *sched)
 	 * et toutes les tâches dans la list running doivent être
 	 * actives.
 	 */
-	for (i = 0; i < n_cpus; i++)
-		yass_warn(yass_list_present
-			  (running, yass_cpu_get_task(sched, i)));
+	for (i = 0; i < n_cpus; i++) {
+		id = yass_cpu_get_task(sched, i);
+
+		if (id != -1)
+			yass_warn(yass_list_present(d->running, id));
+	}
 
-	yass_list_free(candidate);
+	while (yass_list_n(candidate) > 0)
+		yass_list_remove(candidate, yass_list_get(candidate, 0));
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	data_free((struct data *)data);
 
 	return 0;
 }
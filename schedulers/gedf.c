@@ -1,36 +1,89 @@
+#include <stdlib.h>
+
 #include <libyass/common.h>
 #include <libyass/cpu.h>
+#include <libyass/heap.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+
+	/* Ready and running tasks, by absolute deadline */
+	struct yass_heap *active;
+
+	struct yass_list *candidate;
+	int *first;
+};
+
+static void data_free(struct data *d)
+{
+	if (d->stalled != NULL)
+		yass_list_free(d->stalled);
+	if (d->ready != NULL)
+		yass_list_free(d->ready);
+	if (d->running != NULL)
+		yass_list_free(d->running);
+	if (d->candidate != NULL)
+		yass_list_free(d->candidate);
+	if (d->active != NULL)
+		yass_heap_free(d->active);
+
+	free(d->first);
+	free(d);
+}
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "Global EDF";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i;
 
+	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	struct data *d = (struct data *)malloc(sizeof(struct data));
+
+	*error = 0;
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
+	d->candidate = yass_list_new(n_cpus);
+	d->active = yass_heap_new(sched);
+	d->first = (int *)malloc(n_cpus * sizeof(int));
+
+	if (d->ready == NULL || d->running == NULL || d->stalled == NULL ||
+	    d->candidate == NULL || d->active == NULL || d->first == NULL) {
+		data_free(d);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
 
 	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
-	return 0;
+	return d;
 }
 
-static void deadline_miss(struct sched *sched)
+static void deadline_miss(struct sched *sched, struct data *d)
 {
 	int cpu, i, id, exec, period;
 
@@ -47,84 +100,95 @@ static void deadline_miss(struct sched *sched)
 			yass_sched_inc_deadline_misses(sched);
 
 			if (cpu != -1) {
-				yass_terminate_task(sched, cpu, id, running, stalled);
+				yass_terminate_task(sched, cpu, id, d->running,
+						    d->stalled);
 			} else {
 				yass_task_set_exec(sched, id, 0);
 
-				yass_list_remove(ready, id);
-				yass_list_add(stalled, id);
+				yass_list_remove(d->ready, id);
+				yass_list_add(d->stalled, id);
 			}
 
-		} else if (tick % period == 0 && !yass_list_present(stalled, id)) {
-			if (yass_list_present(ready, id))
-				yass_list_remove(ready, id);
-			if (yass_list_present(running, id))
-				yass_list_remove(running, id);
+		} else if (tick % period == 0 && !yass_list_present(d->stalled,
+								    id)) {
+			if (yass_list_present(d->ready, id))
+				yass_list_remove(d->ready, id);
+			if (yass_list_present(d->running, id))
+				yass_list_remove(d->running, id);
 
-			yass_list_add(stalled, id);
+			yass_list_add(d->stalled, id);
 		}
 	}
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
-	int cpu, i, id;
+	struct data *d = (struct data *)data;
+
+	int i, id, n;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int online = yass_sched_get_online(sched);
+	int n_stalled = yass_list_n(d->stalled);
+	int n_ready;
 
-	struct yass_list *candidate = yass_list_new(YASS_MAX_N_TASKS);
+	struct yass_list *candidate = d->candidate;
 
 	yass_exec_inc(sched);
 
 	if (online)
-		yass_check_terminated_tasks(sched, running, stalled, YASS_ONLINE);
+		yass_check_terminated_tasks(sched, d->running, d->stalled,
+					    YASS_ONLINE);
 	else
-		yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+		yass_check_terminated_tasks(sched, d->running, d->stalled,
+					    YASS_OFFLINE);
 
-	deadline_miss(sched);
-
-	yass_check_ready_tasks(sched, stalled, ready);
+	deadline_miss(sched, d);
 
 	/*
-	 * Add in the candidate list all tasks ready to be scheduled,
-	 * i.e. tasks from the ready and running list.
+	 * Tasks are only added at the end of the lists: the tasks
+	 * which completed or missed their deadline are at the end of
+	 * the stalled list, the released ones at the end of the ready
+	 * list.
 	 */
-	for (i = 0; i < n_cpus; i++) {
-		if (yass_cpu_is_active(sched, i))
-			yass_list_add(candidate, yass_cpu_get_task(sched, i));
-	}
-	for (i = 0; i < yass_list_n(ready); i++) {
-		if (yass_list_get(ready, i) != -1)
-			yass_list_add(candidate, yass_list_get(ready, i));
+	for (i = n_stalled; i < yass_list_n(d->stalled); i++) {
+		id = yass_list_get(d->stalled, i);
+
+		if (yass_heap_present(d->active, id))
+			yass_heap_remove(d->active, id);
 	}
 
-	yass_sort_list_int(sched, candidate, yass_task_time_to_deadline);
+	n_ready = yass_list_n(d->ready);
+
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
+
+	for (i = n_ready; i < yass_list_n(d->ready); i++) {
+		id = yass_list_get(d->ready, i);
+
+		yass_heap_add(d->active, id,
+			      yass_task_get_absolute_deadline(sched, id));
+	}
 
 	/*
-	 * Remove from the candidate list tasks which are not going to
-	 * be scheduled.
+	 * The tasks to be scheduled are the n_cpus ready or running
+	 * tasks with the earliest deadlines.
 	 */
-	while (yass_list_n(candidate) > n_cpus) {
-		for (i = n_cpus; i < n_cpus + yass_list_n(candidate) - 1; i++) {
-			yass_list_remove(candidate,
-					 yass_list_get(candidate, i));
-			break;
-		}
-	}
-	yass_warn(n_cpus >= yass_list_n(candidate));
+	n = yass_heap_first(d->active, n_cpus, d->first);
+
+	for (i = 0; i < n; i++)
+		yass_list_add(candidate, d->first[i]);
 
 	/*
-	 * Preempt running tasks
+	 * Preempt running tasks, in the order of the tasks so that the
+	 * TERMINATE events of a tick keep that order
 	 */
 	for (i = 0; i < yass_sched_get_ntasks(sched); i++) {
 		id = yass_task_get_id(sched, i);
-		cpu = yass_task_get_cpu(sched, id);
 
-		if (yass_list_present(running, id)
-		    && !yass_list_present(candidate, id)) {
-			yass_preempt_task(sched, cpu, running, ready);
-		}
+		if (yass_list_present(d->running, id)
+		    && !yass_list_present(candidate, id))
+			yass_preempt_task(sched, yass_task_get_cpu(sched, id),
+					  d->running, d->ready);
 	}
 
 	/*
@@ -145,7 +209,7 @@ int schedule(struct sched *sched)
 		id = yass_list_get(candidate, 0);
 
 		if (!yass_cpu_is_active(sched, i) && id != -1) {
-			yass_run_task(sched, i, id, ready, running);
+			yass_run_task(sched, i, id, d->ready, d->running);
 
 			yass_list_remove(candidate, id);
 		}
@@ -153,16 +217,21 @@ int schedule(struct sched *sched)
 
 	yass_warn(yass_list_n(candidate) == 0);
 
-	yass_list_free(candidate);
+	while (yass_list_n(candidate) > 0)
+		yass_list_remove(candidate, yass_list_get(candidate, 0));
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int next_event(struct sched *sched,
+	       void *data __attribute__ ((__unused__)))
+{
+	return yass_sched_get_next_event(sched);
+}
+
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	data_free((struct data *)data);
 
 	return 0;
 }
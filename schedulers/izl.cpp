@@ -4,6 +4,7 @@
 
 #include <libyass/common.h>
 #include <libyass/cpu.h>
+#include <libyass/exec_time.h>
 #include <libyass/log.h>
 #include <libyass/list.h>
 #include <libyass/helpers.h>
@@ -133,7 +134,8 @@ static int izl_run(struct yass *yass, double **w_izl)
 	return r;
 }
 
-static int compute_ctx(struct sched *sched, double **w_izl, int **exec_time)
+static int compute_ctx(struct sched *sched, double **w_izl,
+		       struct yass_exec_time *exec_time)
 {
 	int ctx = 0, i, r;
 
@@ -179,10 +181,13 @@ static int choose(struct sched *sched, double ***w_izl)
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	int **exec_time;
+	struct yass_exec_time *exec_time;
 
-	exec_time = yass_tasks_generate_exec(yass_sched_get_tasks(sched),
-					     n_tasks);
+	/*
+	 * The simulations are offline, the execution times are not
+	 * used.
+	 */
+	exec_time = yass_exec_time_new(yass_sched_get_tasks(sched), n_tasks, 0);
 
 	for (i = 0; i < N_IZL; i++) {
 		ctx = compute_ctx(sched, w_izl[i], exec_time);
@@ -196,7 +201,7 @@ static int choose(struct sched *sched, double ***w_izl)
 		}
 	}
 
-	yass_task_free_exec_time(exec_time, n_tasks);
+	yass_exec_time_free(exec_time);
 
 	return r;
 }
@@ -1,75 +1,170 @@
+#include <limits.h>
+#include <stdlib.h>
+
 #include <libyass/common.h>
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
+#include <libyass/kinetic.h>
 #include <libyass/list.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+
+	/*
+	 * Laxity of the ready and running tasks. The laxity of a
+	 * waiting task decreases by one at each tick, the one of a task
+	 * running at speed s changes by s - 1.
+	 */
+	struct yass_kinetic *laxity;
+
+	struct yass_list *candidate;
+	int *first;
+};
+
+static void data_free(struct data *d)
+{
+	if (d->stalled != NULL)
+		yass_list_free(d->stalled);
+	if (d->ready != NULL)
+		yass_list_free(d->ready);
+	if (d->running != NULL)
+		yass_list_free(d->running);
+	if (d->candidate != NULL)
+		yass_list_free(d->candidate);
+	if (d->laxity != NULL)
+		yass_kinetic_free(d->laxity);
+
+	free(d->first);
+	free(d);
+}
+
+/*
+ * Laxity at tick t of a task which does not run: absolute deadline - t
+ * - (wcet - exec).
+ */
+static void set_waiting(struct sched *sched, struct data *d, int id)
+{
+	double a = yass_task_get_absolute_deadline(sched, id) -
+	    yass_task_get_wcet(sched, id) + yass_task_get_exec(sched, id);
+
+	if (yass_kinetic_present(d->laxity, id))
+		yass_kinetic_update(d->laxity, id, a, -1);
+	else
+		yass_kinetic_add(d->laxity, id, a, -1);
+}
+
+/*
+ * Task starting to run on cpu at the current tick: its execution time
+ * increases by the speed of cpu from the next tick on.
+ */
+static void set_running(struct sched *sched, struct data *d, int id, int cpu)
+{
+	int tick = yass_sched_get_tick(sched);
+	double speed = yass_cpu_get_speed(sched, cpu);
+
+	double a = yass_task_get_absolute_deadline(sched, id) -
+	    yass_task_get_wcet(sched, id) + yass_task_get_exec(sched, id) -
+	    speed * tick;
+
+	yass_kinetic_update(d->laxity, id, a, speed - 1);
+}
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "LLF";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i;
 
+	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	struct data *d = (struct data *)malloc(sizeof(struct data));
+
+	*error = 0;
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
+	d->candidate = yass_list_new(n_tasks);
+	d->laxity = yass_kinetic_new(sched);
+	d->first = (int *)malloc((n_cpus + 1) * sizeof(int));
+
+	if (d->ready == NULL || d->running == NULL || d->stalled == NULL ||
+	    d->candidate == NULL || d->laxity == NULL || d->first == NULL) {
+		data_free(d);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
 
 	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
-	return 0;
+	return d;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
-	int i, id;
+	struct data *d = (struct data *)data;
+
+	int i, id, n;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
+	int n_stalled = yass_list_n(d->stalled);
+	int n_ready;
 
-	struct yass_list *candidate = yass_list_new(YASS_MAX_N_TASKS);
+	struct yass_list *candidate = d->candidate;
 
 	yass_exec_inc(sched);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_kinetic_advance(d->laxity, yass_sched_get_tick(sched));
+
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
 	if (yass_deadline_miss(sched))
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	/* Completed tasks are added at the end of the stalled list */
+	for (i = n_stalled; i < yass_list_n(d->stalled); i++)
+		yass_kinetic_remove(d->laxity, yass_list_get(d->stalled, i));
 
-	for (i = 0; i < yass_list_n(running); i++)
-		yass_list_add(candidate, yass_list_get(running, i));
-	for (i = 0; i < yass_list_n(ready); i++)
-		yass_list_add(candidate, yass_list_get(ready, i));
+	/* Released tasks are added at the end of the ready list */
+	n_ready = yass_list_n(d->ready);
 
-	yass_sort_list_double(sched, candidate, yass_task_get_laxity);
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
 
-	while (yass_list_n(candidate) > n_cpus) {
-		for (i = n_cpus; i < n_cpus + yass_list_n(candidate) - 1; i++) {
-			id = yass_list_get(candidate, i);
-			yass_list_remove(candidate, id);
-			break;
-		}
-	}
+	for (i = n_ready; i < yass_list_n(d->ready); i++)
+		set_waiting(sched, d, yass_list_get(d->ready, i));
 
-	if (n_cpus < yass_list_n(candidate))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+	n = yass_kinetic_first(d->laxity, n_cpus, d->first);
+
+	for (i = 0; i < n; i++)
+		yass_list_add(candidate, d->first[i]);
 
 	for (i = 0; i < n_cpus; i++) {
 		id = yass_cpu_get_task(sched, i);
 
-		if (id != -1 && !yass_list_present(candidate, id))
-			yass_preempt_task(sched, i, running, ready);
+		if (id != -1 && !yass_list_present(candidate, id)) {
+			yass_preempt_task(sched, i, d->running, d->ready);
+			set_waiting(sched, d, id);
+		}
 
 		if (id != -1 && yass_list_present(candidate, id))
 			yass_list_remove(candidate, id);
@@ -79,7 +174,8 @@ int schedule(struct sched *sched)
 		id = yass_list_get(candidate, 0);
 
 		if (!yass_cpu_is_active(sched, i) && id != -1) {
-			yass_run_task(sched, i, id, ready, running);
+			yass_run_task(sched, i, id, d->ready, d->running);
+			set_running(sched, d, id, i);
 
 			yass_list_remove(candidate, id);
 		}
@@ -88,16 +184,55 @@ int schedule(struct sched *sched)
 	if (yass_list_n(candidate) != 0)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
-	yass_list_free(candidate);
-
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+/*
+ * Besides releases, deadlines and completions, the schedule changes
+ * when the waiting task with the lowest laxity comes before a running
+ * task. Waiting tasks keep their order, as their laxities decrease at
+ * the same rate.
+ */
+int next_event(struct sched *sched, void *data)
+{
+	struct data *d = (struct data *)data;
+
+	int i, id, n, next, waiting = -1;
+
+	int n_cpus = yass_sched_get_ncpus(sched);
+	int tick = yass_sched_get_tick(sched);
+	int event = yass_sched_get_next_event(sched);
+
+	n = yass_kinetic_first(d->laxity, n_cpus + 1, d->first);
+
+	for (i = 0; i < n; i++) {
+		if (!yass_list_present(d->running, d->first[i])) {
+			waiting = d->first[i];
+			break;
+		}
+	}
+
+	if (waiting == -1)
+		return event;
+
+	for (i = 0; i < n_cpus; i++) {
+		id = yass_cpu_get_task(sched, i);
+
+		if (id == -1)
+			continue;
+
+		next = yass_kinetic_crossing(d->laxity, waiting, id, tick);
+
+		if (next < event)
+			event = next;
+	}
+
+	return event;
+}
+
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	data_free((struct data *)data);
 
 	return 0;
 }
@@ -699,7 +699,8 @@ int lpdpm_schedule(struct sched *sched, double *rem, double **w,
 
 	double rem_ticks = yass_sched_get_next_boundary(sched, tick) - tick;
 
-	int *old_cpu = (int *)malloc(get_ntasks(sched) * sizeof(int));
+	int *old_cpu = (int *)yass_sched_alloc(sched, get_ntasks(sched) *
+						  sizeof(int));
 
 	while (time < 1 - EPSILON) {
 
@@ -794,7 +795,5 @@ int lpdpm_schedule(struct sched *sched, double *rem, double **w,
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 	}
 
-	free(old_cpu);
-
 	return 0;
 }
@@ -5,14 +5,23 @@
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
+#include <libyass/partition.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
 
-int **cpu_task;
+	/* Tasks of each cpu, the ready and running ones by deadline */
+	struct yass_partition *part;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
@@ -20,118 +29,94 @@ const char *name()
 }
 
 __attribute__ ((__unused__))
-static int is_schedulable(struct sched *sched)
+static int is_schedulable(struct sched *sched, struct data *d)
 {
-	int i, id, index, j;
+	int i;
 
-	unsigned long long e;
 	unsigned long long h = yass_sched_get_hyperperiod(sched);
 
 	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
-		e = 0;
-
-		for (j = 0; j < yass_sched_get_ntasks(sched); j++) {
-			index = cpu_task[i][j];
-
-			if (index != -1) {
-				id = yass_task_get_id(sched, index);
-				e += yass_task_get_exec_hyperperiod(sched, id);
-			}
-		}
-
-		if (e > h)
+		if (yass_partition_get_load(d->part, i) > h)
 			return 0;
 	}
 
 	return 1;
 }
 
-static int get_lowest_utilization_cpu(struct sched *sched)
+static void data_free(struct data *d)
 {
-	int cpu, i, id, n;
-	unsigned long long e, e_min;
-
-	int n_tasks = yass_sched_get_ntasks(sched);
-
-	e_min = ULLONG_MAX;
-	cpu = -1;
-
-	for (i = 0; i < yass_sched_get_ncpus(sched); i++) {
-		n = 0;
-		e = 0;
-
-		while (cpu_task[i][n] != -1 && n != n_tasks - 1) {
-			id = yass_task_get_id(sched, cpu_task[i][n]);
-			e += yass_task_get_exec_hyperperiod(sched, id);
-
-			n++;
-		}
-
-		if (e < e_min) {
-			e_min = e;
-			cpu = i;
-		}
-	}
-
-	return cpu;
+	if (d->stalled != NULL)
+		yass_list_free(d->stalled);
+	if (d->ready != NULL)
+		yass_list_free(d->ready);
+	if (d->running != NULL)
+		yass_list_free(d->running);
+	if (d->part != NULL)
+		yass_partition_free(d->part);
+
+	free(d);
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
-	int i, j;
-	int cpu, n;
+	int cpu, i, id;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	struct data *d = (struct data *)malloc(sizeof(struct data));
 
-	cpu_task = (int **)malloc(n_cpus * n_tasks * sizeof(int));
+	*error = 0;
 
-	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
 
-	for (i = 0; i < n_cpus; i++) {
-		cpu_task[i] = (int *)malloc(n_tasks * sizeof(int));
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
+	d->part = yass_partition_new(sched, n_cpus);
 
-		for (j = 0; j < n_tasks; j++)
-			cpu_task[i][j] = -1;
+	if (d->ready == NULL || d->running == NULL || d->stalled == NULL ||
+	    d->part == NULL) {
+		data_free(d);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
 	}
 
+	for (i = 0; i < n_tasks; i++)
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
+
 	/*
 	 * Assign tasks to cpus. Assign tasks according to utilization
 	 * in a non-increasing order and assign each task to the cpu
 	 * with the lowest utilization.
 	 */
 
-	yass_sort_list_int(sched, stalled, yass_task_time_to_deadline);
+	yass_sort_list_int(sched, d->stalled, yass_task_time_to_deadline);
 
 	for (i = n_tasks - 1; i >= 0; i--) {
+		id = yass_task_get_id(sched, i);
 
 		/*
 		 * Find the cpu with the lowest utilization
 		 */
-		cpu = get_lowest_utilization_cpu(sched);
+		cpu = yass_partition_worst_fit(d->part);
 
 		/* if (cpu == -1) */
 		/* 	return -YASS_ERROR_NOT_SCHEDULABLE; */
 
-		n = 0;
-		while (cpu_task[cpu][n] != -1 && n != n_tasks - 1)
-			n++;
-
-		cpu_task[cpu][n] = i;
+		yass_partition_assign(d->part, id, cpu);
 	}
 
 	/* if (!is_schedulable(sched)) */
 	/* 	return -YASS_ERROR_NOT_SCHEDULABLE; */
 	/* else */
-	return 0;
+	return d;
 }
 
-static void deadline_miss(struct sched *sched)
+static void deadline_miss(struct sched *sched, struct data *d)
 {
 	int cpu, i, id, exec, period;
 
@@ -148,94 +133,96 @@ static void deadline_miss(struct sched *sched)
 			yass_sched_inc_deadline_misses(sched);
 
 			if (cpu != -1) {
-				yass_terminate_task(sched, cpu, id, running, stalled);
+				yass_terminate_task(sched, cpu, id, d->running,
+						    d->stalled);
 			} else {
 				yass_task_set_exec(sched, id, 0);
 
-				yass_list_remove(ready, id);
-				yass_list_add(stalled, id);
+				yass_list_remove(d->ready, id);
+				yass_list_add(d->stalled, id);
 			}
 
-		} else if (tick % period == 0 && !yass_list_present(stalled, id)) {
-			if (yass_list_present(ready, id))
-				yass_list_remove(ready, id);
-			if (yass_list_present(running, id))
-				yass_list_remove(running, id);
+		} else if (tick % period == 0 && !yass_list_present(d->stalled,
+								    id)) {
+			if (yass_list_present(d->ready, id))
+				yass_list_remove(d->ready, id);
+			if (yass_list_present(d->running, id))
+				yass_list_remove(d->running, id);
 
-			yass_list_add(stalled, id);
+			yass_list_add(d->stalled, id);
 		}
 	}
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
-	int candidate, i, id, index, j;
-	int ttd, ttd_candidate;
+	struct data *d = (struct data *)data;
+
+	int candidate, i, id, n_ready, n_stalled;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
-	int n_tasks = yass_sched_get_ntasks(sched);
 	int online = yass_sched_get_online(sched);
 
+	n_stalled = yass_list_n(d->stalled);
+
 	yass_exec_inc(sched);
 
 	if (online)
-		yass_check_terminated_tasks(sched, running, stalled, YASS_ONLINE);
+		yass_check_terminated_tasks(sched, d->running, d->stalled,
+					    YASS_ONLINE);
 	else
-		yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+		yass_check_terminated_tasks(sched, d->running, d->stalled,
+					    YASS_OFFLINE);
 
 	/* if (yass_deadline_miss(sched)) */
 	/* 	return -YASS_ERROR_NOT_SCHEDULABLE; */
 
-	deadline_miss(sched);
+	deadline_miss(sched, d);
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	/* Tasks are appended: these ones completed or missed their deadline */
+	for (i = n_stalled; i < yass_list_n(d->stalled); i++) {
+		id = yass_list_get(d->stalled, i);
 
-	for (i = 0; i < n_cpus; i++) {
-		id = -1;
+		if (yass_partition_present(d->part, id))
+			yass_partition_remove(d->part, id);
+	}
 
-		candidate = -1;
-		ttd_candidate = INT_MAX;
+	n_ready = yass_list_n(d->ready);
 
-		for (j = 0; j < n_tasks; j++) {
-			index = cpu_task[i][j];
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
 
-			if (index == -1)
-				continue;
+	for (i = n_ready; i < yass_list_n(d->ready); i++) {
+		id = yass_list_get(d->ready, i);
 
-			id = yass_task_get_id(sched, index);
-			ttd = yass_task_time_to_deadline(sched, id);
+		yass_partition_add(d->part, id,
+				   yass_task_get_absolute_deadline(sched, id));
+	}
 
-			if ((yass_list_present(running, id) ||
-			     yass_list_present(ready, id)) &&
-			    ttd < ttd_candidate) {
-				candidate = id;
-				ttd_candidate = ttd;
-			}
-		}
+	for (i = 0; i < n_cpus; i++) {
+		candidate = yass_partition_top(d->part, i);
 
 		if (candidate != -1 && yass_cpu_get_task(sched, i) != candidate) {
 			if (yass_cpu_is_active(sched, i))
-				yass_preempt_task(sched, i, running, ready);
+				yass_preempt_task(sched, i, d->running,
+						  d->ready);
 
-			yass_run_task(sched, i, candidate, ready, running);
+			yass_run_task(sched, i, candidate, d->ready,
+				      d->running);
 		}
 	}
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int next_event(struct sched *sched,
+	       void *data __attribute__ ((__unused__)))
 {
-	int i;
-
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
-
-	for (i = 0; i < yass_sched_get_ncpus(sched); i++)
-		free(cpu_task[i]);
+	return yass_sched_get_next_event(sched);
+}
 
-	free(cpu_task);
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
+{
+	data_free((struct data *)data);
 
 	return 0;
 }
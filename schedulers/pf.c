@@ -1,4 +1,5 @@
 #include <math.h>
+#include <stdlib.h>
 
 #include <libyass/common.h>
 #include <libyass/cpu.h>
@@ -9,35 +10,55 @@
 
 #define SLOT_SIZE 1
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "PF";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i, id;
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	if (!yass_dpm_schedulability_test(sched))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+	struct data *d;
+
+	*error = 0;
+
+	if (!yass_dpm_schedulability_test(sched)) {
+		*error = -YASS_ERROR_NOT_SCHEDULABLE;
+		return NULL;
+	}
+
+	d = (struct data *)malloc(sizeof(struct data));
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
 
 	for (i = 0; i < n_tasks; i++) {
 		id = yass_task_get_id(sched, i);
 
-		yass_list_add(stalled, id);
+		yass_list_add(d->stalled, id);
 	}
 
-	return 0;
+	return d;
 }
 
 static int get_subtask(struct sched *sched, int id)
@@ -140,19 +161,23 @@ static void sort_list(struct sched *sched, struct yass_list *q)
 	}
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int i, id;
 	double lag;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int tick = yass_sched_get_tick(sched);
+	int n_tasks = yass_sched_get_ntasks(sched);
 
-	struct yass_list *candidate = yass_list_new(YASS_MAX_N_TASKS);
+	struct yass_list *candidate = yass_list_new_scratch(sched, n_tasks);
 
 	yass_exec_inc(sched);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
 	/*
 	 * If we are inside a slot, execute current tasks
@@ -160,16 +185,16 @@ int schedule(struct sched *sched)
 	if (tick % SLOT_SIZE != 0)
 		goto out;
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
 
 	/*
 	 * Put in the candidate list tasks from the running and ready
 	 * lists
 	 */
-	for (i = 0; i < yass_list_n(running); i++)
-		yass_list_add(candidate, yass_list_get(running, i));
-	for (i = 0; i < yass_list_n(ready); i++)
-		yass_list_add(candidate, yass_list_get(ready, i));
+	for (i = 0; i < yass_list_n(d->running); i++)
+		yass_list_add(candidate, yass_list_get(d->running, i));
+	for (i = 0; i < yass_list_n(d->ready); i++)
+		yass_list_add(candidate, yass_list_get(d->ready, i));
 
 	sort_list(sched, candidate);
 
@@ -212,7 +237,7 @@ int schedule(struct sched *sched)
 		id = yass_cpu_get_task(sched, i);
 
 		if (id != -1 && !yass_list_present(candidate, id))
-			yass_preempt_task(sched, i, running, ready);
+			yass_preempt_task(sched, i, d->running, d->ready);
 	}
 
 	/*
@@ -234,7 +259,7 @@ int schedule(struct sched *sched)
 		id = yass_list_get(candidate, 0);
 
 		if (id != -1 && !yass_cpu_is_active(sched, i)) {
-			yass_run_task(sched, i, id, ready, running);
+			yass_run_task(sched, i, id, d->ready, d->running);
 			yass_list_remove(candidate, id);
 		}
 	}
@@ -243,16 +268,18 @@ int schedule(struct sched *sched)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
  out:
-	yass_list_free(candidate);
-
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	struct data *d = (struct data *)data;
+
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
+
+	free(d);
 
 	return 0;
 }
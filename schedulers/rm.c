@@ -1,3 +1,5 @@
+#include <stdlib.h>
+
 #include <libyass/common.h>
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
@@ -5,43 +7,71 @@
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "RM";
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i, id;
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	if (yass_sched_get_ncpus(sched) != 1)
-		return -YASS_ERROR_MORE_THAN_ONE_CPU;
+	struct data *d;
+
+	*error = 0;
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	if (yass_sched_get_ncpus(sched) != 1) {
+		*error = -YASS_ERROR_MORE_THAN_ONE_CPU;
+		return NULL;
+	}
+
+	d = (struct data *)malloc(sizeof(struct data));
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
 
 	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
-	yass_sort_list_int(sched, stalled, yass_task_get_deadline);
+	yass_sort_list_int(sched, d->stalled, yass_task_get_deadline);
 
 	/* Assign priority to tasks */
-	for (i = 0; i < yass_list_n(stalled); i++) {
-		id = yass_list_get(stalled, i);
+	for (i = 0; i < yass_list_n(d->stalled); i++) {
+		id = yass_list_get(d->stalled, i);
 		yass_task_set_priority(sched, id, i + 1);
 	}
 
 	if (yass_rm_schedulability_test(sched))
-		return 0;
-	else
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+		return d;
+
+	*error = -YASS_ERROR_NOT_SCHEDULABLE;
+
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
+
+	free(d);
+
+	return NULL;
 }
 
 static int task_compare_priority(struct sched *sched, int id1, int id2)
@@ -52,19 +82,23 @@ static int task_compare_priority(struct sched *sched, int id1, int id2)
 	return p1 > p2;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int id, cpu_task;
 
 	yass_exec_inc(sched);
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
-	yass_sort_list_int(sched, ready, yass_task_get_priority);
+	/* Sorted at the previous tick, released tasks are at the end */
+	yass_insert_sort_list_int(sched, d->ready, yass_task_get_priority);
 
-	id = yass_list_get(ready, 0);
+	id = yass_list_get(d->ready, 0);
 	cpu_task = yass_cpu_get_task(sched, 0);
 
 	if (id == -1)
@@ -73,21 +107,31 @@ int schedule(struct sched *sched)
 	if (!yass_cpu_is_active(sched, 0) ||
 	    task_compare_priority(sched, cpu_task, id)) {
 
-		if (yass_list_get(running, 0) != -1)
-			yass_preempt_task(sched, 0, running, ready);
+		if (yass_list_get(d->running, 0) != -1)
+			yass_preempt_task(sched, 0, d->running, d->ready);
 
-		yass_run_task(sched, 0, yass_list_get(ready, 0), ready,
-			      running);
+		yass_run_task(sched, 0, yass_list_get(d->ready, 0), d->ready,
+			      d->running);
 	}
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int next_event(struct sched *sched,
+	       void *data __attribute__ ((__unused__)))
 {
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	return yass_sched_get_next_event(sched);
+}
+
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
+{
+	struct data *d = (struct data *)data;
+
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
+
+	free(d);
 
 	return 0;
 }
@@ -22,10 +22,6 @@ enum reduce_operation {
 	DUAL = 2
 };
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
-
 struct server {
 
 	int id;
@@ -45,6 +41,12 @@ struct server {
 
 	int active;
 
+	/*
+	 * For edf servers, whether one of the child servers has been
+	 * activated.
+	 */
+	int child_active;
+
 	int level;
 
 	enum server_type type;
@@ -56,14 +58,28 @@ struct server {
 	struct server *next;
 };
 
-struct server ***servers;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
+
+	struct server ***servers;
+
+	/* Number of servers a level can hold */
+	int n_servers;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
 	return "RUN";
 }
 
-static struct server *server_new(int id)
+static struct server *server_new(struct data *d, int id)
 {
 	int i;
 
@@ -84,18 +100,18 @@ static struct server *server_new(int id)
 
 	s->n = 0;
 
-	s->period = (int *)malloc(YASS_MAX_N_TASKS * sizeof(int));
+	s->period = (int *)malloc(d->n_servers * sizeof(int));
 
 	if (!s->period)
 		return NULL;
 
 	s->previous = (struct server **)
-	    malloc(YASS_MAX_N_TASKS * sizeof(struct server));
+	    malloc(d->n_servers * sizeof(struct server *));
 
 	if (!s->previous)
 		return NULL;
 
-	for (i = 0; i < YASS_MAX_N_TASKS; i++) {
+	for (i = 0; i < d->n_servers; i++) {
 		s->period[i] = -1;
 		s->previous[i] = NULL;
 	}
@@ -112,7 +128,7 @@ static void server_free(struct server *s)
 	free(s);
 }
 
-static int init_servers(struct sched *sched)
+static int init_servers(struct sched *sched, struct data *d)
 {
 	int i, id, j;
 
@@ -121,33 +137,35 @@ static int init_servers(struct sched *sched)
 
 	struct server *s;
 
-	servers = (struct server ***)
-	    malloc(MAX_LEVEL * n_servers * sizeof(struct server *));
+	d->n_servers = n_servers;
 
-	if (!servers)
+	d->servers = (struct server ***)
+	    malloc(MAX_LEVEL * sizeof(struct server **));
+
+	if (!d->servers)
 		return -YASS_ERROR_MALLOC;
 
 	for (i = 0; i < MAX_LEVEL; i++) {
 
-		servers[i] = (struct server **)
+		d->servers[i] = (struct server **)
 		    malloc(n_servers * sizeof(struct server *));
 
-		if (!servers[i])
+		if (!d->servers[i])
 			return -YASS_ERROR_MALLOC;
 
 		for (j = 0; j < n_servers; j++)
-			servers[i][j] = NULL;
+			d->servers[i][j] = NULL;
 	}
 
 	for (i = 0; i < n_tasks; i++) {
 		id = yass_task_get_id(sched, i);
 
-		servers[0][i] = server_new(id);
+		d->servers[0][i] = server_new(d, id);
 
-		if (!servers[0][i])
+		if (!d->servers[0][i])
 			return -YASS_ERROR_MALLOC;
 
-		s = servers[0][i];
+		s = d->servers[0][i];
 
 		s->id = id;
 		s->u = yass_task_get_utilization(sched, id);
@@ -163,15 +181,15 @@ static int init_servers(struct sched *sched)
 /*
  * The reduction is done once all servers are unit servers
  */
-static int reduction_done(int level)
+static int reduction_done(struct data *d, int level)
 {
 	int i = 0;
 
 	if (level == 0)
 		return 0;
 
-	while (servers[level][i] != NULL) {
-		if (servers[level][i]->u < 1 - 0.0001)
+	while (d->servers[level][i] != NULL) {
+		if (d->servers[level][i]->u < 1 - 0.0001)
 			return 0;
 
 		i++;
@@ -204,7 +222,7 @@ static void add_previous(struct server *dst, struct server *src)
 	dst->previous[d] = src;
 }
 
-static void print_level(struct sched *sched, int l)
+static void print_level(struct sched *sched, struct data *d, int l)
 {
 	int i = 0, id, j;
 
@@ -214,9 +232,9 @@ static void print_level(struct sched *sched, int l)
 
 	printf("=== Level %d ===\n", l);
 
-	while (i < n_tasks && servers[l][i] != NULL) {
+	while (i < n_tasks && d->servers[l][i] != NULL) {
 
-		s = servers[l][i];
+		s = d->servers[l][i];
 
 		printf(" -- server %d --\n", i);
 
@@ -271,17 +289,18 @@ static void print_level(struct sched *sched, int l)
 }
 
 __attribute__ ((__unused__))
-static void print_levels(struct sched *sched)
+static void print_levels(struct sched *sched, struct data *d)
 {
 	int l = 0;
 
-	while (servers[l][0] != NULL) {
-		print_level(sched, l);
+	while (d->servers[l][0] != NULL) {
+		print_level(sched, d, l);
 		l++;
 	}
 }
 
-static int can_add_dummy_task(struct sched *sched, struct server *next)
+static int can_add_dummy_task(struct sched *sched, struct data *d,
+			      struct server *next)
 {
 	int i, id, wcet, period;
 
@@ -297,9 +316,9 @@ static int can_add_dummy_task(struct sched *sched, struct server *next)
 	/*
 	 * Compute h
 	 */
-	while (servers[0][i] != NULL) {
+	while (d->servers[0][i] != NULL) {
 
-		s = servers[0][i];
+		s = d->servers[0][i];
 
 		id = s->task_id;
 
@@ -313,9 +332,9 @@ static int can_add_dummy_task(struct sched *sched, struct server *next)
 	exec_t = 0;
 	i = 0;
 
-	while (servers[0][i] != NULL) {
+	while (d->servers[0][i] != NULL) {
 
-		s = servers[0][i];
+		s = d->servers[0][i];
 
 		id = s->task_id;
 
@@ -342,12 +361,12 @@ static int can_add_dummy_task(struct sched *sched, struct server *next)
 	return 0;
 }
 
-static int add_dummy_task(struct sched *sched, double u, struct server *next)
+static int add_dummy_task(struct sched *sched, struct data *d, double u,
+			  struct server *next)
 {
 	int id, index, n_tasks, r;
 
 	struct server *s;
-	struct yass_task *t;
 
 	if (u < 0 || u > 1)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
@@ -360,24 +379,24 @@ static int add_dummy_task(struct sched *sched, double u, struct server *next)
 	n_tasks = yass_sched_get_ntasks(sched);
 
 	id = yass_task_get_id(sched, n_tasks - 1);
-	t = yass_sched_get_task(sched, id);
 
-	t->wcet = (int)round(u * t->period);
+	yass_task_set_wcet(sched, id,
+			   (int)round(u * yass_task_get_period(sched, id)));
 
 	if (yass_task_get_wcet(sched, id) <= 0)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
 	index = 0;
 
-	while (index < n_tasks && servers[0][index] != NULL)
+	while (index < n_tasks && d->servers[0][index] != NULL)
 		index++;
 
-	servers[0][index] = server_new(id);
+	d->servers[0][index] = server_new(d, id);
 
-	if (!servers[0][index])
+	if (!d->servers[0][index])
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
-	s = servers[0][index];
+	s = d->servers[0][index];
 
 	s->u = u;
 	s->task_id = s->id;
@@ -397,7 +416,7 @@ static int add_dummy_task(struct sched *sched, double u, struct server *next)
 	return 0;
 }
 
-static int add_idle_tasks(struct sched *sched)
+static int add_idle_tasks(struct sched *sched, struct data *d)
 {
 	int i, index, r;
 	double u, u_rem;
@@ -407,11 +426,11 @@ static int add_idle_tasks(struct sched *sched)
 
 	i = 0;
 
-	while (i < n_tasks && servers[1][i] != NULL) {
-		u = servers[1][i]->u;
+	while (i < n_tasks && d->servers[1][i] != NULL) {
+		u = d->servers[1][i]->u;
 
-		if (can_add_dummy_task(sched, servers[1][i])) {
-			r = add_dummy_task(sched, 1 - u, servers[1][i]);
+		if (can_add_dummy_task(sched, d, d->servers[1][i])) {
+			r = add_dummy_task(sched, d, 1 - u, d->servers[1][i]);
 
 			if (r)
 				return r;
@@ -430,32 +449,34 @@ static int add_idle_tasks(struct sched *sched)
 	 */
 	u_rem = n_cpus - yass_sched_get_global_utilization(sched);
 
-	if (can_add_dummy_task(sched, NULL)) {
-		r = add_dummy_task(sched, u_rem, NULL);
+	if (can_add_dummy_task(sched, d, NULL)) {
+		r = add_dummy_task(sched, d, u_rem, NULL);
 
 		if (r)
 			return r;
 
 		index = 0;
 
-		while (index < n_tasks && servers[0][index] != NULL)
+		while (index < n_tasks && d->servers[0][index] != NULL)
 			index++;
 
 		i = 0;
 
-		while (i < n_tasks && servers[1][i] != NULL) {
+		while (i < n_tasks && d->servers[1][i] != NULL) {
 
-			u = servers[1][i]->u;
+			u = d->servers[1][i]->u;
 
 			if (u < 1 && u + u_rem <= 1) {
 
-				servers[0][index]->next = servers[1][i];
+				d->servers[0][index]->next = d->servers[1][i];
 
-				servers[1][i]->u += u_rem;
-				servers[1][i]->n++;
+				d->servers[1][i]->u += u_rem;
+				d->servers[1][i]->n++;
 
-				add_period(servers[1][i], servers[0][index]);
-				add_previous(servers[1][i], servers[0][index]);
+				add_period(d->servers[1][i],
+					   d->servers[0][index]);
+				add_previous(d->servers[1][i],
+					     d->servers[0][index]);
 
 				break;
 			}
@@ -467,15 +488,15 @@ static int add_idle_tasks(struct sched *sched)
 	return 0;
 }
 
-static int pack(int l)
+static int pack(struct data *d, int l)
 {
 	int i = 0, n;
 
 	struct server *s, *next;
 
-	while (servers[l][i] != NULL) {
+	while (d->servers[l][i] != NULL) {
 
-		s = servers[l][i];
+		s = d->servers[l][i];
 
 		n = 0;
 
@@ -484,19 +505,19 @@ static int pack(int l)
 		 * server if s does not fit in an existing one.
 		 */
 
-		while (servers[l + 1][n] != NULL &&
-		       servers[l + 1][n]->u + s->u > 1 + 0.000001) {
+		while (d->servers[l + 1][n] != NULL &&
+		       d->servers[l + 1][n]->u + s->u > 1 + 0.000001) {
 			n++;
 		}
 
-		if (servers[l + 1][n] == NULL) {
-			servers[l + 1][n] = server_new((l + 1) * 100 + n);
+		if (d->servers[l + 1][n] == NULL) {
+			d->servers[l + 1][n] = server_new(d, (l + 1) * 100 + n);
 
-			if (!servers[l + 1][n])
+			if (!d->servers[l + 1][n])
 				return -YASS_ERROR_MALLOC;
 		}
 
-		next = servers[l + 1][n];
+		next = d->servers[l + 1][n];
 
 		s->next = next;
 
@@ -514,22 +535,22 @@ static int pack(int l)
 	return 0;
 }
 
-static int dual(int l)
+static int dual(struct data *d, int l)
 {
 	int i = 0;
 
 	struct server *s, *next;
 
-	while (servers[l][i] != NULL) {
+	while (d->servers[l][i] != NULL) {
 
-		s = servers[l][i];
+		s = d->servers[l][i];
 
-		servers[l + 1][i] = server_new((l + 1) * 100 + i);
+		d->servers[l + 1][i] = server_new(d, (l + 1) * 100 + i);
 
-		if (!servers[l + 1][i])
+		if (!d->servers[l + 1][i])
 			return -YASS_ERROR_MALLOC;
 
-		next = servers[l + 1][i];
+		next = d->servers[l + 1][i];
 
 		next->u = 1 - s->u;
 		next->type = EDF_SERVER;
@@ -547,7 +568,7 @@ static int dual(int l)
 	return 0;
 }
 
-static int reduce(struct sched *sched)
+static int reduce(struct sched *sched, struct data *d)
 {
 	int i, level = 0, r;
 
@@ -557,7 +578,7 @@ static int reduce(struct sched *sched)
 		/*
 		 * PACK
 		 */
-		r = pack(level);
+		r = pack(d, level);
 
 		if (r)
 			return r;
@@ -565,66 +586,100 @@ static int reduce(struct sched *sched)
 		level++;
 
 		if (level == 1) {
-			if (add_idle_tasks(sched))
+			if (add_idle_tasks(sched, d))
 				return -YASS_ERROR_MALLOC;
 
 			n_tasks = yass_sched_get_ntasks(sched);
 		}
 
-		if (reduction_done(level))
+		if (reduction_done(d, level))
 			break;
 
 		/*
 		 * DUAL
 		 */
-		r = dual(level);
+		r = dual(d, level);
 
 		if (r)
 			return r;
 
 		level++;
 
-	} while (level < MAX_LEVEL - 2 && !reduction_done(level));
+	} while (level < MAX_LEVEL - 2 && !reduction_done(d, level));
 
 	if (level >= MAX_LEVEL - 2)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
 	i = 0;
 
-	while (i < n_tasks && servers[level][i] != NULL) {
-		servers[level][i]->type = ROOT_SERVER;
+	while (i < n_tasks && d->servers[level][i] != NULL) {
+		d->servers[level][i]->type = ROOT_SERVER;
 		i++;
 	}
 
 	return 0;
 }
 
-int offline(struct sched *sched)
+static void servers_free(struct sched *sched, struct data *d)
 {
-	int i, id, n_tasks, r;
+	int i, j;
 
-	if (!yass_dpm_schedulability_test(sched))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+	int n_tasks = yass_sched_get_ntasks(sched);
+
+	for (i = 0; i < MAX_LEVEL; i++) {
+		for (j = 0; j < n_tasks; j++) {
+			if (d->servers[i][j] != NULL)
+				server_free(d->servers[i][j]);
+		}
 
-	init_servers(sched);
+		free(d->servers[i]);
+	}
 
-	r = reduce(sched);
+	free(d->servers);
+}
 
-	if (r)
-		return r;
+void *offline(struct sched *sched, int *error)
+{
+	int i, id, n_tasks;
+
+	struct data *d;
+
+	*error = 0;
+
+	if (!yass_dpm_schedulability_test(sched)) {
+		*error = -YASS_ERROR_NOT_SCHEDULABLE;
+		return NULL;
+	}
+
+	d = (struct data *)malloc(sizeof(struct data));
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	init_servers(sched, d);
+
+	*error = reduce(sched, d);
+
+	if (*error) {
+		servers_free(sched, d);
+		free(d);
+		return NULL;
+	}
 
 	n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
 
 	for (i = 0; i < n_tasks; i++) {
 		id = yass_task_get_id(sched, i);
-		yass_list_add(stalled, id);
+		yass_list_add(d->stalled, id);
 	}
 
-	return 0;
+	return d;
 }
 
 static int server_get_deadline(struct sched *sched, struct server *s)
@@ -674,7 +729,8 @@ static int server_get_min_period(struct sched *sched, struct server *ser)
 	return min;
 }
 
-static void sort_servers(struct sched *sched, int f, struct server *next)
+static void sort_servers(struct sched *sched, struct data *d, int f,
+			 struct server *next)
 {
 	int i = 0, j, sub;
 	int min1, min2, p1, p2;
@@ -683,9 +739,9 @@ static void sort_servers(struct sched *sched, int f, struct server *next)
 
 	struct server *s1, *s2, *tmp;
 
-	while (servers[f][i] != NULL) {
+	while (d->servers[f][i] != NULL) {
 
-		s1 = servers[f][i];
+		s1 = d->servers[f][i];
 
 		if (next != NULL && s1->next != next) {
 			i++;
@@ -701,9 +757,9 @@ static void sort_servers(struct sched *sched, int f, struct server *next)
 		j = i + 1;
 		sub = -1;
 
-		while (j < n_tasks && servers[f][j] != NULL) {
+		while (j < n_tasks && d->servers[f][j] != NULL) {
 
-			s2 = servers[f][j];
+			s2 = d->servers[f][j];
 
 			if (next != NULL && s2->next != next) {
 				j++;
@@ -727,16 +783,16 @@ static void sort_servers(struct sched *sched, int f, struct server *next)
 		}
 
 		if (sub != -1) {
-			tmp = servers[f][i];
-			servers[f][i] = servers[f][sub];
-			servers[f][sub] = tmp;
+			tmp = d->servers[f][i];
+			d->servers[f][i] = d->servers[f][sub];
+			d->servers[f][sub] = tmp;
 		}
 
 		i++;
 	}
 }
 
-static int set_active(struct server *s, int edf[MAX_LEVEL * YASS_MAX_N_TASKS])
+static int set_active(struct server *s)
 {
 	int t = s->type;
 
@@ -757,8 +813,8 @@ static int set_active(struct server *s, int edf[MAX_LEVEL * YASS_MAX_N_TASKS])
 
 		break;
 	case EDF_SERVER:
-		if (n->active && edf[n->id] == 0 && server_is_ready(s)) {
-			edf[n->id] = 1;
+		if (n->active && !n->child_active && server_is_ready(s)) {
+			n->child_active = 1;
 			s->active = 1;
 		}
 		break;
@@ -767,51 +823,50 @@ static int set_active(struct server *s, int edf[MAX_LEVEL * YASS_MAX_N_TASKS])
 	return 0;
 }
 
-static int update_active_servers(struct sched *sched)
+static int update_active_servers(struct sched *sched, struct data *d)
 {
-	int i, j, l, t, r;
-
-	/*
-	 * To know whether or not a child server has been activated
-	 * for edf servers. Obviously, this is not the prettiest way
-	 * to achieve this ...
-	 */
-	int edf[MAX_LEVEL * YASS_MAX_N_TASKS];
+	int j, l, t, r;
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 
 	struct server *s;
 
+	for (l = 0; l < MAX_LEVEL; l++) {
+		j = 0;
+
+		while (j < d->n_servers && d->servers[l][j] != NULL) {
+			d->servers[l][j]->child_active = 0;
+			j++;
+		}
+	}
+
 	/*
 	 * Compute the root server(s) level.
 	 */
 	l = MAX_LEVEL - 1;
 
-	while (servers[l][0] == NULL)
+	while (d->servers[l][0] == NULL)
 		l--;
 
 	if (l >= MAX_LEVEL - 1 || l <= 0)
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
-	sort_servers(sched, l, NULL);
-
-	for (i = 0; i < MAX_LEVEL * YASS_MAX_N_TASKS; i++)
-		edf[i] = 0;
+	sort_servers(sched, d, l, NULL);
 
 	while (l >= 0) {
 
-		sort_servers(sched, l, NULL);
+		sort_servers(sched, d, l, NULL);
 
 		j = 0;
 
-		while (j < n_tasks && servers[l][j] != NULL) {
+		while (j < n_tasks && d->servers[l][j] != NULL) {
 
-			s = servers[l][j];
+			s = d->servers[l][j];
 
 			s->active = 0;
 
 			if (server_is_ready(s)) {
-				r = set_active(s, edf);
+				r = set_active(s);
 
 				if (r)
 					return r;
@@ -822,8 +877,8 @@ static int update_active_servers(struct sched *sched)
 
 		j = 0;
 
-		while (j < n_tasks && servers[l][j] != NULL) {
-			s = servers[l][j];
+		while (j < n_tasks && d->servers[l][j] != NULL) {
+			s = d->servers[l][j];
 			t = s->type;
 
 			/*
@@ -831,7 +886,7 @@ static int update_active_servers(struct sched *sched)
 			 * child server active.
 			 */
 			if (t == EDF_SERVER && s->next->active &&
-			    !edf[s->next->id]) {
+			    !s->next->child_active) {
 				return -YASS_ERROR_NOT_SCHEDULABLE;
 			}
 
@@ -844,7 +899,8 @@ static int update_active_servers(struct sched *sched)
 	return 0;
 }
 
-static int select_active_tasks(struct sched *sched, struct yass_list *candidate)
+static int select_active_tasks(struct sched *sched, struct data *d,
+			       struct yass_list *candidate)
 {
 	int id, j = 0;
 
@@ -853,12 +909,12 @@ static int select_active_tasks(struct sched *sched, struct yass_list *candidate)
 
 	struct server *s;
 
-	while (j < n_tasks && servers[0][j] != NULL) {
+	while (j < n_tasks && d->servers[0][j] != NULL) {
 
-		s = servers[0][j];
+		s = d->servers[0][j];
 		id = s->task_id;
 
-		if (s->active == 1 && !yass_list_present(stalled, id))
+		if (s->active == 1 && !yass_list_present(d->stalled, id))
 			yass_list_add(candidate, id);
 
 		j++;
@@ -870,7 +926,7 @@ static int select_active_tasks(struct sched *sched, struct yass_list *candidate)
 	return 1;
 }
 
-static int schedule_candidate_tasks(struct sched *sched,
+static int schedule_candidate_tasks(struct sched *sched, struct data *d,
 				    struct yass_list *candidate)
 {
 	int i, id;
@@ -884,7 +940,7 @@ static int schedule_candidate_tasks(struct sched *sched,
 		id = yass_cpu_get_task(sched, i);
 
 		if (id != -1 && !yass_list_present(candidate, id))
-			yass_preempt_task(sched, i, running, ready);
+			yass_preempt_task(sched, i, d->running, d->ready);
 	}
 
 	/*
@@ -905,19 +961,19 @@ static int schedule_candidate_tasks(struct sched *sched,
 		id = yass_list_get(candidate, 0);
 
 		if (!yass_cpu_is_active(sched, i) && id != -1) {
-			yass_run_task(sched, i, id, ready, running);
+			yass_run_task(sched, i, id, d->ready, d->running);
 
 			yass_list_remove(candidate, id);
 		}
 	}
 
-	if (yass_list_n(candidate) != 0 || yass_list_n(running) != n_cpus)
+	if (yass_list_n(candidate) != 0 || yass_list_n(d->running) != n_cpus)
 		return 0;
 
 	return 1;
 }
 
-static void terminate_task(struct sched *sched, int id)
+static void terminate_task(struct sched *sched, struct data *d, int id)
 {
 	int cpu = yass_task_get_cpu(sched, id);
 	int wcet = yass_task_get_wcet(sched, id);
@@ -927,11 +983,11 @@ static void terminate_task(struct sched *sched, int id)
 
 	if (exec >= wcet - 0.001) {
 		yass_terminate_task_tick(sched, cpu, id, tick,
-					 running, stalled);
+					 d->running, d->stalled);
 	}
 }
 
-static int check_terminated_tasks(struct sched *sched)
+static int check_terminated_tasks(struct sched *sched, struct data *d)
 {
 	int i, id, j, l = 0, r = 0;
 
@@ -939,13 +995,13 @@ static int check_terminated_tasks(struct sched *sched)
 
 	struct server *s;
 
-	while (servers[l][0] != NULL) {
+	while (d->servers[l][0] != NULL) {
 
 		i = 0;
 
-		while (i < n_tasks && servers[l][i] != NULL) {
+		while (i < n_tasks && d->servers[l][i] != NULL) {
 
-			s = servers[l][i];
+			s = d->servers[l][i];
 
 			if (s->active && !server_is_ready(s)) {
 
@@ -957,7 +1013,7 @@ static int check_terminated_tasks(struct sched *sched)
 					id = s->period[j];
 
 					if (yass_task_is_active(sched, id))
-						terminate_task(sched, id);
+						terminate_task(sched, d, id);
 
 					j++;
 				}
@@ -972,28 +1028,28 @@ static int check_terminated_tasks(struct sched *sched)
 	return r;
 }
 
-static int update_wcet(struct sched *sched)
+static int update_wcet(struct sched *sched, struct data *d)
 {
-	int d, i, l = 0;
+	int deadline, i, l = 0;
 
 	int n_tasks = yass_sched_get_ntasks(sched);
 	int tick = yass_sched_get_tick(sched);
 
 	struct server *s;
 
-	while (servers[l][0] != NULL) {
+	while (d->servers[l][0] != NULL) {
 
 		i = 0;
 
-		while (i < n_tasks && servers[l][i] != NULL) {
+		while (i < n_tasks && d->servers[l][i] != NULL) {
 
-			s = servers[l][i];
+			s = d->servers[l][i];
 
 			if (s->deadline == tick) {
 
-				d = server_get_deadline(sched, s);
+				deadline = server_get_deadline(sched, s);
 
-				if (d == -1)
+				if (deadline == -1)
 					return -YASS_ERROR_NOT_SCHEDULABLE;
 
 				if (s->exec <= s->wcet - 0.0001)
@@ -1003,8 +1059,8 @@ static int update_wcet(struct sched *sched)
 					return -YASS_ERROR_NOT_SCHEDULABLE;
 
 				s->exec = 0;
-				s->deadline = d;
-				s->wcet = s->u * (d - tick);
+				s->deadline = deadline;
+				s->wcet = s->u * (deadline - tick);
 
 				if (s->deadline < tick + s->wcet - 0.001)
 					return -YASS_ERROR_NOT_SCHEDULABLE;
@@ -1019,7 +1075,7 @@ static int update_wcet(struct sched *sched)
 	return 0;
 }
 
-static int schedulability_test(struct sched *sched, double time)
+static int schedulability_test(struct sched *sched, struct data *d, double time)
 {
 	int i, l = 0;
 
@@ -1028,13 +1084,13 @@ static int schedulability_test(struct sched *sched, double time)
 
 	struct server *s;
 
-	while (servers[l][0] != NULL) {
+	while (d->servers[l][0] != NULL) {
 
 		i = 0;
 
-		while (i < n_tasks && servers[l][i] != NULL) {
+		while (i < n_tasks && d->servers[l][i] != NULL) {
 
-			s = servers[l][i];
+			s = d->servers[l][i];
 
 			if (tick + s->wcet - s->exec > s->deadline + 0.001)
 				return 1;
@@ -1048,7 +1104,7 @@ static int schedulability_test(struct sched *sched, double time)
 	return 0;
 }
 
-static int execute(struct sched *sched, double inc)
+static int execute(struct sched *sched, struct data *d, double inc)
 {
 	int i, id, l = 0;
 
@@ -1079,13 +1135,13 @@ static int execute(struct sched *sched, double inc)
 
 	total_execution = 0;
 
-	while (servers[l][0] != NULL) {
+	while (d->servers[l][0] != NULL) {
 
 		i = 0;
 
-		while (i < n_tasks && servers[l][i] != NULL) {
+		while (i < n_tasks && d->servers[l][i] != NULL) {
 
-			s = servers[l][i];
+			s = d->servers[l][i];
 
 			if (s->active) {
 				s->exec += inc;
@@ -1108,7 +1164,7 @@ static int execute(struct sched *sched, double inc)
 	return 0;
 }
 
-static double min_execution(struct sched *sched)
+static double min_execution(struct sched *sched, struct data *d)
 {
 	int i, l = 0;
 	double min = YASS_MAX_PERIOD;
@@ -1117,13 +1173,13 @@ static double min_execution(struct sched *sched)
 
 	struct server *s;
 
-	while (servers[l][0] != NULL) {
+	while (d->servers[l][0] != NULL) {
 
 		i = 0;
 
-		while (i < n_tasks && servers[l][i] != NULL) {
+		while (i < n_tasks && d->servers[l][i] != NULL) {
 
-			s = servers[l][i];
+			s = d->servers[l][i];
 
 			if (s->active && s->wcet - s->exec < min)
 				min = s->wcet - s->exec;
@@ -1137,7 +1193,8 @@ static double min_execution(struct sched *sched)
 	return min;
 }
 
-static int check_ready_tasks(struct sched *sched, struct yass_list *stalled,
+static int check_ready_tasks(struct sched *sched, struct data *d,
+			     struct yass_list *stalled,
 			     struct yass_list *ready)
 {
 	int i, id, period, l, r = 0;
@@ -1164,11 +1221,11 @@ static int check_ready_tasks(struct sched *sched, struct yass_list *stalled,
 
 	l = 0;
 
-	while (servers[l][0] != NULL) {
+	while (d->servers[l][0] != NULL) {
 		i = 0;
 
-		while (i < n_tasks && servers[l][i] != NULL) {
-			if (servers[l][i]->deadline == tick)
+		while (i < n_tasks && d->servers[l][i] != NULL) {
+			if (d->servers[l][i]->deadline == tick)
 				r = 1;
 
 			i++;
@@ -1180,10 +1237,14 @@ static int check_ready_tasks(struct sched *sched, struct yass_list *stalled,
 	return r;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int r;
 
+	int n_tasks = yass_sched_get_ntasks(sched);
+
 	double min, time = 0;
 
 	struct yass_list *candidate;
@@ -1193,24 +1254,24 @@ int schedule(struct sched *sched)
 		if (time > 0)
 			yass_sched_update_idle(sched);
 
-		if (schedulability_test(sched, time))
+		if (schedulability_test(sched, d, time))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
-		if (check_terminated_tasks(sched)) {
-			r = update_active_servers(sched);
+		if (check_terminated_tasks(sched, d)) {
+			r = update_active_servers(sched, d);
 			if (r)
 				return r;
 		}
 
 		if (time == 0) {
-			r = check_ready_tasks(sched, stalled, ready);
+			r = check_ready_tasks(sched, d, d->stalled, d->ready);
 
 			if (r == 1) {
-				r = update_wcet(sched);
+				r = update_wcet(sched, d);
 				if (r)
 					return r;
 
-				r = update_active_servers(sched);
+				r = update_active_servers(sched, d);
 				if (r)
 					return r;
 			} else if (r == -1) {
@@ -1218,25 +1279,23 @@ int schedule(struct sched *sched)
 			}
 		}
 
-		candidate = yass_list_new(YASS_MAX_N_TASKS);
+		candidate = yass_list_new_scratch(sched, n_tasks);
 
-		if (!select_active_tasks(sched, candidate))
+		if (!select_active_tasks(sched, d, candidate))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
-		if (!schedule_candidate_tasks(sched, candidate))
+		if (!schedule_candidate_tasks(sched, d, candidate))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
-		min = min_execution(sched);
+		min = min_execution(sched, d);
 
 		if (time + min > 1 - 0.0001)
 			min = 1 - time;
 
-		if (execute(sched, min))
+		if (execute(sched, d, min))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
 		time += min;
-
-		yass_list_free(candidate);
 	}
 
 	if (time > 1.0001 || time < 1 - 0.0001)
@@ -1245,26 +1304,17 @@ int schedule(struct sched *sched)
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched, void *data)
 {
-	int i, j;
+	struct data *d = (struct data *)data;
 
-	int n_tasks = yass_sched_get_ntasks(sched);
-
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
 
-	for (i = 0; i < MAX_LEVEL; i++) {
-		for (j = 0; j < n_tasks; j++) {
-			if (servers[i][j] != NULL)
-				server_free(servers[i][j]);
-		}
-
-		free(servers[i]);
-	}
+	servers_free(sched, d);
 
-	free(servers);
+	free(d);
 
 	return 0;
 }
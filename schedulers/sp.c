@@ -6,39 +6,30 @@
 #include <libyass/cpu.h>
 #include <libyass/helpers.h>
 #include <libyass/list.h>
+#include <libyass/partition.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
 
-int **cpu_task;
+	/* Tasks of each cpu, the ready and running ones by deadline */
+	struct yass_partition *part;
+};
 
-const char *name()
+int abi_version()
 {
-	return "SP";
+	return YASS_SCHED_ABI_V2;
 }
 
-static unsigned long long get_cpu_execution(struct sched *sched, int cpu)
+const char *name()
 {
-	int i, id;
-
-	unsigned long long e = 0;
-
-	int n_tasks = yass_sched_get_ntasks(sched);
-
-	for (i = 0; i < n_tasks; i++) {
-		if (cpu_task[cpu][i] != -1) {
-			id = yass_task_get_id(sched, i);
-			e += yass_task_get_exec_hyperperiod(sched, id);
-		}
-	}
-
-	return e;
+	return "SP";
 }
 
-static int is_schedulable(struct sched *sched)
+static int is_schedulable(struct sched *sched, struct data *d)
 {
 	int i;
 
@@ -47,17 +38,18 @@ static int is_schedulable(struct sched *sched)
 	unsigned long long h = yass_sched_get_hyperperiod(sched);
 
 	for (i = 0; i < n_cpus; i++) {
-		if (get_cpu_execution(sched, i) > h)
+		if (yass_partition_get_load(d->part, i) > h)
 			return 0;
 	}
 
 	return 1;
 }
 
-static int get_lowest_utilization_cpu(struct sched *sched)
+static int get_lowest_utilization_cpu(struct sched *sched,
+				      unsigned long long *load)
 {
 	int cpu, i;
-	unsigned long long e, e_min;
+	unsigned long long e_min;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 
@@ -65,10 +57,8 @@ static int get_lowest_utilization_cpu(struct sched *sched)
 	cpu = -1;
 
 	for (i = 0; i < n_cpus; i++) {
-		e = get_cpu_execution(sched, i);
-
-		if (e < e_min) {
-			e_min = e;
+		if (load[i] < e_min) {
+			e_min = load[i];
 			cpu = i;
 		}
 	}
@@ -87,7 +77,7 @@ static int get_th(struct sched *sched, int id)
 /*
  * Sort tasks according to T - C
  */
-static void sort_list_desc_tc(struct sched *sched)
+static void sort_list_desc_tc(struct sched *sched, struct data *d)
 {
 	int i, j;
 	int n, tmp;
@@ -95,14 +85,14 @@ static void sort_list_desc_tc(struct sched *sched)
 	int id1, id2;
 	int r1, r2;
 
-	for (i = 0; i < yass_list_n(stalled); i++) {
-		id1 = yass_list_get(stalled, i);
+	for (i = 0; i < yass_list_n(d->stalled); i++) {
+		id1 = yass_list_get(d->stalled, i);
 		r1 = get_th(sched, id1);
 
 		n = -1;
 
-		for (j = i + 1; j < yass_list_n(stalled); j++) {
-			id2 = yass_list_get(stalled, j);
+		for (j = i + 1; j < yass_list_n(d->stalled); j++) {
+			id2 = yass_list_get(d->stalled, j);
 
 			r2 = get_th(sched, id2);
 
@@ -114,14 +104,16 @@ static void sort_list_desc_tc(struct sched *sched)
 		}
 
 		if (n != -1) {
-			tmp = yass_list_get(stalled, i);
-			yass_list_set(stalled, i, yass_list_get(stalled, n));
-			yass_list_set(stalled, n, tmp);
+			tmp = yass_list_get(d->stalled, i);
+			yass_list_set(d->stalled, i, yass_list_get(d->stalled,
+								   n));
+			yass_list_set(d->stalled, n, tmp);
 		}
 	}
 }
 
-static int compute_th(struct sched *sched, int **th, int cpu, int index)
+static int compute_th(struct sched *sched, struct data *d, int **th, int cpu,
+		      int index)
 {
 	int e = 0, i, id, tick;
 	int period, wcet;
@@ -130,7 +122,7 @@ static int compute_th(struct sched *sched, int **th, int cpu, int index)
 
 	for (i = 0; i < index; i++) {
 		if (th[cpu][i] != -1) {
-			id = yass_list_get(stalled, i);
+			id = yass_list_get(d->stalled, i);
 			period = yass_task_get_period(sched, id);
 
 			if (period < tick)
@@ -138,7 +130,7 @@ static int compute_th(struct sched *sched, int **th, int cpu, int index)
 		}
 	}
 
-	id = yass_list_get(stalled, index);
+	id = yass_list_get(d->stalled, index);
 	period = yass_task_get_period(sched, id);
 
 	if (period < tick)
@@ -148,7 +140,7 @@ static int compute_th(struct sched *sched, int **th, int cpu, int index)
 
 	for (i = 0; i < index; i++) {
 		if (th[cpu][i] != -1) {
-			id = yass_list_get(stalled, i);
+			id = yass_list_get(d->stalled, i);
 			period = yass_task_get_period(sched, id);
 			wcet = yass_task_get_wcet(sched, id);
 
@@ -156,7 +148,7 @@ static int compute_th(struct sched *sched, int **th, int cpu, int index)
 		}
 	}
 
-	id = yass_list_get(stalled, index);
+	id = yass_list_get(d->stalled, index);
 	period = yass_task_get_period(sched, id);
 	wcet = yass_task_get_wcet(sched, id);
 
@@ -166,7 +158,7 @@ static int compute_th(struct sched *sched, int **th, int cpu, int index)
 }
 
 __attribute__ ((__unused__))
-static void print_table(struct sched *sched, int **table)
+static void print_table(struct sched *sched, struct data *d, int **table)
 {
 	int i, id, index, j;
 
@@ -174,8 +166,8 @@ static void print_table(struct sched *sched, int **table)
 
 	for (i = 0; i < n_cpus; i++) {
 		printf("cpu %d\n", i);
-		for (j = 0; j < yass_list_n(stalled); j++) {
-			id = yass_list_get(stalled, j);
+		for (j = 0; j < yass_list_n(d->stalled); j++) {
+			id = yass_list_get(d->stalled, j);
 			index = yass_task_get_from_id(sched, id);
 
 			if (table[i][index] != -1)
@@ -185,7 +177,7 @@ static void print_table(struct sched *sched, int **table)
 	}
 }
 
-static void populate_ths(struct sched *sched, int **th)
+static void populate_ths(struct sched *sched, struct data *d, int **th)
 {
 	int first, i, id, index, j;
 
@@ -194,12 +186,12 @@ static void populate_ths(struct sched *sched, int **th)
 	for (i = 0; i < n_cpus; i++) {
 		first = 1;
 
-		for (j = 0; j < yass_list_n(stalled); j++) {
+		for (j = 0; j < yass_list_n(d->stalled); j++) {
 
-			id = yass_list_get(stalled, j);
+			id = yass_list_get(d->stalled, j);
 			index = yass_task_get_from_id(sched, id);
 
-			if (cpu_task[i][index] == -1)
+			if (yass_partition_get_cpu(d->part, id) != i)
 				continue;
 
 			if (first) {
@@ -208,14 +200,15 @@ static void populate_ths(struct sched *sched, int **th)
 				continue;
 			}
 
-			th[i][index] = compute_th(sched, th, i, j);
+			th[i][index] = compute_th(sched, d, th, i, j);
 		}
 	}
 
 	/* print_table(sched, th); */
 }
 
-static void compute_sleep_states(struct sched *sched, int **th, int **ss)
+static void compute_sleep_states(struct sched *sched, struct data *d, int **th,
+				 int **ss)
 {
 	int i, j, k, selected;
 	double c, min, p;
@@ -224,7 +217,7 @@ static void compute_sleep_states(struct sched *sched, int **th, int **ss)
 	int n_states = yass_cpu_get_nstates(sched);
 
 	for (i = 0; i < n_cpus; i++) {
-		for (j = 0; j < yass_list_n(stalled); j++) {
+		for (j = 0; j < yass_list_n(d->stalled); j++) {
 
 			min = INT_MAX;
 			selected = -1;
@@ -246,35 +239,66 @@ static void compute_sleep_states(struct sched *sched, int **th, int **ss)
 	/* print_table(sched, ss); */
 }
 
-int offline(struct sched *sched)
+static void data_free(struct data *d)
+{
+	if (d->stalled != NULL)
+		yass_list_free(d->stalled);
+	if (d->ready != NULL)
+		yass_list_free(d->ready);
+	if (d->running != NULL)
+		yass_list_free(d->running);
+	if (d->part != NULL)
+		yass_partition_free(d->part);
+
+	free(d);
+}
+
+void *offline(struct sched *sched, int *error)
 {
 	int i, j;
-	int cpu;
+	int cpu, id;
 
-	int **th, **ss;
+	int *cpus, **th, **ss;
+	unsigned long long *load;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	struct data *d = (struct data *)malloc(sizeof(struct data));
+
+	*error = 0;
+
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
 
-	cpu_task = (int **)malloc(n_cpus * n_tasks * sizeof(int));
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
+	d->part = yass_partition_new(sched, n_cpus);
+
+	if (d->ready == NULL || d->running == NULL || d->stalled == NULL ||
+	    d->part == NULL) {
+		data_free(d);
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	cpus = (int *)malloc(n_tasks * sizeof(int));
+	load = (unsigned long long *)calloc(n_cpus, sizeof(unsigned long long));
 
 	th = (int **)malloc(n_cpus * n_tasks * sizeof(int));
 	ss = (int **)malloc(n_cpus * n_tasks * sizeof(int));
 
 	for (i = 0; i < n_tasks; i++)
-		yass_list_add(stalled, yass_task_get_id(sched, i));
+		yass_list_add(d->stalled, yass_task_get_id(sched, i));
 
 	for (i = 0; i < n_cpus; i++) {
-		cpu_task[i] = (int *)malloc(n_tasks * sizeof(int));
 		th[i] = (int *)malloc(n_tasks * sizeof(int));
 		ss[i] = (int *)malloc(n_tasks * sizeof(int));
 
 		for (j = 0; j < n_tasks; j++) {
-			cpu_task[i][j] = -1;
 			th[i][j] = -1;
 			ss[i][j] = -1;
 		}
@@ -286,23 +310,38 @@ int offline(struct sched *sched)
 	 * fit approach.
 	 */
 
-	yass_sort_list_int(sched, stalled, yass_task_time_to_deadline);
+	yass_sort_list_int(sched, d->stalled, yass_task_time_to_deadline);
 
 	for (i = n_tasks - 1; i >= 0; i--) {
 
-		cpu = get_lowest_utilization_cpu(sched);
+		cpu = get_lowest_utilization_cpu(sched, load);
+
+		if (cpu == -1) {
+			*error = -YASS_ERROR_NOT_SCHEDULABLE;
+			break;
+		}
 
-		if (cpu == -1)
-			return -YASS_ERROR_NOT_SCHEDULABLE;
+		id = yass_task_get_id(sched, i);
 
-		cpu_task[cpu][i] = 1;
+		cpus[i] = cpu;
+		load[cpu] += yass_task_get_exec_hyperperiod(sched, id);
 	}
 
-	sort_list_desc_tc(sched);
+	/*
+	 * Tasks with the same deadline on a cpu are run in index
+	 * order, as the partition keeps the order of assignment.
+	 */
+	for (i = 0; i < n_tasks && !*error; i++)
+		yass_partition_assign(d->part, yass_task_get_id(sched, i),
+				      cpus[i]);
+
+	if (!*error) {
+		sort_list_desc_tc(sched, d);
 
-	populate_ths(sched, th);
+		populate_ths(sched, d, th);
 
-	compute_sleep_states(sched, th, ss);
+		compute_sleep_states(sched, d, th, ss);
+	}
 
 	for (i = 0; i < n_cpus; i++) {
 		free(th[i]);
@@ -311,74 +350,71 @@ int offline(struct sched *sched)
 
 	free(th);
 	free(ss);
+	free(cpus);
+	free(load);
 
-	if (!is_schedulable(sched))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
-	else
-		return 0;
+	if (!*error && !is_schedulable(sched, d))
+		*error = -YASS_ERROR_NOT_SCHEDULABLE;
+
+	if (*error) {
+		data_free(d);
+		return NULL;
+	}
+
+	return d;
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
-	int candidate, i, id, j;
-	int ttd, ttd_candidate;
+	struct data *d = (struct data *)data;
+
+	int candidate, i, id, n_ready, n_stalled;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
-	int n_tasks = yass_sched_get_ntasks(sched);
+
+	n_stalled = yass_list_n(d->stalled);
 
 	yass_exec_inc(sched);
 
-	yass_check_terminated_tasks(sched, running, stalled, YASS_OFFLINE);
+	yass_check_terminated_tasks(sched, d->running, d->stalled,
+				    YASS_OFFLINE);
 
 	if (yass_deadline_miss(sched))
 		return -YASS_ERROR_NOT_SCHEDULABLE;
 
-	yass_check_ready_tasks(sched, stalled, ready);
+	for (i = n_stalled; i < yass_list_n(d->stalled); i++)
+		yass_partition_remove(d->part, yass_list_get(d->stalled, i));
 
-	for (i = 0; i < n_cpus; i++) {
-		id = -1;
+	n_ready = yass_list_n(d->ready);
 
-		candidate = -1;
-		ttd_candidate = INT_MAX;
+	yass_check_ready_tasks(sched, d->stalled, d->ready);
 
-		for (j = 0; j < n_tasks; j++) {
-			if (cpu_task[i][j] == -1)
-				continue;
+	for (i = n_ready; i < yass_list_n(d->ready); i++) {
+		id = yass_list_get(d->ready, i);
 
-			id = yass_task_get_id(sched, j);
-			ttd = yass_task_time_to_deadline(sched, id);
+		yass_partition_add(d->part, id,
+				   yass_task_get_absolute_deadline(sched, id));
+	}
 
-			if ((yass_list_present(running, id) ||
-			     yass_list_present(ready, id)) &&
-			    ttd < ttd_candidate) {
-				candidate = id;
-				ttd_candidate = ttd;
-			}
-		}
+	for (i = 0; i < n_cpus; i++) {
+		candidate = yass_partition_top(d->part, i);
 
 		if (candidate != -1 && yass_cpu_get_task(sched, i) != candidate) {
 			if (yass_cpu_is_active(sched, i))
-				yass_preempt_task(sched, i, running, ready);
+				yass_preempt_task(sched, i, d->running,
+						  d->ready);
 
-			yass_run_task(sched, i, candidate, ready, running);
+			yass_run_task(sched, i, candidate, d->ready,
+				      d->running);
 		}
 	}
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
-	int i;
-
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
-
-	for (i = 0; i < yass_sched_get_ncpus(sched); i++)
-		free(cpu_task[i]);
-
-	free(cpu_task);
+	data_free((struct data *)data);
 
 	return 0;
 }
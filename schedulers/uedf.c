@@ -8,11 +8,18 @@
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 
-struct yass_list *stalled;
-struct yass_list *ready;
-struct yass_list *running;
+struct data {
+	struct yass_list *stalled;
+	struct yass_list *ready;
+	struct yass_list *running;
 
-double **assignment;
+	double **assignment;
+};
+
+int abi_version()
+{
+	return YASS_SCHED_ABI_V2;
+}
 
 const char *name()
 {
@@ -35,33 +42,46 @@ static double double_max(double a, double b)
 		return b;
 }
 
-int offline(struct sched *sched)
+void *offline(struct sched *sched, int *error)
 {
 	int i, id, j;
 
 	int n_cpus = yass_sched_get_ncpus(sched);
 	int n_tasks = yass_sched_get_ntasks(sched);
 
-	if (!yass_dpm_schedulability_test(sched))
-		return -YASS_ERROR_NOT_SCHEDULABLE;
+	struct data *d;
+
+	*error = 0;
+
+	if (!yass_dpm_schedulability_test(sched)) {
+		*error = -YASS_ERROR_NOT_SCHEDULABLE;
+		return NULL;
+	}
+
+	d = (struct data *)malloc(sizeof(struct data));
 
-	ready = yass_list_new(n_tasks);
-	running = yass_list_new(n_tasks);
-	stalled = yass_list_new(n_tasks);
+	if (d == NULL) {
+		*error = -YASS_ERROR_MALLOC;
+		return NULL;
+	}
+
+	d->ready = yass_list_new(n_tasks);
+	d->running = yass_list_new(n_tasks);
+	d->stalled = yass_list_new(n_tasks);
 
-	assignment = (double **)calloc(n_tasks * n_cpus, sizeof(double));
+	d->assignment = (double **)calloc(n_tasks * n_cpus, sizeof(double));
 
 	for (i = 0; i < n_tasks; i++) {
 		id = yass_task_get_id(sched, i);
-		yass_list_add(stalled, id);
+		yass_list_add(d->stalled, id);
 
-		assignment[i] = (double *)calloc(n_cpus, sizeof(double));
+		d->assignment[i] = (double *)calloc(n_cpus, sizeof(double));
 
 		for (j = 0; j < n_cpus; j++)
-			assignment[i][j] = 0;
+			d->assignment[i][j] = 0;
 	}
 
-	return 0;
+	return d;
 }
 
 static double get_u(struct sched *sched, struct yass_list *candidate, int n,
@@ -90,7 +110,8 @@ static double get_u(struct sched *sched, struct yass_list *candidate, int n,
 	return u1 - u2;
 }
 
-static double get_cpu_free_time(struct sched *sched, int cpu, double rem, int n,
+static double get_cpu_free_time(struct sched *sched, struct data *d, int cpu,
+				double rem, int n,
 				struct yass_list *candidate)
 {
 	int d2, i, j;
@@ -108,7 +129,7 @@ static double get_cpu_free_time(struct sched *sched, int cpu, double rem, int n,
 	 * Assignments of this task on previous cpus
 	 */
 	for (j = 0; j < cpu; j++)
-		previous += assignment[index][j];
+		previous += d->assignment[index][j];
 
 	free_time -= previous;
 
@@ -120,7 +141,7 @@ static double get_cpu_free_time(struct sched *sched, int cpu, double rem, int n,
 		index = yass_task_get_from_id(sched, id);
 		d2 = yass_task_get_next_release(sched, id);
 
-		free_time -= assignment[index][cpu];
+		free_time -= d->assignment[index][cpu];
 
 		u = get_u(sched, candidate, i, cpu);
 
@@ -133,7 +154,8 @@ static double get_cpu_free_time(struct sched *sched, int cpu, double rem, int n,
 /*
  * Assign a cpu to each task sorted by increasing time to deadline
  */
-static int assign(struct sched *sched, struct yass_list *candidate)
+static int assign(struct sched *sched, struct data *d,
+		  struct yass_list *candidate)
 {
 	int cpu, i, id, index, j, wcet;
 	double exec, rem, t;
@@ -143,7 +165,7 @@ static int assign(struct sched *sched, struct yass_list *candidate)
 
 	for (i = 0; i < n_tasks; i++) {
 		for (j = 0; j < n_cpus; j++)
-			assignment[i][j] = 0;
+			d->assignment[i][j] = 0;
 	}
 
 	for (i = 0; i < yass_list_n(candidate); i++) {
@@ -154,18 +176,18 @@ static int assign(struct sched *sched, struct yass_list *candidate)
 		wcet = yass_task_get_wcet(sched, id);
 		rem = wcet - exec;
 
-		if (yass_list_present(stalled, id))
+		if (yass_list_present(d->stalled, id))
 			rem = 0;
 
 		cpu = 0;
 
 		while (rem > 0) {
-			t = get_cpu_free_time(sched, cpu, rem, i, candidate);
+			t = get_cpu_free_time(sched, d, cpu, rem, i, candidate);
 
 			if (t < -0.0001)
 				return 0;
 
-			assignment[index][cpu] += t;
+			d->assignment[index][cpu] += t;
 
 			cpu++;
 
@@ -177,7 +199,7 @@ static int assign(struct sched *sched, struct yass_list *candidate)
 	return 1;
 }
 
-static void terminate_tasks(struct sched *sched)
+static void terminate_tasks(struct sched *sched, struct data *d)
 {
 	int i, id, index;
 
@@ -196,13 +218,13 @@ static void terminate_tasks(struct sched *sched)
 		exec = yass_task_get_exec(sched, id);
 		wcet = yass_task_get_wcet(sched, id);
 
-		if (assignment[index][i] <= 0.0001) {
+		if (d->assignment[index][i] <= 0.0001) {
 			if (exec >= wcet - 0.0001) {
-				yass_terminate_task(sched, i, id, running,
-						    stalled);
+				yass_terminate_task(sched, i, id, d->running,
+						    d->stalled);
 			} else {
-				yass_terminate_task(sched, i, id, running,
-						    ready);
+				yass_terminate_task(sched, i, id, d->running,
+						    d->ready);
 
 				/*
 				 * Needed because yass_terminate_task set the
@@ -238,7 +260,7 @@ static int check_ready_tasks(struct sched *sched, struct yass_list *stalled,
 }
 
 __attribute__ ((__unused__))
-static void print_assignemnts(struct sched *sched)
+static void print_assignemnts(struct sched *sched, struct data *d)
 {
 	int i, j;
 
@@ -251,14 +273,15 @@ static void print_assignemnts(struct sched *sched)
 	for (i = 0; i < n_tasks; i++) {
 		printf("%d:", yass_task_get_id(sched, i));
 		for (j = 0; j < n_cpus; j++)
-			printf(" %lf", assignment[i][j]);
+			printf(" %lf", d->assignment[i][j]);
 		printf("\n");
 	}
 
 	printf("==\n");
 }
 
-static int choose_task(struct sched *sched, struct yass_list *candidate,
+static int choose_task(struct sched *sched, struct data *d,
+		       struct yass_list *candidate,
 		       int cpu)
 {
 	int current_cpu, i, id, index;
@@ -269,7 +292,7 @@ static int choose_task(struct sched *sched, struct yass_list *candidate,
 
 		current_cpu = yass_task_get_cpu(sched, id);
 
-		if (yass_list_present(stalled, id))
+		if (yass_list_present(d->stalled, id))
 			continue;
 
 		/*
@@ -279,7 +302,7 @@ static int choose_task(struct sched *sched, struct yass_list *candidate,
 		 * previous cpu.
 		 */
 
-		if (assignment[index][cpu] > 0.0001
+		if (d->assignment[index][cpu] > 0.0001
 		    && !(current_cpu >= 0 && current_cpu < cpu)) {
 			return id;
 		}
@@ -288,7 +311,7 @@ static int choose_task(struct sched *sched, struct yass_list *candidate,
 	return -1;
 }
 
-static void execute(struct sched *sched, double time)
+static void execute(struct sched *sched, struct data *d, double time)
 {
 	int i, id, index;
 
@@ -301,13 +324,15 @@ static void execute(struct sched *sched, double time)
 			index = yass_task_get_from_id(sched, id);
 
 			yass_task_exec_inc(sched, id, time);
-			assignment[index][i] -= time;
+			d->assignment[index][i] -= time;
 		}
 	}
 }
 
-int schedule(struct sched *sched)
+int schedule(struct sched *sched, void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int cpu, i, id, index;
 	double min, time;
 
@@ -329,15 +354,16 @@ int schedule(struct sched *sched)
 		if (time > 0)
 			yass_sched_update_idle(sched);
 
-		terminate_tasks(sched);
+		terminate_tasks(sched, d);
 
-		if (time == 0 && !check_ready_tasks(sched, stalled, ready))
+		if (time == 0 && !check_ready_tasks(sched, d->stalled,
+						    d->ready))
 			return -YASS_ERROR_NOT_SCHEDULABLE;
 
 		/*
 		 * Add all tasks to the candidate list
 		 */
-		candidate = yass_list_new(YASS_MAX_N_TASKS);
+		candidate = yass_list_new_scratch(sched, n_tasks);
 
 		for (i = 0; i < n_tasks; i++) {
 			id = yass_task_get_id(sched, i);
@@ -352,23 +378,23 @@ int schedule(struct sched *sched)
 		 * is released
 		 */
 		if (time == 0 && yass_tick_is_interval_boundary(sched, tick)) {
-			if (!assign(sched, candidate))
+			if (!assign(sched, d, candidate))
 				return -YASS_ERROR_NOT_SCHEDULABLE;
 		}
 
 		for (i = 0; i < n_cpus; i++) {
 
-			id = choose_task(sched, candidate, i);
+			id = choose_task(sched, d, candidate, i);
 
 			if (id == -1) {
 				if (yass_cpu_is_active(sched, i))
-					yass_preempt_task(sched, i, running,
-							  ready);
+					yass_preempt_task(sched, i, d->running,
+							  d->ready);
 
 			} else if (yass_cpu_get_task(sched, i) != id) {
 				if (yass_cpu_is_active(sched, i))
-					yass_preempt_task(sched, i, running,
-							  ready);
+					yass_preempt_task(sched, i, d->running,
+							  d->ready);
 
 				cpu = yass_task_get_cpu(sched, id);
 
@@ -377,10 +403,12 @@ int schedule(struct sched *sched)
 				 * subsequent cpu, preempt it.
 				 */
 				if (cpu != -1)
-					yass_preempt_task(sched, cpu, running,
-							  ready);
+					yass_preempt_task(sched, cpu,
+							  d->running,
+							  d->ready);
 
-				yass_run_task(sched, i, id, ready, running);
+				yass_run_task(sched, i, id, d->ready,
+					      d->running);
 			}
 		}
 
@@ -392,36 +420,38 @@ int schedule(struct sched *sched)
 			if (id != -1) {
 				index = yass_task_get_from_id(sched, id);
 
-				if (assignment[index][i] < min)
-					min = assignment[index][i];
+				if (d->assignment[index][i] < min)
+					min = d->assignment[index][i];
 			}
 		}
 
 		if (time + min > 1 - 0.0001)
-			execute(sched, 1 - time);
+			execute(sched, d, 1 - time);
 		else
-			execute(sched, min);
+			execute(sched, d, min);
 
 		time += min;
-
-		yass_list_free(candidate);
 	}
 
 	return 0;
 }
 
-int sched_close(struct sched *sched __attribute__ ((__unused__)))
+int sched_close(struct sched *sched __attribute__ ((__unused__)), void *data)
 {
+	struct data *d = (struct data *)data;
+
 	int i;
 
-	yass_list_free(stalled);
-	yass_list_free(ready);
-	yass_list_free(running);
+	yass_list_free(d->stalled);
+	yass_list_free(d->ready);
+	yass_list_free(d->running);
 
 	for (i = 0; i < yass_sched_get_ntasks(sched); i++)
-		free(assignment[i]);
+		free(d->assignment[i]);
+
+	free(d->assignment);
 
-	free(assignment);
+	free(d);
 
 	return 0;
 }
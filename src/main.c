@@ -29,32 +29,33 @@ int main(int argc, char **argv)
 	int n_ticks = -1;
 	int jobs = YASS_DEFAULT_N_JOBS;
 
+	int trace_format = YASS_TRACE_TEXT;
+	int trace = YASS_TRACE_ALL;
+
 	int n_cpus = YASS_DEFAULT_N_CPU;
 	char cpu[128] = "";
 
+	char campaign[128] = "";
 	char data[128] = "";
 	char output[128] = "";
 	char tests_output[128] = "";
 
-	int n_schedulers = 0;
-	char **scheduler = (char **)malloc(YASS_MAX_N_CPU * 128);
-
-	srand(time(NULL));
-	srand48(time(NULL));
+	unsigned long long seed = time(NULL);
 
-	for (i = 0; i < YASS_MAX_N_CPU; i++) {
-		scheduler[i] = (char *)malloc(128);
-		strcpy(scheduler[i], "");
-	}
+	int n_schedulers = 0;
+	char **scheduler = NULL;
 
 	while (1) {
 		static struct option long_options[] = {
+			{"async-trace", no_argument, 0, OPTS_ASYNC_TRACE},
+			{"campaign", required_argument, 0, OPTS_CAMPAIGN},
 			{"context-switches", no_argument, 0, OPTS_CTX},
 			{"cpu", required_argument, 0, 'c'},
 			{"data", required_argument, 0, 'd'},
 			{"deadline-misses", no_argument, 0, OPTS_DEADLINE},
 			{"debug", no_argument, 0, OPTS_DEBUG},
 			{"energy", no_argument, 0, 'e'},
+			{"event-driven", no_argument, 0, OPTS_EVENT_DRIVEN},
 			{"hyperperiods", required_argument, 0, 'h'},
 			{"idle", no_argument, 0, 'i'},
 			{"jobs", required_argument, 0, 'j'},
@@ -62,11 +63,14 @@ int main(int argc, char **argv)
 			{"online", no_argument, 0, OPTS_ONLINE},
 			{"output", required_argument, 0, 'o'},
 			{"scheduler", required_argument, 0, 's'},
+			{"seed", required_argument, 0, OPTS_SEED},
 			{"verbose", no_argument, 0, 'v'},
 			{"version", no_argument, 0, 'V'},
 			{"tests", no_argument, 0, OPTS_TESTS},
 			{"tests-output", required_argument, 0, OPTS_TESTS_OUTPUT},
 			{"ticks", required_argument, 0, 't'},
+			{"trace", required_argument, 0, OPTS_TRACE},
+			{"trace-format", required_argument, 0, OPTS_TRACE_FORMAT},
 
 			{0, 0, 0, 0}
 		};
@@ -81,6 +85,15 @@ int main(int argc, char **argv)
 			break;
 
 		switch (c) {
+		case OPTS_ASYNC_TRACE:
+			opts |= OPTS_ASYNC_TRACE;
+			break;
+
+		case OPTS_CAMPAIGN:
+			opts |= OPTS_CAMPAIGN;
+			strcpy(campaign, optarg);
+			break;
+
 		case OPTS_CTX:
 			opts |= OPTS_CTX;
 			break;
@@ -105,6 +118,10 @@ int main(int argc, char **argv)
 			opts |= OPTS_ENERGY;
 			break;
 
+		case OPTS_EVENT_DRIVEN:
+			opts |= OPTS_EVENT_DRIVEN;
+			break;
+
 		case 'h':
 			n_hyperperiods = atoi(optarg);
 
@@ -131,7 +148,7 @@ int main(int argc, char **argv)
 		case 'n':
 			n_cpus = atoi(optarg);
 
-			if (n_cpus <= 0 || n_cpus > 32) {
+			if (n_cpus <= 0) {
 				yass_handle_error(-YASS_ERROR_N_CPUS);
 				exit(1);
 			}
@@ -147,7 +164,21 @@ int main(int argc, char **argv)
 			break;
 
 		case 's':
-			strcpy(scheduler[n_schedulers++], optarg);
+			scheduler = (char **)realloc(scheduler,
+						     (n_schedulers + 1) *
+						     sizeof(char *));
+
+			if (scheduler == NULL) {
+				yass_handle_error(-YASS_ERROR_MALLOC);
+				exit(1);
+			}
+
+			scheduler[n_schedulers++] = strdup(optarg);
+			break;
+
+		case OPTS_SEED:
+			opts |= OPTS_SEED;
+			seed = strtoull(optarg, NULL, 10);
 			break;
 
 		case OPTS_TESTS:
@@ -168,6 +199,36 @@ int main(int argc, char **argv)
 
 			break;
 
+		case OPTS_TRACE:
+			if (!strcmp(optarg, "none")) {
+				trace = YASS_TRACE_NONE;
+			} else if (!strcmp(optarg, "tasks")) {
+				trace = YASS_TRACE_TASKS;
+			} else if (!strcmp(optarg, "cpu")) {
+				trace = YASS_TRACE_CPU;
+			} else if (!strcmp(optarg, "all")) {
+				trace = YASS_TRACE_ALL;
+			} else {
+				yass_handle_error(-YASS_ERROR_TRACE_EVENTS);
+				exit(1);
+			}
+
+			break;
+
+		case OPTS_TRACE_FORMAT:
+			if (!strcmp(optarg, "text")) {
+				trace_format = YASS_TRACE_TEXT;
+			} else if (!strcmp(optarg, "binary")) {
+				trace_format = YASS_TRACE_BINARY;
+			} else if (!strcmp(optarg, "compressed")) {
+				trace_format = YASS_TRACE_COMPRESSED;
+			} else {
+				yass_handle_error(-YASS_ERROR_TRACE_FORMAT);
+				exit(1);
+			}
+
+			break;
+
 		case 'v':
 			opts |= OPTS_VERBOSE;
 			break;
@@ -191,11 +252,29 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
-	r = run(opts, (char *)data, n_cpus, n_ticks, n_hyperperiods,
-		(char *)cpu, n_schedulers, scheduler, output, jobs,
-		tests_output);
+	/*
+	 * Without -s, a single scheduler is run, given by an empty
+	 * string.
+	 */
+	if (n_schedulers == 0) {
+		scheduler = (char **)malloc(sizeof(char *));
+
+		if (scheduler == NULL) {
+			yass_handle_error(-YASS_ERROR_MALLOC);
+			exit(1);
+		}
+
+		scheduler[n_schedulers++] = strdup("");
+	}
+
+	if (opts & OPTS_CAMPAIGN)
+		r = run_campaign(campaign, output, jobs, seed);
+	else
+		r = run(opts, (char *)data, n_cpus, n_ticks, n_hyperperiods,
+			(char *)cpu, n_schedulers, scheduler, output,
+			trace_format, trace, jobs, tests_output, seed);
 
-	for (i = 0; i < YASS_MAX_N_CPU; i++)
+	for (i = 0; i < n_schedulers; i++)
 		free(scheduler[i]);
 	free(scheduler);
 
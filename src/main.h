@@ -10,5 +10,11 @@
 #define OPTS_DEBUG         64
 #define OPTS_TESTS         128
 #define OPTS_TESTS_OUTPUT  256
+#define OPTS_EVENT_DRIVEN  512
+#define OPTS_CAMPAIGN      1024
+#define OPTS_SEED          2048
+#define OPTS_TRACE_FORMAT  4096
+#define OPTS_ASYNC_TRACE   8192
+#define OPTS_TRACE         16384
 
 #endif				/* _YASS_TESTS_H */
@@ -6,14 +6,17 @@
 
 #include "main.h"
 
+#include <libyass/campaign.h>
 #include <libyass/common.h>
 #include <libyass/cpu.h>
+#include <libyass/exec_time.h>
 #include <libyass/log.h>
 #include <libyass/scheduler.h>
 #include <libyass/task.h>
 #include <libyass/yass.h>
 
 #define DEFAULT_OUTPUT "output.txt"
+#define DEFAULT_CAMPAIGN_OUTPUT "campaign.txt"
 
 #define SUB_SCHED "sched"
 #define SUB_STATS "stats"
@@ -169,14 +172,17 @@ static int output_stats(struct yass *yass, char *output_file, int error)
 
 int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 	const char *cpu, int n_schedulers, char **scheduler, char *output,
-	int jobs, char *tests_output)
+	int trace_format, int trace, int jobs, char *tests_output,
+	unsigned long long seed)
 {
 	int c, error, n_tasks;
 
+	int async_trace = opts & OPTS_ASYNC_TRACE;
 	int ctx = opts & OPTS_CTX;
 	int deadline = opts & OPTS_DEADLINE;
 	int debug = opts & OPTS_DEBUG;
 	int energy = opts & OPTS_ENERGY;
+	int event_driven = opts & OPTS_EVENT_DRIVEN;
 	int idle = opts & OPTS_IDLE;
 	int online = opts & OPTS_ONLINE;
 	int verbose = opts & OPTS_VERBOSE;
@@ -184,7 +190,7 @@ int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 
 	FILE *fp;
 
-	int **exec_time;
+	struct yass_exec_time *exec_time;
 	struct yass_task **tasks;
 
 	struct sched *sched;
@@ -201,7 +207,7 @@ int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 		goto end;
 	}
 
-	exec_time = yass_tasks_generate_exec(tasks, n_tasks);
+	exec_time = yass_exec_time_new(tasks, n_tasks, seed);
 
 	if (exec_time == NULL) {
 		fprintf(stderr, "Error while generating execution times\n");
@@ -232,15 +238,23 @@ int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 	if (!strcmp(output, ""))
 		strcpy(output, DEFAULT_OUTPUT);
 
-	fp = yass_log_new(yass, output);
+	fp = yass_log_new(yass, output, trace_format);
 
 	if (fp == NULL) {
 		fprintf(stderr, "Error while creating log file\n");
 		goto end_yass;
 	}
 
-	for (c = 0; c < n_schedulers; c++)
-		yass_sched_set_fp(yass_get_sched(yass, c), fp);
+	for (c = 0; c < n_schedulers; c++) {
+		sched = yass_get_sched(yass, c);
+
+		yass_sched_set_fp(sched, fp);
+		yass_sched_set_trace_format(sched, trace_format);
+		yass_sched_set_trace(sched, trace);
+		yass_sched_set_event_driven(sched, event_driven);
+	}
+
+	yass_set_async_trace(yass, async_trace);
 
 	error = yass_run(yass, jobs);
 
@@ -289,7 +303,7 @@ int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 	yass_free(yass);
 
  end_exec:
-	yass_task_free_exec_time(exec_time, n_tasks);
+	yass_exec_time_free(exec_time);
 
  end_tasks:
 	yass_task_free_tasks(tasks, n_tasks);
@@ -300,3 +314,48 @@ int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 
 	return 0;
 }
+
+int run_campaign(const char *spec, char *output, int jobs,
+		 unsigned long long seed)
+{
+	int error;
+
+	FILE *fp;
+
+	struct yass_campaign *campaign;
+
+	campaign = yass_campaign_new(spec, &error);
+
+	if (campaign == NULL) {
+		yass_handle_error(error);
+		return 1;
+	}
+
+	yass_campaign_set_seed(campaign, seed);
+
+	if (!strcmp(output, ""))
+		strcpy(output, DEFAULT_CAMPAIGN_OUTPUT);
+
+	fp = fopen(output, "w");
+
+	if (fp == NULL) {
+		error = -YASS_ERROR_FILE;
+		yass_handle_error(error);
+		goto end;
+	}
+
+	error = yass_campaign_run(campaign, jobs, fp);
+
+	if (error)
+		yass_handle_error(error);
+
+	fclose(fp);
+
+ end:
+	yass_campaign_free(campaign);
+
+	if (error)
+		return 1;
+
+	return 0;
+}
@@ -3,6 +3,10 @@
 
 int run(int opts, const char *data, int n_cpus, int n_ticks, int n_hyperperiods,
 	const char *cpu, int n_schedulers, char **scheduler, char *output,
-	int jobs, char *tests_output);
+	int trace_format, int trace, int jobs, char *tests_output,
+	unsigned long long seed);
+
+int run_campaign(const char *spec, char *output, int jobs,
+		 unsigned long long seed);
 
 #endif				/* _YASS_TESTS_H */
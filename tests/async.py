@@ -0,0 +1,81 @@
+#!/usr/bin/env python
+
+# Check that --async-trace gives the same trace and verbose output as
+# the synchronous writes, with more schedulers, and so more streams,
+# than the writer has spare buffers, and that it does not hang. Run it
+# from the tests directory of a built tree.
+#
+# Usage: async.py [yass] [scheduler]
+
+import os, shutil, subprocess, sys, tempfile
+
+# Each scheduler has a trace stream and, with -v, a verbose one: well
+# over the 16 spare buffers of the writer
+N_SCHEDULERS = 40
+
+TIMEOUT = 60
+
+def run(yass, scheduler, jobs, options, output):
+    cmd = [yass, '-n', '2', '-c', '../processors/generic', '-d',
+           '../data/default', '-o', output, '-t', '3000', '-j', str(jobs)]
+
+    for i in range(N_SCHEDULERS):
+        cmd += ['-s', scheduler]
+
+    with open(output + '.stdout', 'w') as out:
+        try:
+            return subprocess.call(cmd + options, stdout=out,
+                                   timeout=TIMEOUT)
+        except subprocess.TimeoutExpired:
+            return 'timeout'
+
+def read(path, sort):
+    with open(path, 'rb') as f:
+        if sort:
+            return sorted(f.readlines())
+        return f.read()
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    scheduler = '../schedulers/.libs/gedf.so'
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        scheduler = sys.argv[2]
+
+    tmp = tempfile.mkdtemp()
+
+    failed = 0
+
+    for jobs in [1, 4]:
+        for options in [[], ['-v'], ['--trace-format=compressed']]:
+            name = 'j%d %s' % (jobs, ' '.join(options))
+
+            outputs = []
+
+            for extra in [[], ['--async-trace']]:
+                output = os.path.join(tmp, 'output-%d' % len(extra))
+
+                ret = run(yass, scheduler, jobs, options + extra, output)
+
+                if ret != 0:
+                    print('%s %s: yass returned %s' %
+                          (name, ' '.join(extra), ret))
+                    failed = 1
+                    break
+
+                # Verbose lines of several schedulers come in blocks
+                outputs.append((read(output, False),
+                                read(output + '.stdout', True)))
+
+            if len(outputs) == 2 and outputs[0] != outputs[1]:
+                print('%s: --async-trace gives another output' % name)
+                failed = 1
+
+    shutil.rmtree(tmp)
+
+    if not failed:
+        print('%d schedulers: same outputs' % N_SCHEDULERS)
+
+    sys.exit(failed)
@@ -1,6 +1,8 @@
 #!/usr/bin/env python
 
-import json, random
+import json, os, random, time
+
+from subprocess import call
 
 def gcd(a, b):
     while b:
@@ -139,7 +141,7 @@ def generate_tasks(utilization, n_tasks, hmax, mc_ratio, output, n_vms):
 
         if ratio > mc_ratio:
             criticality = 0
-	else:
+        else:
             criticality = 1
 
         dict_t = {
@@ -152,7 +154,53 @@ def generate_tasks(utilization, n_tasks, hmax, mc_ratio, output, n_vms):
 
         list_t.append(dict_t)
 
+    write_tasks(list_t, output)
+
+def write_tasks(list_t, output):
     dict_t = {'tasks': list_t}
 
     with open(output, 'w') as outfile:
         json.dump(dict_t, outfile, sort_keys=True, indent=4, separators=(',', ': '))
+
+# Always the same n_tasks tasks of the given periods, with a utilization
+# under the number of cpus
+def generate_periodic_tasks(n_tasks, n_cpus, periods, output):
+    list_t = []
+
+    random.seed(0)
+
+    for i in range(n_tasks):
+        period = random.choice(periods)
+
+        dict_t = {
+            'id': i + 1,
+            'wcet': max(10, int(period * n_cpus * 0.8 / n_tasks)),
+            'period': period
+        }
+
+        list_t.append(dict_t)
+
+    write_tasks(list_t, output)
+
+# Best time of n_runs runs of cmd, its standard output discarded. The
+# output file of yass is removed before each run, yass would otherwise
+# remove it during the timed run.
+def timed_run(cmd, output, n_runs=1):
+    best = None
+
+    for i in range(n_runs):
+        if os.path.exists(output):
+            os.remove(output)
+
+        with open(os.devnull, 'w') as null:
+            start = time.time()
+            ret = call(cmd, stdout=null)
+            end = time.time()
+
+        if ret != 0:
+            return ret, 0
+
+        if best is None or end - start < best:
+            best = end - start
+
+    return 0, best
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+
+# Check the global schedulers on platforms with more cpus than tasks,
+# where some cpus are always idle: run yass on the data files with 4
+# and 8 cpus and fail if it does not exit successfully, prints a
+# warning or logs an event for an idle cpu (task -1). Run it from the
+# tests directory of a built tree.
+#
+# Usage: idle.py [yass] [schedulers directory]
+
+import os, shutil, sys, tempfile
+
+from subprocess import call
+
+# fork is left out: the ids of the threads it runs are not task ids,
+# and yass warns about them whatever the number of cpus
+SCHEDULERS = ['gangedf', 'gedf', 'llf', 'fcfs']
+
+DATA = ['default', 'periodic', 'delay', 'forkjoin']
+
+N_CPUS = [4, 8]
+
+def run(yass, scheduler, n_cpus, data, output):
+    cmd = [yass, '-s', scheduler, '-n', str(n_cpus), '-c',
+           '../processors/generic', '-d', data, '-o', output + '.trace',
+           '-t', '2000', '-v']
+
+    with open(output + '.stdout', 'w') as out:
+        with open(output + '.stderr', 'w') as err:
+            ret = call(cmd, stdout=out, stderr=err)
+
+    with open(output + '.stdout') as out:
+        idle = [l for l in out if ' task -1 ' in l.rstrip() + ' ']
+
+    with open(output + '.stderr') as err:
+        warnings = [l for l in err if l.startswith('Warning')]
+
+    return ret, len(idle), len(warnings)
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    schedulers = '../schedulers/.libs'
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        schedulers = sys.argv[2]
+
+    tmp = tempfile.mkdtemp()
+
+    output = os.path.join(tmp, 'output')
+
+    failed = 0
+
+    for name in SCHEDULERS:
+        scheduler = os.path.join(schedulers, name + '.so')
+
+        for data in DATA:
+            for n_cpus in N_CPUS:
+                ret, idle, warnings = run(yass, scheduler, n_cpus,
+                                          os.path.join('../data', data),
+                                          output)
+
+                if ret != 0 or idle != 0 or warnings != 0:
+                    print('%s %s %d cpus: yass returned %d, %d events '
+                          'of idle cpus, %d warnings' %
+                          (name, data, n_cpus, ret, idle, warnings))
+                    failed = 1
+
+    shutil.rmtree(tmp)
+
+    if not failed:
+        print('%d schedulers: no event of idle cpus' % len(SCHEDULERS))
+
+    sys.exit(failed)
@@ -0,0 +1,50 @@
+/*
+ * Count the calls to malloc(), calloc() and realloc() of a process,
+ * and write their number to the file named by YASS_MALLOC_COUNT when
+ * it exits. Built and preloaded by malloc.py.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+
+static unsigned long n_calls;
+
+void *malloc(size_t size)
+{
+	__atomic_add_fetch(&n_calls, 1, __ATOMIC_RELAXED);
+
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+	__atomic_add_fetch(&n_calls, 1, __ATOMIC_RELAXED);
+
+	return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+	__atomic_add_fetch(&n_calls, 1, __ATOMIC_RELAXED);
+
+	return __libc_realloc(p, size);
+}
+
+__attribute__ ((destructor))
+static void write_count(void)
+{
+	char *path = getenv("YASS_MALLOC_COUNT");
+
+	FILE *fp;
+
+	if (path == NULL || (fp = fopen(path, "w")) == NULL)
+		return;
+
+	fprintf(fp, "%lu\n", __atomic_load_n(&n_calls, __ATOMIC_RELAXED));
+
+	fclose(fp);
+}
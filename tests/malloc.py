@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+
+# Check that the schedulers do not allocate memory once they run: count
+# the calls to malloc(), calloc() and realloc() of yass, through
+# malloc.c preloaded, on runs of 2000 and 4000 ticks of each scheduler,
+# and fail if the longer run makes more calls. Run it from the tests
+# directory of a built tree, with glibc and a C compiler.
+#
+# Usage: malloc.py [yass] [schedulers directory] [cc]
+
+import os, shutil, sys, tempfile
+
+from subprocess import call
+
+from gen_tasks import write_tasks
+
+N_TICKS = [2000, 4000]
+
+# pf needs a global utilization equal to the number of cpus, rm and edf
+# a uniprocessor and rm a utilization under its bound. The lengths of
+# the idle periods of the cpus are recorded in an array of 64 entries
+# at first, which doubles when full: the first set keeps the cpus busy,
+# the second one leaves the cpu idle twice per hyperperiod, 50 times
+# over the longest run.
+TASKS_2 = [
+    {'id': 1, 'wcet': 10, 'period': 20, 'deadline': 19},
+    {'id': 2, 'wcet': 20, 'period': 40, 'deadline': 39},
+    {'id': 3, 'wcet': 30, 'period': 40, 'deadline': 39},
+    {'id': 4, 'wcet': 10, 'period': 40, 'deadline': 39}
+]
+
+TASKS_1 = [
+    {'id': 1, 'wcet': 10, 'period': 40},
+    {'id': 2, 'wcet': 20, 'period': 80},
+    {'id': 3, 'wcet': 40, 'period': 160}
+]
+
+SCHEDULERS = [
+    ('pf', 2, TASKS_2),
+    ('uedf', 2, TASKS_2),
+    ('run', 2, TASKS_2),
+    ('bf', 2, TASKS_2),
+    ('gedf', 2, TASKS_2),
+    ('llf', 2, TASKS_2),
+    ('rm', 1, TASKS_1),
+    ('edf', 1, TASKS_1)
+]
+
+def run(yass, scheduler, n_cpus, n_ticks, data, output, shim, count):
+    cmd = [yass, '-s', scheduler, '-n', str(n_cpus), '-c',
+           '../processors/generic', '-d', data, '-o', output, '-t',
+           str(n_ticks)]
+
+    env = dict(os.environ, LD_PRELOAD=shim, YASS_MALLOC_COUNT=count)
+
+    if os.path.exists(count):
+        os.remove(count)
+
+    with open(os.devnull, 'w') as null:
+        ret = call(cmd, stdout=null, env=env)
+
+    if ret != 0:
+        return ret, 0
+
+    with open(count) as f:
+        return 0, int(f.read())
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    schedulers = '../schedulers/.libs'
+    cc = 'cc'
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        schedulers = sys.argv[2]
+    if len(sys.argv) > 3:
+        cc = sys.argv[3]
+
+    tmp = tempfile.mkdtemp()
+
+    shim = os.path.join(tmp, 'malloc.so')
+    output = os.path.join(tmp, 'output')
+    count = os.path.join(tmp, 'count')
+
+    source = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          'malloc.c')
+
+    if call([cc, '-shared', '-fPIC', '-O2', '-o', shim, source]) != 0:
+        print('cannot build %s' % source)
+        shutil.rmtree(tmp)
+        sys.exit(1)
+
+    print('%10s %10s %10s' % ('scheduler', N_TICKS[0], N_TICKS[1]))
+
+    failed = 0
+
+    for name, n_cpus, tasks in SCHEDULERS:
+        data = os.path.join(tmp, 'tasks-%s' % name)
+        scheduler = os.path.join(schedulers, name + '.so')
+
+        write_tasks(tasks, data)
+
+        counts = []
+
+        for n_ticks in N_TICKS:
+            ret, n = run(yass, scheduler, n_cpus, n_ticks, data, output,
+                         shim, count)
+
+            if ret != 0:
+                print('%10s: yass returned %d' % (name, ret))
+                failed = 1
+                break
+
+            counts.append(n)
+
+        if len(counts) != len(N_TICKS):
+            continue
+
+        print('%10s %10d %10d' % (name, counts[0], counts[1]))
+
+        if counts[1] != counts[0]:
+            failed = 1
+
+    shutil.rmtree(tmp)
+
+    if failed:
+        print('some schedulers allocate memory while they run')
+
+    sys.exit(failed)
@@ -6,7 +6,7 @@ from gen_tasks import generate_tasks, lcm
 
 import matplotlib.pyplot as plt
 
-from subprocess import Popen, call
+from subprocess import call
 
 s = {
     'G-EDF':'../schedulers/.libs/gedf.so',
@@ -182,7 +182,7 @@ def plot_consumption(utilizations, final, n_sched, n_cpus, schedulers):
 
     f.close()
 
-def plot_bars(schedulers):
+def plot_bars(results, schedulers):
 
     plt.figure()
 
@@ -198,23 +198,10 @@ def plot_bars(schedulers):
     total = []
 
     for i in range(len(schedulers)):
-        f = open('sched/{0}'.format(i), 'r')
-
         total.append([])
 
-        f.seek(0)
-        tmp = f.readlines()
-        f.close
-
-        tmp = [t.rstrip('\n') for t in tmp]
-
-        for t in tmp:
-            tmp2 = re.split(' ', t)
-
-            tmp2.remove('')
-
-            for t2 in tmp2:
-                total[i].append(int(t2))
+        for taskset in results:
+            total[i].extend(results[taskset][i]['lengths'])
 
     for i in range(len(schedulers)):
 
@@ -259,7 +246,7 @@ def plot_bars(schedulers):
 
     plt.savefig('hist.pdf', bbox_inches='tight')
 
-def plot_usage(schedulers):
+def plot_usage(results, schedulers):
 
     plt.figure()
 
@@ -278,26 +265,14 @@ def plot_usage(schedulers):
     total = []
 
     for i in range(len(schedulers)):
-        f = open('usage/{0}'.format(i), 'r')
-
         total.append([])
 
         for j in range(n_states):
             total[i].append(0)
 
-        f.seek(0)
-        tmp = f.readlines()
-        f.close
-
-        tmp = [t.rstrip('\n') for t in tmp]
-
-        for t in tmp:
-            tmp2 = re.split(' ', t)
-
-            tmp2.remove('')
-
+        for taskset in results:
             for j in range(n_states):
-                total[i][j] = total[i][j] + int(tmp2[j])
+                total[i][j] = total[i][j] + results[taskset][i]['usage'][j]
 
     for i in range(len(schedulers)):
 
@@ -319,7 +294,7 @@ def plot_usage(schedulers):
 
     plt.savefig('usage.pdf', bbox_inches='tight')
 
-def collect_results(utilizations, schedulers, n_tasksets):
+def collect_results(results, utilizations, schedulers, n_tasksets):
     ctx = []
     idle = []
     consumption = []
@@ -348,29 +323,24 @@ def collect_results(utilizations, schedulers, n_tasksets):
             deadlines[s].append([])
 
         for i in range(n_tasksets):
-            f = open('out/{0}.{1}.txt'.format(u,i), 'r')
+            taskset = 'tmp/{0}.{1}.txt'.format(u,i)
 
-            f.seek(0)
-            tmp = f.readlines()
-            f.close
+            if taskset not in results:
+                continue
 
-            c = []
+            tmp = list(results[taskset])
 
-            if tmp == []:
-                continue
+            c = []
 
             for s in range(n_sched):
-                tmp2 = tmp.pop()
-                tmp2 = re.split(' ', tmp2)
-                tmp2[len(tmp2) - 1] = tmp2[len(tmp2) - 1].rstrip('\n')
+                tmp2 = tmp.pop()['out']
 
-                idle[s][len(idle[s]) - 1].append(float(tmp2[0]))
-                ctx[s][len(ctx[s]) - 1].append(float(tmp2[1]))
-                c.append(float(tmp2[2]))
-                deadlines[s][len(deadlines[s]) - 1].append(float(tmp2[3]))
+                idle[s][len(idle[s]) - 1].append(tmp2[0])
+                ctx[s][len(ctx[s]) - 1].append(tmp2[1])
+                c.append(tmp2[2])
+                deadlines[s][len(deadlines[s]) - 1].append(tmp2[3])
 
-            hyperperiod = tmp.pop()
-            hyperperiod = float(hyperperiod.rstrip('\n'))
+            hyperperiod = results[taskset][0]['hyperperiod']
 
             for s in range(n_sched):
                 consumption[s][len(consumption[s]) - 1].append(c[s])
@@ -378,7 +348,7 @@ def collect_results(utilizations, schedulers, n_tasksets):
 
     return idle, ctx, consumption, deadlines
 
-def get_stat(utilizations, schedulers, n_tasksets):
+def get_stat(results, utilizations, schedulers, n_tasksets):
     stat = []
     stat.append([])
 
@@ -396,22 +366,11 @@ def get_stat(utilizations, schedulers, n_tasksets):
         stat[0].append([])
 
         for i in range(n_tasksets):
-            try:
-                f = open('stats/{0}.{1}.txt.{2}'.format(u ,i, index_lpdpm), 'r')
+            taskset = 'tmp/{0}.{1}.txt'.format(u,i)
 
-                f.seek(0)
-
-                tmp = f.readlines()
-                tmp = tmp.pop()
-                tmp = int(tmp)
-
-                if tmp == 2:
-                    stat[0][len(stat[0]) - 1].append(1)
-                else:
-                    stat[0][len(stat[0]) - 1].append(0)
-
-                f.close
-            except IOError:
+            if taskset in results and results[taskset][index_lpdpm]['stat'] == 2:
+                stat[0][len(stat[0]) - 1].append(1)
+            else:
                 stat[0][len(stat[0]) - 1].append(0)
 
     return stat
@@ -447,54 +406,61 @@ def create_tasks(utilizations, n_tasksets, n_tasks, h_max, mc_ratio, n_vms):
 
 def launch(utilizations, online, n_tasksets, n_tasks, n_cpus, n_hyperperiods, n_jobs, schedulers):
 
-    call(["rm", "-rf", "out"])
-    call(["mkdir", "out"])
+    tasksets = []
 
-    call(["rm", "-rf", "sched"])
-    call(["mkdir", "sched"])
-
-    call(["rm", "-rf", "usage"])
-    call(["mkdir", "usage"])
+    for u in utilizations:
+        for n in range(n_tasksets):
+            tasksets.append('tmp/{0}.{1}.txt'.format(u,n))
+
+    spec = {
+        'cpu': '../processors/generic',
+        'n_cpus': n_cpus,
+        'n_hyperperiods': n_hyperperiods,
+        'online': online,
+        'schedulers': schedulers,
+        'tasksets': tasksets,
+    }
+
+    f = open('campaign.json', 'w')
+    json.dump(spec, f, indent=4)
+    f.close()
 
-    call(["rm", "-rf", "stats"])
-    call(["mkdir", "stats"])
+    f = open('campaign.log', 'w')
 
-    call(["rm", "-rf", "log"])
-    call(["mkdir", "log"])
+    call(['../src/yass', '--campaign', 'campaign.json', '-o', 'campaign.txt',
+          '-j', str(n_jobs)], stdout=f, stderr=f)
 
-    for u in utilizations:
+    f.close()
 
-        p = []
+def read_campaign():
+    results = {}
 
-        for n in range(n_tasksets):
+    f = open('campaign.txt', 'r')
 
-            command = ['../src/yass', '-c' ,'../processors/generic', '--tests', '--debug', '-v',
-                       '-n', str(n_cpus),
-                       '-d', 'tmp/{0}.{1}.txt'.format(u,n),
-                       '-h', str(n_hyperperiods),
-                       '--tests-output', '{0}.{1}.txt'.format(u,n)]
+    for line in f.readlines():
+        tmp = re.split(' ', line.rstrip('\n'))
 
-            for i in range(len(schedulers)):
-                command.append('-s')
-                command.append(schedulers[i])
+        r = {'error': int(tmp[2])}
 
-            if online == 1:
-                command.append('--online')
+        if r['error'] == 0:
+            r['hyperperiod'] = float(tmp[3])
+            r['out'] = [float(t) for t in tmp[4:8]]
+            r['stat'] = int(tmp[8])
 
-            f = open('log/{0}.{1}.txt'.format(u,n), 'w')
+            n_states = int(tmp[9])
+            r['usage'] = [int(t) for t in tmp[10:10 + n_states]]
+            r['lengths'] = [int(t) for t in tmp[11 + n_states:]]
 
-            p.append(Popen(command,stdout=f,stderr=f))
+        results.setdefault(tmp[0], []).append(r)
 
-            if n != 0 and (n + 1) % n_jobs == 0:
-                while len(p) > 0:
-                    Popen.wait(p[0])
-                    p.pop(0)
+    f.close()
 
-            f.close
+    # Like a failed run, a task set is ignored if a scheduler failed
+    for taskset in results.keys():
+        if [r for r in results[taskset] if r['error'] != 0]:
+            del results[taskset]
 
-        while len(p) > 0:
-            Popen.wait(p[0])
-            p.pop(0)
+    return results
 
 def main():
 
@@ -550,8 +516,10 @@ def main():
 
     launch(utilizations, online, n_tasksets, n_tasks, n_cpus, n_hyperperiods, n_jobs, list_schedulers)
 
-    idle, ctx, consumption, deadlines = collect_results(utilizations, schedulers, n_tasksets)
-    stat = get_stat(utilizations, schedulers, n_tasksets)
+    results = read_campaign()
+
+    idle, ctx, consumption, deadlines = collect_results(results, utilizations, schedulers, n_tasksets)
+    stat = get_stat(results, utilizations, schedulers, n_tasksets)
 
     utilizations = [float(u) / 100 for u in utilizations]
 
@@ -564,9 +532,9 @@ def main():
         plot_stat(utilizations, stat, n_cpus)
         plot_consumption(utilizations, consumption, n_sched, n_cpus, schedulers)
 
-    plot_bars(schedulers)
+    plot_bars(results, schedulers)
 
-    plot_usage(schedulers)
+    plot_usage(results, schedulers)
 
 if __name__ == "__main__":
     main()
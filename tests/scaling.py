@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+
+# Run yass on task sets and platforms larger than the former static
+# limits (128 tasks, 64 cpus, 10 schedulers), at 10 and 100 times these
+# limits, and report the time taken by each run. Run it from the tests
+# directory of a built tree.
+#
+# Usage: scaling.py [yass] [scheduler]
+
+import os, resource, shutil, sys, tempfile
+
+from gen_tasks import timed_run, write_tasks
+
+# Former limits
+MAX_N_TASKS = 128
+MAX_N_CPU = 64
+MAX_N_SCHEDULERS = 10
+
+# Harmonic periods keep the hyperperiod small whatever the number of
+# tasks
+PERIODS = [100, 200, 400]
+
+def harmonic_tasks(n_tasks):
+    list_t = []
+
+    for i in range(n_tasks):
+        period = PERIODS[i % len(PERIODS)]
+
+        dict_t = {
+            'id': i + 1,
+            'wcet': period // 4 + 10 * (i % 3),
+            'period': period
+        }
+
+        list_t.append(dict_t)
+
+    return list_t
+
+def run(yass, scheduler, n_schedulers, n_cpus, data, output):
+    cmd = [yass, '-n', str(n_cpus), '-c', '../processors/generic', '-d', data,
+           '-o', output, '-t', '400', '--event-driven']
+
+    for i in range(n_schedulers):
+        cmd += ['-s', scheduler]
+
+    return timed_run(cmd, output)
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    scheduler = '../schedulers/.libs/gedf.so'
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        scheduler = sys.argv[2]
+
+    tmp = tempfile.mkdtemp()
+
+    print('%6s %8s %8s %12s %10s %14s' % ('scale', 'tasks', 'cpus',
+                                          'schedulers', 'time (s)',
+                                          'max rss (kB)'))
+
+    failed = 0
+
+    # The task set and the platform grow together, the number of
+    # schedulers grows on its own on the smallest task set so that the
+    # whole benchmark runs in a few minutes
+    runs = []
+    for scale in [1, 10, 100]:
+        runs.append((scale, MAX_N_TASKS * scale, MAX_N_CPU * scale, 1))
+    for scale in [10, 100]:
+        runs.append((scale, MAX_N_TASKS, MAX_N_CPU, MAX_N_SCHEDULERS * scale))
+
+    for scale, n_tasks, n_cpus, n_schedulers in runs:
+        data = os.path.join(tmp, 'tasks-%d' % n_tasks)
+        output = os.path.join(tmp, 'output')
+
+        if not os.path.exists(data):
+            write_tasks(harmonic_tasks(n_tasks), data)
+
+        ret, t = run(yass, scheduler, n_schedulers, n_cpus, data, output)
+
+        rss = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+
+        if ret != 0:
+            print('%6d: yass returned %d' % (scale, ret))
+            failed = 1
+            continue
+
+        print('%6d %8d %8d %12d %10.2f %14d' % (scale, n_tasks, n_cpus,
+                                                n_schedulers, t, rss))
+
+    shutil.rmtree(tmp)
+
+    sys.exit(failed)
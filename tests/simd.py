@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+
+# Check that the vectorized kernels used to find the tasks released, or
+# with a deadline, at each tick give the same schedules as the scalar
+# one: run yass on random task sets with each kernel forced through the
+# YASS_SIMD environment variable and compare the outputs. Kernels not
+# supported by the cpu fall back to a narrower one. Run it from the
+# tests directory of a built tree.
+#
+# Usage: simd.py [yass] [scheduler] [n_sets]
+
+import os, random, shutil, sys, tempfile
+
+from subprocess import call
+
+from gen_tasks import write_tasks
+
+KERNELS = ['scalar', 'sse4', 'avx2']
+
+PERIODS = [50, 100, 150, 200, 300, 400, 600]
+
+def random_tasks(n_tasks):
+    list_t = []
+
+    for i in range(n_tasks):
+        period = random.choice(PERIODS)
+
+        dict_t = {
+            'id': i + 1,
+            'wcet': random.randint(10, period // 4),
+            'period': period,
+            'delay': random.choice([0, 0, random.randint(0, 2 * period)])
+        }
+
+        # Constrained, implicit and arbitrary deadlines
+        r = random.random()
+        if r < 0.4:
+            dict_t['deadline'] = random.randint(dict_t['wcet'], period)
+        elif r < 0.5:
+            dict_t['deadline'] = random.randint(period, 2 * period)
+
+        list_t.append(dict_t)
+
+    return list_t
+
+def run(yass, scheduler, kernel, n_cpus, data, output):
+    cmd = [yass, '-s', scheduler, '-n', str(n_cpus), '-c',
+           '../processors/generic', '-d', data, '-o', output, '-t', '3000',
+           '--deadline-misses']
+
+    env = dict(os.environ, YASS_SIMD=kernel)
+
+    with open(output + '.stdout', 'w') as out:
+        return call(cmd, stdout=out, env=env)
+
+def read(path):
+    with open(path) as f:
+        return f.read()
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    scheduler = '../schedulers/.libs/gedf.so'
+    n_sets = 50
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        scheduler = sys.argv[2]
+    if len(sys.argv) > 3:
+        n_sets = int(sys.argv[3])
+
+    tmp = tempfile.mkdtemp()
+
+    failed = 0
+
+    for i in range(n_sets):
+        random.seed(i)
+
+        # Sizes around the vector widths and the 64 bits of a mask word
+        n_tasks = random.choice([1, 2, 3, 5, 7, 63, 64, 65, 130])
+        n_cpus = random.randint(1, 8)
+
+        data = os.path.join(tmp, 'tasks-%d' % i)
+        write_tasks(random_tasks(n_tasks), data)
+
+        outputs = []
+
+        for kernel in KERNELS:
+            output = os.path.join(tmp, 'output-%s' % kernel)
+
+            ret = run(yass, scheduler, kernel, n_cpus, data, output)
+
+            if ret != 0:
+                print('set %d, %s: yass returned %d' % (i, kernel, ret))
+                failed = 1
+                break
+
+            outputs.append(read(output) + read(output + '.stdout'))
+
+        for kernel, output in zip(KERNELS[1:], outputs[1:]):
+            if output != outputs[0]:
+                print('set %d (%d tasks, %d cpus): %s differs from scalar' %
+                      (i, n_tasks, n_cpus, kernel))
+                failed = 1
+
+    shutil.rmtree(tmp)
+
+    if not failed:
+        print('%d task sets: same outputs' % n_sets)
+
+    sys.exit(failed)
@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+
+# Check that the time of a simulation grows linearly with its number of
+# ticks: run yass on the same task set for 10000 to 80000 ticks, with
+# the deadline miss check and the online mode which both need the
+# current job of each task at each tick, and fail if a run takes more
+# than twice the time of the first one scaled by its number of ticks.
+# Run it from the tests directory of a built tree.
+#
+# Usage: ticks.py [yass] [scheduler]
+
+import os, shutil, sys, tempfile
+
+from gen_tasks import generate_periodic_tasks, timed_run
+
+N_TICKS = [10000, 20000, 40000, 80000]
+
+N_TASKS = 50
+N_CPUS = 4
+N_RUNS = 3
+
+# Margin on the linear growth, for the noise of the timings
+MAX_RATIO = 2.0
+
+PERIODS = [100, 200, 400, 500, 1000]
+
+def run(yass, scheduler, n_ticks, data, output):
+    cmd = [yass, '-s', scheduler, '-n', str(N_CPUS), '-c',
+           '../processors/generic', '-d', data, '-o', output, '-t',
+           str(n_ticks), '--deadline-misses', '--online']
+
+    return timed_run(cmd, output, N_RUNS)
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    scheduler = '../schedulers/.libs/gedf.so'
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        scheduler = sys.argv[2]
+
+    tmp = tempfile.mkdtemp()
+
+    data = os.path.join(tmp, 'tasks')
+    output = os.path.join(tmp, 'output')
+
+    generate_periodic_tasks(N_TASKS, N_CPUS, PERIODS, data)
+
+    print('%8s %10s %10s' % ('ticks', 'time (s)', 'vs linear'))
+
+    failed = 0
+    first = None
+
+    for n_ticks in N_TICKS:
+        ret, t = run(yass, scheduler, n_ticks, data, output)
+
+        if ret != 0:
+            print('%8d: yass returned %d' % (n_ticks, ret))
+            failed = 1
+            break
+
+        if first is None:
+            first = t
+
+        # Time of the run over the time of the first one scaled
+        ratio = t / (first * n_ticks / N_TICKS[0])
+
+        print('%8d %10.2f %10.2f' % (n_ticks, t, ratio))
+
+        if ratio > MAX_RATIO:
+            failed = 1
+
+    shutil.rmtree(tmp)
+
+    if failed:
+        print('the time grows faster than the number of ticks')
+
+    sys.exit(failed)
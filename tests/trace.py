@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+
+# Measure what tracing costs: run yass on the same task set with each
+# --trace mask and report the best time of a few runs, its ratio to the
+# untraced run and the size of the trace. A second yass, e.g. built
+# with the logging calls removed, can be given to compare against the
+# untraced run. Run it from the tests directory of a built tree.
+#
+# Usage: trace.py [yass] [scheduler] [reference yass]
+
+import os, shutil, sys, tempfile
+
+from gen_tasks import generate_periodic_tasks, timed_run
+
+MASKS = ['all', 'tasks', 'cpu', 'none']
+
+N_TASKS = 200
+N_CPUS = 8
+N_TICKS = 200000
+N_RUNS = 5
+
+PERIODS = [100, 200, 400, 500, 1000]
+
+def run(yass, scheduler, mask, data, output):
+    cmd = [yass, '-s', scheduler, '-n', str(N_CPUS), '-c',
+           '../processors/generic', '-d', data, '-o', output, '-t',
+           str(N_TICKS)]
+
+    if mask is not None:
+        cmd += ['--trace=' + mask]
+
+    ret, t = timed_run(cmd, output, N_RUNS)
+
+    if ret != 0:
+        return ret, 0, 0
+
+    return 0, t, os.path.getsize(output)
+
+if __name__ == "__main__":
+    yass = '../src/yass'
+    scheduler = '../schedulers/.libs/gedf.so'
+    reference = None
+
+    if len(sys.argv) > 1:
+        yass = sys.argv[1]
+    if len(sys.argv) > 2:
+        scheduler = sys.argv[2]
+    if len(sys.argv) > 3:
+        reference = sys.argv[3]
+
+    tmp = tempfile.mkdtemp()
+
+    data = os.path.join(tmp, 'tasks')
+    output = os.path.join(tmp, 'output')
+
+    generate_periodic_tasks(N_TASKS, N_CPUS, PERIODS, data)
+
+    runs = [(mask, yass, mask) for mask in MASKS]
+    if reference is not None:
+        runs.append(('reference', reference, None))
+
+    results = []
+
+    failed = 0
+
+    for name, binary, mask in runs:
+        ret, t, size = run(binary, scheduler, mask, data, output)
+
+        if ret != 0:
+            print('%s: yass returned %d' % (name, ret))
+            failed = 1
+            break
+
+        results.append((name, t, size))
+
+    shutil.rmtree(tmp)
+
+    if failed:
+        sys.exit(failed)
+
+    untraced = [t for name, t, size in results if name == 'none'][0]
+
+    print('%10s %10s %10s %14s' % ('trace', 'time (s)', 'vs none',
+                                   'trace (bytes)'))
+
+    for name, t, size in results:
+        print('%10s %10.2f %10.2f %14d' % (name, t, t / untraced, size))
+
+    sys.exit(failed)